@@ -249,16 +249,26 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     return node;
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+/* Free at most max_items items of the chain starting at item (including all subentities)
+ * and return the chain of items that still have to be freed. This doesn't recurse, the children
+ * of a freed item are spliced into the chain instead, so the stack usage doesn't depend on the nesting depth. */
+static cJSON *delete_items(cJSON *item, size_t max_items)
 {
     cJSON *next = NULL;
-    while (item != NULL)
+    cJSON *last_child = NULL;
+    while ((item != NULL) && (max_items > 0))
     {
         next = item->next;
         if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
-            cJSON_Delete(item->child);
+            /* don't trust child->prev here, hand built lists might not maintain it */
+            last_child = item->child;
+            while (last_child->next != NULL)
+            {
+                last_child = last_child->next;
+            }
+            last_child->next = next;
+            next = item->child;
         }
         if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
         {
@@ -272,7 +282,192 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
         }
         global_hooks.deallocate(item);
         item = next;
+        max_items--;
+    }
+
+    return item;
+}
+
+/* Delete a cJSON structure. */
+CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+{
+    while (item != NULL)
+    {
+        item = delete_items(item, (size_t)-1);
+    }
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DeleteIncremental(cJSON *item, size_t max_items)
+{
+    return delete_items(item, max_items);
+}
+
+/* Interned object keys, stored in blocks that are only freed with the whole table. */
+typedef struct key_table_block
+{
+    struct key_table_block *next;
+    size_t size;
+    size_t used;
+} key_table_block;
+
+typedef struct
+{
+    char *key; /* NULL if the slot is empty */
+    size_t length;
+    unsigned long hash;
+} key_table_entry;
+
+struct cJSON_KeyTable
+{
+    key_table_entry *entries;
+    size_t capacity; /* always a power of two */
+    size_t count;
+    key_table_block *blocks; /* the first block is the one that is filled */
+    internal_hooks hooks;
+};
+
+#define KEY_TABLE_BLOCK_SIZE 4096
+
+CJSON_PUBLIC(cJSON_KeyTable *) cJSON_CreateKeyTable(void)
+{
+    cJSON_KeyTable *table = (cJSON_KeyTable*)global_hooks.allocate(sizeof(cJSON_KeyTable));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+
+    memset(table, '\0', sizeof(cJSON_KeyTable));
+    table->hooks = global_hooks;
+    table->capacity = 64;
+    table->entries = (key_table_entry*)table->hooks.allocate(table->capacity * sizeof(key_table_entry));
+    if (table->entries == NULL)
+    {
+        table->hooks.deallocate(table);
+        return NULL;
+    }
+    memset(table->entries, '\0', table->capacity * sizeof(key_table_entry));
+
+    return table;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteKeyTable(cJSON_KeyTable *table)
+{
+    key_table_block *block = NULL;
+
+    if (table == NULL)
+    {
+        return;
+    }
+
+    block = table->blocks;
+    while (block != NULL)
+    {
+        key_table_block *next = block->next;
+        table->hooks.deallocate(block);
+        block = next;
+    }
+    table->hooks.deallocate(table->entries);
+    table->hooks.deallocate(table);
+}
+
+static unsigned long hash_key(const unsigned char * const key, const size_t length)
+{
+    /* FNV-1a */
+    unsigned long hash = 2166136261UL;
+    size_t i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+        hash = ((hash ^ key[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+static key_table_entry *find_key(const cJSON_KeyTable * const table, const unsigned char * const key, const size_t length, const unsigned long hash)
+{
+    size_t slot = (size_t)hash & (table->capacity - 1);
+
+    while ((table->entries[slot].key != NULL)
+        && ((table->entries[slot].hash != hash) || (table->entries[slot].length != length) || (memcmp(table->entries[slot].key, key, length) != 0)))
+    {
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+
+    return &table->entries[slot];
+}
+
+/* return the copy of key in the table, adding it if it isn't there yet */
+static char *intern_key(cJSON_KeyTable * const table, const unsigned char * const key, const size_t length)
+{
+    unsigned long hash = hash_key(key, length);
+    key_table_entry *entry = find_key(table, key, length, hash);
+    key_table_block *block = table->blocks;
+
+    if (entry->key != NULL)
+    {
+        return entry->key;
+    }
+
+    if ((table->count + 1) > (table->capacity / 2))
+    {
+        /* keep the load factor below 1/2 */
+        size_t old_capacity = table->capacity;
+        key_table_entry *old_entries = table->entries;
+        size_t i = 0;
+
+        table->entries = (key_table_entry*)table->hooks.allocate(2 * old_capacity * sizeof(key_table_entry));
+        if (table->entries == NULL)
+        {
+            table->entries = old_entries;
+            return NULL;
+        }
+        memset(table->entries, '\0', 2 * old_capacity * sizeof(key_table_entry));
+        table->capacity = 2 * old_capacity;
+        for (i = 0; i < old_capacity; i++)
+        {
+            if (old_entries[i].key != NULL)
+            {
+                *find_key(table, (const unsigned char*)old_entries[i].key, old_entries[i].length, old_entries[i].hash) = old_entries[i];
+            }
+        }
+        table->hooks.deallocate(old_entries);
+        entry = find_key(table, key, length, hash);
+    }
+
+    if ((block == NULL) || ((block->size - block->used) < (length + 1)))
+    {
+        size_t size = (length + 1 > KEY_TABLE_BLOCK_SIZE) ? (length + 1) : KEY_TABLE_BLOCK_SIZE;
+        block = (key_table_block*)table->hooks.allocate(sizeof(key_table_block) + size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->size = size;
+        block->used = 0;
+        block->next = table->blocks;
+        table->blocks = block;
+    }
+
+    entry->key = (char*)(block + 1) + block->used;
+    memcpy(entry->key, key, length);
+    entry->key[length] = '\0';
+    entry->length = length;
+    entry->hash = hash;
+    block->used += length + 1;
+    table->count++;
+
+    return entry->key;
+}
+
+CJSON_PUBLIC(const char *) cJSON_InternKey(cJSON_KeyTable *table, const char *key)
+{
+    if ((table == NULL) || (key == NULL))
+    {
+        return NULL;
     }
+
+    return intern_key(table, (const unsigned char*)key, strlen(key));
 }
 
 /* get the decimal point character of the current locale */
@@ -286,6 +481,25 @@ static unsigned char get_decimal_point(void)
 #endif
 }
 
+/* Optional parser behavior, a parse_buffer without options parses everything. */
+typedef struct
+{
+    /* only build the members of the top level object with these names, skip the others */
+    const char * const *members;
+    size_t member_count;
+    /* store object keys once in this table instead of allocating them for every member */
+    cJSON_KeyTable *keys;
+    /* store arrays that only contain numbers as packed arrays */
+    cJSON_bool pack_arrays;
+    /* keep the text of numbers in valuestring, so that they are printed exactly like they were parsed */
+    cJSON_bool keep_number_text;
+    /* keep the values of the top level members with these names as raw items instead of building them */
+    const char * const *raw_members;
+    size_t raw_member_count;
+    /* keep arrays and objects that are nested at least this deep as raw items, 0 builds everything */
+    size_t raw_depth;
+} parse_options;
+
 typedef struct
 {
     const unsigned char *content;
@@ -293,6 +507,7 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    const parse_options *options;
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -303,6 +518,224 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+/* 64 bit integers */
+#define CJSON_INT64_MAX (((((cJSON_int64)1 << (sizeof(cJSON_int64) * CHAR_BIT - 2)) - 1) * 2) + 1)
+#define CJSON_INT64_MIN (-CJSON_INT64_MAX - 1)
+#define CJSON_UINT64_MAX ((cJSON_uint64)-1)
+/* integers with a larger magnitude can't all be represented by a double */
+#define CJSON_MAX_SAFE_INTEGER ((cJSON_uint64)1 << 53)
+
+/* truncate towards zero and saturate like valueint does */
+static cJSON_int64 double_to_int64(const double number)
+{
+    if (number >= (double)CJSON_INT64_MAX)
+    {
+        return CJSON_INT64_MAX;
+    }
+    if (number <= (double)CJSON_INT64_MIN)
+    {
+        return CJSON_INT64_MIN;
+    }
+    if (!(number == number))
+    {
+        return 0; /* NaN */
+    }
+
+    return (cJSON_int64)number;
+}
+
+/* Read the integer in digits[0..length), which may be negative. Fails if there is anything else
+ * or if it doesn't fit into a cJSON_int64 (negative) or cJSON_uint64 (positive). */
+static cJSON_bool parse_exact_integer(const unsigned char * const digits, const size_t length, cJSON_bool * const negative, cJSON_uint64 * const magnitude)
+{
+    cJSON_uint64 limit = CJSON_UINT64_MAX;
+    size_t i = 0;
+
+    *negative = false;
+    *magnitude = 0;
+    if ((length > 0) && (digits[0] == '-'))
+    {
+        *negative = true;
+        limit = (cJSON_uint64)CJSON_INT64_MAX + 1;
+        i = 1;
+    }
+    if (i == length)
+    {
+        return false; /* no digits */
+    }
+
+    for (; i < length; i++)
+    {
+        unsigned int digit = 0;
+
+        if ((digits[i] < '0') || (digits[i] > '9'))
+        {
+            return false;
+        }
+        digit = (unsigned int)(digits[i] - '0');
+        if (*magnitude > ((limit - digit) / 10))
+        {
+            return false; /* too large */
+        }
+        *magnitude = (*magnitude * 10) + digit;
+    }
+
+    return true;
+}
+
+/* Print an integer into buffer, which needs room for 22 characters, and return its length. */
+static size_t format_integer(unsigned char * const buffer, const cJSON_bool negative, cJSON_uint64 magnitude)
+{
+    unsigned char digits[20];
+    size_t count = 0;
+    size_t length = 0;
+
+    do
+    {
+        digits[count++] = (unsigned char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    }
+    while (magnitude != 0);
+
+    if (negative)
+    {
+        buffer[length++] = '-';
+    }
+    while (count > 0)
+    {
+        buffer[length++] = digits[--count];
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* Make item a number with the value of an integer. Integers that a double can't represent keep their
+ * exact digits in valuestring, so that they can be printed and read back without losing precision. */
+static cJSON_bool set_integer(cJSON * const item, const cJSON_bool negative, const cJSON_uint64 magnitude, const internal_hooks * const hooks)
+{
+    double number = (double)magnitude;
+
+    cJSON_SetNumberHelper(item, negative ? -number : number);
+    item->type = cJSON_Number;
+
+    if ((magnitude > CJSON_MAX_SAFE_INTEGER) && (!negative || (magnitude <= ((cJSON_uint64)CJSON_INT64_MAX + 1))))
+    {
+        item->valuestring = (char*)hooks->allocate(22);
+        if (item->valuestring == NULL)
+        {
+            return false;
+        }
+        format_integer((unsigned char*)item->valuestring, negative, magnitude);
+    }
+
+    return true;
+}
+
+/* Get the exact value of a number created by set_integer (or kept as text by the parser). This fails if the number
+ * has no exact digits, cJSON_SetNumberHelper drops them when the value is changed. */
+static cJSON_bool get_exact_integer(const cJSON * const item, cJSON_bool * const negative, cJSON_uint64 * const magnitude)
+{
+    if ((item == NULL) || ((item->type & 0xFF) != cJSON_Number) || (item->valuestring == NULL))
+    {
+        return false;
+    }
+
+    return parse_exact_integer((const unsigned char*)item->valuestring, strlen(item->valuestring), negative, magnitude);
+}
+
+/* Check if a double has exactly the value of an integer, without rounding the integer to a double. */
+static cJSON_bool exact_integer_equals_double(const cJSON_bool negative, const cJSON_uint64 magnitude, const double number)
+{
+    const double absolute = negative ? -number : number;
+
+    if (magnitude == 0)
+    {
+        return number == 0;
+    }
+    if (!(absolute >= 1) || (absolute >= 18446744073709551616.0) || ((double)(cJSON_uint64)absolute != absolute))
+    {
+        return false; /* wrong sign, too large, fractional or NaN */
+    }
+
+    return (cJSON_uint64)absolute == magnitude;
+}
+
+static cJSON_int64 get_int64(const cJSON * const item)
+{
+    cJSON_bool negative = false;
+    cJSON_uint64 magnitude = 0;
+
+    if (get_exact_integer(item, &negative, &magnitude))
+    {
+        if (magnitude > (cJSON_uint64)CJSON_INT64_MAX)
+        {
+            return negative ? CJSON_INT64_MIN : CJSON_INT64_MAX;
+        }
+        return negative ? -(cJSON_int64)magnitude : (cJSON_int64)magnitude;
+    }
+
+    return double_to_int64(item->valuedouble);
+}
+
+CJSON_PUBLIC(cJSON_int64) cJSON_GetInt64Value(const cJSON * const item)
+{
+    if (!cJSON_IsNumber(item))
+    {
+        return 0;
+    }
+
+    return get_int64(item);
+}
+
+CJSON_PUBLIC(cJSON_uint64) cJSON_GetUInt64Value(const cJSON * const item)
+{
+    cJSON_bool negative = false;
+    cJSON_uint64 magnitude = 0;
+
+    if (!cJSON_IsNumber(item))
+    {
+        return 0;
+    }
+
+    if (get_exact_integer(item, &negative, &magnitude))
+    {
+        return negative ? 0 : magnitude;
+    }
+
+    /* truncate towards zero and saturate, NaN becomes 0 */
+    if (!(item->valuedouble > 0))
+    {
+        return 0;
+    }
+    if (item->valuedouble >= 18446744073709551616.0)
+    {
+        return CJSON_UINT64_MAX;
+    }
+
+    return (cJSON_uint64)item->valuedouble;
+}
+
+/* Replace valuestring of a parsed number with its text, which starts at start and ends at the current offset. */
+static cJSON_bool keep_number_text(cJSON * const item, parse_buffer * const input_buffer, const size_t start)
+{
+    const size_t length = input_buffer->offset - start;
+
+    if (item->valuestring != NULL)
+    {
+        input_buffer->hooks.deallocate(item->valuestring);
+    }
+    item->valuestring = (char*)input_buffer->hooks.allocate(length + 1);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    memcpy(item->valuestring, input_buffer->content + start, length);
+    item->valuestring[length] = '\0';
+
+    return true;
+}
+
 /* Parse the input text to generate a number, and populate the result into item. */
 static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
 {
@@ -313,11 +746,16 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
     size_t i = 0;
     size_t number_string_length = 0;
     cJSON_bool has_decimal_point = false;
+    cJSON_bool is_integer = true;
+    cJSON_bool negative = false;
+    cJSON_uint64 magnitude = 0;
+    size_t start = 0;
 
     if ((input_buffer == NULL) || (input_buffer->content == NULL))
     {
         return false;
     }
+    start = input_buffer->offset;
 
     /* copy the number into a temporary buffer and replace '.' with the decimal point
      * of the current locale (for strtod)
@@ -336,16 +774,25 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
             case '7':
             case '8':
             case '9':
-            case '+':
+                number_string_length++;
+                break;
+
             case '-':
+                number_string_length++;
+                is_integer = is_integer && (i == 0);
+                break;
+
+            case '+':
             case 'e':
             case 'E':
                 number_string_length++;
+                is_integer = false;
                 break;
 
             case '.':
                 number_string_length++;
                 has_decimal_point = true;
+                is_integer = false;
                 break;
 
             default:
@@ -353,6 +800,17 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
         }
     }
 loop_end:
+    if (is_integer && parse_exact_integer(buffer_at_offset(input_buffer), number_string_length, &negative, &magnitude))
+    {
+        /* converting integers directly is exact and a lot faster than strtod */
+        if (!set_integer(item, negative, magnitude, &(input_buffer->hooks)))
+        {
+            return false;
+        }
+        input_buffer->offset += number_string_length;
+        goto success;
+    }
+
     /* malloc for temporary buffer, add 1 for '\0' */
     number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
     if (number_c_string == NULL)
@@ -404,12 +862,26 @@ loop_end:
     input_buffer->offset += (size_t)(after_end - number_c_string);
     /* free the temporary buffer */
     input_buffer->hooks.deallocate(number_c_string);
+
+success:
+    if ((input_buffer->options != NULL) && input_buffer->options->keep_number_text)
+    {
+        return keep_number_text(item, input_buffer, start);
+    }
+
     return true;
 }
 
 /* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
 CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
 {
+    /* the exact digits of a large integer would be out of date */
+    if (((object->type & 0xFF) == cJSON_Number) && !(object->type & cJSON_IsReference) && (object->valuestring != NULL))
+    {
+        global_hooks.deallocate(object->valuestring);
+        object->valuestring = NULL;
+    }
+
     if (number >= INT_MAX)
     {
         object->valueint = INT_MAX;
@@ -470,6 +942,13 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
     return copy;
 }
 
+/* destination of cJSON_PrintToWriter, the printbuffer is flushed into it whenever it runs full */
+typedef struct
+{
+    cJSON_WriteCallback write;
+    void *user_data;
+} print_sink;
+
 typedef struct
 {
     unsigned char *buffer;
@@ -478,24 +957,46 @@ typedef struct
     size_t depth; /* current nesting depth (for formatted printing) */
     cJSON_bool noalloc;
     cJSON_bool format; /* is this print a formatted print */
-    /* 新增：美化打印配置 */
+    internal_hooks hooks;
+    /* 美化打印配置，indent_char为'\0'时与cJSON_Print一致（每层一个制表符） */
     int indent_count;           /* 缩进数量（如2表示缩进2个字符） */
     char indent_char;           /* 缩进字符（空格或制表符） */
-    internal_hooks hooks;
+    const print_sink *sink; /* if not NULL, completed output is handed to the sink instead of growing the buffer */
 } printbuffer;
 
-/* realloc printbuffer if necessary to have at least "needed" bytes more */
-static unsigned char* ensure(printbuffer * const p, size_t needed)
+/* number of indentation characters per nesting level */
+static size_t get_indent_width(const printbuffer * const p)
 {
-    unsigned char *newbuffer = NULL;
-    size_t newsize = 0;
-
-    if ((p == NULL) || (p->buffer == NULL))
+    if (p->indent_char == '\0')
     {
-        return NULL;
+        return 1;
     }
 
-    if ((p->length > 0) && (p->offset >= p->length))
+    return (p->indent_count > 0) ? (size_t)p->indent_count : 0;
+}
+
+static unsigned char get_indent_char(const printbuffer * const p)
+{
+    if (p->indent_char == '\0')
+    {
+        return '\t';
+    }
+
+    return (unsigned char)p->indent_char;
+}
+
+/* realloc printbuffer if necessary to have at least "needed" bytes more */
+static unsigned char* ensure(printbuffer * const p, size_t needed)
+{
+    unsigned char *newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((p == NULL) || (p->buffer == NULL))
+    {
+        return NULL;
+    }
+
+    if ((p->length > 0) && (p->offset >= p->length))
     {
         /* make sure that offset is valid */
         return NULL;
@@ -517,6 +1018,22 @@ static unsigned char* ensure(printbuffer * const p, size_t needed)
         return NULL;
     }
 
+    if ((p->sink != NULL) && (p->offset > 0))
+    {
+        /* hand everything that has been printed so far to the sink and reuse the buffer */
+        if (!p->sink->write((const char*)p->buffer, p->offset, p->sink->user_data))
+        {
+            return NULL;
+        }
+        needed -= p->offset;
+        p->offset = 0;
+        p->buffer[0] = '\0';
+        if (needed <= p->length)
+        {
+            return p->buffer;
+        }
+    }
+
     /* calculate new buffer size */
     if (needed > (INT_MAX / 2))
     {
@@ -600,20 +1117,46 @@ static cJSON_bool print_number(const cJSON * const item, printbuffer * const out
     unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
     unsigned char decimal_point = get_decimal_point();
     double test = 0.0;
+    cJSON_bool negative = false;
+    cJSON_uint64 magnitude = 0;
 
     if (output_buffer == NULL)
     {
         return false;
     }
 
+    if (item->valuestring != NULL)
+    {
+        /* print the exact digits or the text the number was parsed from (it was validated by parse_number) */
+        length = (int)strlen(item->valuestring);
+        output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        memcpy(output_pointer, item->valuestring, (size_t)length + sizeof(""));
+        output_buffer->offset += (size_t)length;
+
+        return true;
+    }
+
+    if (get_exact_integer(item, &negative, &magnitude))
+    {
+        length = (int)format_integer(number_buffer, negative, magnitude);
+    }
     /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
+    else if (isnan(d) || isinf(d))
     {
         length = sprintf((char*)number_buffer, "null");
     }
     else if(d == (double)item->valueint)
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        length = (int)format_integer(number_buffer, item->valueint < 0, (cJSON_uint64)((item->valueint < 0) ? -(cJSON_int64)item->valueint : (cJSON_int64)item->valueint));
+    }
+    else if ((fabs(d) < 1e15) && (d == floor(d)))
+    {
+        /* integers that "%1.15g" would print with all of their digits anyway */
+        length = (int)format_integer(number_buffer, d < 0, (cJSON_uint64)fabs(d));
     }
     else
     {
@@ -1083,6 +1626,10 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
 static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
 static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
 static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool skip_value(parse_buffer * const input_buffer);
+static cJSON_bool parse_raw_value(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool skip_unwanted_member(parse_buffer * const input_buffer, cJSON_bool * const skipped);
+static char *parse_interned_key(parse_buffer * const input_buffer);
 
 /* Utility to jump whitespace and cr/lf */
 static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
@@ -1142,9 +1689,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 }
 
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+static cJSON *parse_with_options(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, const parse_options * const options)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
     cJSON *item = NULL;
 
     /* reset error position */
@@ -1160,6 +1707,7 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.length = buffer_length;
     buffer.offset = 0;
     buffer.hooks = global_hooks;
+    buffer.options = options;
 
     item = cJSON_New_Item(&global_hooks);
     if (item == NULL) /* memory fail */
@@ -1221,312 +1769,193 @@ fail:
     return NULL;
 }
 
-/* Default options for cJSON_Parse */
-CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
-{
-    return cJSON_ParseWithOpts(value, 0, 0);
-}
-
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
 {
-    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+    return parse_with_options(value, buffer_length, return_parse_end, require_null_terminated, NULL);
 }
 
-#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
-
-static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithKeyTable(const char *value, size_t buffer_length, cJSON_KeyTable *keys, const char **return_parse_end)
 {
-    static const size_t default_buffer_size = 256;
-    printbuffer buffer[1];
-    unsigned char *printed = NULL;
-
-    memset(buffer, 0, sizeof(buffer));
-
-    /* create buffer */
-    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
-    buffer->length = default_buffer_size;
-    buffer->format = format;
-    buffer->hooks = *hooks;
-    if (buffer->buffer == NULL)
-    {
-        goto fail;
-    }
-
-    /* print the value */
-    if (!print_value(item, buffer))
-    {
-        goto fail;
-    }
-    update_offset(buffer);
-
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
-    {
-        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL) {
-            goto fail;
-        }
-        buffer->buffer = NULL;
-    }
-    else /* otherwise copy the JSON over to a new buffer */
-    {
-        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
-        {
-            goto fail;
-        }
-        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
+    parse_options options;
 
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
-    }
+    memset(&options, 0, sizeof(options));
+    options.keys = keys;
 
-    return printed;
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
+}
 
-fail:
-    if (buffer->buffer != NULL)
-    {
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
-    }
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithPackedArrays(const char *value, size_t buffer_length, const char **return_parse_end)
+{
+    parse_options options;
 
-    if (printed != NULL)
-    {
-        hooks->deallocate(printed);
-        printed = NULL;
-    }
+    memset(&options, 0, sizeof(options));
+    options.pack_arrays = true;
 
-    return NULL;
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
 }
 
-/* Render a cJSON item/entity/structure to text. */
-CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item)
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithNumberText(const char *value, size_t buffer_length, const char **return_parse_end)
 {
-    return (char*)print(item, true, &global_hooks);
-}
+    parse_options options;
 
-CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
-{
-    return (char*)print(item, false, &global_hooks);
+    memset(&options, 0, sizeof(options));
+    options.keep_number_text = true;
+
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
 }
 
-CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithRawMembers(const char *value, size_t buffer_length, const char * const *members, int member_count, const char **return_parse_end)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_options options;
 
-    if (prebuffer < 0)
+    if ((member_count < 0) || ((members == NULL) && (member_count > 0)))
     {
         return NULL;
     }
 
-    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
-    if (!p.buffer)
-    {
-        return NULL;
-    }
+    memset(&options, 0, sizeof(options));
+    options.raw_members = members;
+    options.raw_member_count = (size_t)member_count;
 
-    p.length = (size_t)prebuffer;
-    p.offset = 0;
-    p.noalloc = false;
-    p.format = fmt;
-    p.hooks = global_hooks;
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
+}
 
-    if (!print_value(item, &p))
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithRawDepth(const char *value, size_t buffer_length, int depth, const char **return_parse_end)
+{
+    parse_options options;
+
+    if (depth < 1)
     {
-        global_hooks.deallocate(p.buffer);
-        p.buffer = NULL;
         return NULL;
     }
 
-    return (char*)p.buffer;
+    memset(&options, 0, sizeof(options));
+    options.raw_depth = (size_t)depth;
+
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
+CJSON_PUBLIC(cJSON *) cJSON_ParseMembers(const char *value, size_t buffer_length, const char * const *members, int member_count, const char **return_parse_end)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_options options;
 
-    if ((length < 0) || (buffer == NULL))
+    if ((member_count < 0) || ((members == NULL) && (member_count > 0)))
     {
-        return false;
+        return NULL;
     }
 
-    p.buffer = (unsigned char*)buffer;
-    p.length = (size_t)length;
-    p.offset = 0;
-    p.noalloc = true;
-    p.format = format;
-    p.hooks = global_hooks;
+    memset(&options, 0, sizeof(options));
+    options.members = members;
+    options.member_count = (size_t)member_count;
 
-    return print_value(item, &p);
+    return parse_with_options(value, buffer_length, return_parse_end, false, &options);
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
+CJSON_PUBLIC(int) cJSON_SplitArray(const char *value, size_t buffer_length, size_t *chunk_starts, int max_chunks)
 {
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
-    {
-        return false; /* no input */
-    }
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+    size_t chunk_size = 0;
+    size_t depth = 0;
+    int chunk_count = 1;
 
-    /* parse the different types of values */
-    /* null */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
-    {
-        item->type = cJSON_NULL;
-        input_buffer->offset += 4;
-        return true;
-    }
-    /* false */
-    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
-    {
-        item->type = cJSON_False;
-        input_buffer->offset += 5;
-        return true;
-    }
-    /* true */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    if ((value == NULL) || (buffer_length == 0) || (chunk_starts == NULL) || (max_chunks < 1))
     {
-        item->type = cJSON_True;
-        item->valueint = 1;
-        input_buffer->offset += 4;
-        return true;
-    }
-    /* string */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
-    {
-        return parse_string(item, input_buffer);
-    }
-    /* number */
-    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
-    {
-        return parse_number(item, input_buffer);
+        return 0;
     }
-    /* array */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+
+    chunk_starts[0] = 0;
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer_skip_whitespace(skip_utf8_bom(&buffer));
+    if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != '['))
     {
-        return parse_array(item, input_buffer);
+        /* not an array, parsing the only chunk reports the error */
+        return 1;
     }
-    /* object */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+
+    chunk_size = buffer_length / (size_t)max_chunks;
+    /* only strings and nesting matter for finding the commas between the top level elements,
+     * everything else is validated when the chunks are parsed */
+    for (buffer.offset++; can_access_at_index(&buffer, 0) && (chunk_count < max_chunks); buffer.offset++)
     {
-        return parse_object(item, input_buffer);
+        switch (buffer_at_offset(&buffer)[0])
+        {
+            case '\"':
+                /* skip to the end of the string, escaped quotes don't end it */
+                for (buffer.offset++; can_access_at_index(&buffer, 0) && (buffer_at_offset(&buffer)[0] != '\"'); buffer.offset++)
+                {
+                    if (buffer_at_offset(&buffer)[0] == '\\')
+                    {
+                        buffer.offset++;
+                    }
+                }
+                break;
+
+            case '[':
+            case '{':
+                depth++;
+                break;
+
+            case ']':
+            case '}':
+                if (depth == 0)
+                {
+                    /* end of the top level array */
+                    return chunk_count;
+                }
+                depth--;
+                break;
+
+            case ',':
+                /* a comma at the end of the buffer doesn't start a chunk, the chunk in front of it reports the error */
+                if ((depth == 0) && ((buffer.offset + 1 - chunk_starts[chunk_count - 1]) >= chunk_size) && can_access_at_index(&buffer, 1))
+                {
+                    chunk_starts[chunk_count] = buffer.offset + 1;
+                    chunk_count++;
+                }
+                break;
+
+            default:
+                break;
+        }
     }
 
-    return false;
+    return chunk_count;
 }
 
-/* Render a value to text. */
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+/* Build an array from the elements of one chunk. The buffer starts at the '[' of the array or at the comma in front of the chunk,
+ * and this follows parse_array step by step so that errors are found at the same positions. */
+static cJSON_bool parse_array_chunk(cJSON * const item, parse_buffer * const input_buffer, const size_t end, const cJSON_bool last)
 {
-    unsigned char *output = NULL;
-
-    if ((item == NULL) || (output_buffer == NULL))
-    {
-        return false;
-    }
+    cJSON *head = NULL; /* head of the linked list */
+    cJSON *current_item = NULL;
 
-    switch ((item->type) & 0xFF)
+    if (buffer_at_offset(input_buffer)[0] == '[')
     {
-        case cJSON_NULL:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+        {
+            /* empty array */
+            if (!last)
             {
                 return false;
             }
-            strcpy((char*)output, "null");
-            return true;
+            goto success;
+        }
 
-        case cJSON_False:
-            output = ensure(output_buffer, 6);
-            if (output == NULL)
-            {
-                return false;
-            }
-            strcpy((char*)output, "false");
-            return true;
+        /* check if we skipped to the end of the buffer */
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            input_buffer->offset--;
+            return false;
+        }
 
-        case cJSON_True:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
-            {
-                return false;
-            }
-            strcpy((char*)output, "true");
-            return true;
-
-        case cJSON_Number:
-            return print_number(item, output_buffer);
-
-        case cJSON_Raw:
-        {
-            size_t raw_length = 0;
-            if (item->valuestring == NULL)
-            {
-                return false;
-            }
-
-            raw_length = strlen(item->valuestring) + sizeof("");
-            output = ensure(output_buffer, raw_length);
-            if (output == NULL)
-            {
-                return false;
-            }
-            memcpy(output, item->valuestring, raw_length);
-            return true;
-        }
-
-        case cJSON_String:
-            return print_string(item, output_buffer);
-
-        case cJSON_Array:
-            return print_array(item, output_buffer);
-
-        case cJSON_Object:
-            return print_object(item, output_buffer);
-
-        default:
-            return false;
-    }
-}
-
-/* Build an array from input text. */
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer)
-{
-    cJSON *head = NULL; /* head of the linked list */
-    cJSON *current_item = NULL;
-
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
-    {
-        return false; /* to deeply nested */
-    }
-    input_buffer->depth++;
-
-    if (buffer_at_offset(input_buffer)[0] != '[')
-    {
-        /* not an array */
-        goto fail;
-    }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
-    {
-        /* empty array */
-        goto success;
-    }
-
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
-    {
+        /* step back to character in front of the first element */
         input_buffer->offset--;
-        goto fail;
     }
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
+    /* loop through the comma separated array elements of the chunk */
     do
     {
         /* allocate next item */
@@ -1559,17 +1988,24 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
         }
         buffer_skip_whitespace(input_buffer);
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ',') && (last || ((input_buffer->offset + 1) < end)));
 
-    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    if (!last)
+    {
+        /* the next chunk starts after the comma */
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ',') || ((input_buffer->offset + 1) != end))
+        {
+            goto fail;
+        }
+    }
+    else if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ']'))
     {
         goto fail; /* expected end of array */
     }
 
 success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
+    if (head != NULL)
+    {
         head->prev = current_item;
     }
 
@@ -1589,1640 +2025,5845 @@ fail:
     return false;
 }
 
-/* Render an array to text */
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer)
+CJSON_PUBLIC(cJSON *) cJSON_ParseArrayChunk(const char *value, size_t buffer_length, const size_t *chunk_starts, int chunk_count, int chunk, const char **return_parse_end)
 {
-    unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    cJSON *current_element = item->child;
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+    cJSON *item = NULL;
+    size_t end = buffer_length;
 
-    if (output_buffer == NULL)
+    if ((value == NULL) || (buffer_length == 0) || (chunk_starts == NULL) || (chunk < 0) || (chunk >= chunk_count))
     {
-        return false;
+        return NULL;
     }
-
-    /* 输出左括号 */
-    output_pointer = ensure(output_buffer, 1);
-    if (output_pointer == NULL)
+    if ((chunk + 1) < chunk_count)
     {
-        return false;
+        end = chunk_starts[chunk + 1];
+    }
+    if ((end > buffer_length) || ((chunk > 0) && ((chunk_starts[chunk] == 0) || (chunk_starts[chunk] >= end))))
+    {
+        return NULL;
     }
 
-    *output_pointer = '[';
-    output_buffer->offset++;
-    output_buffer->depth++;
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
+    /* the elements are nested in the top level array */
+    buffer.depth = 1;
 
-    while (current_element != NULL)
+    item = cJSON_New_Item(&global_hooks);
+    if (item == NULL) /* memory fail */
     {
-        if (output_buffer->format)
-        {
-            size_t i;
-            size_t indent_size = output_buffer->depth * output_buffer->indent_count;
-            output_pointer = ensure(output_buffer, indent_size);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            for (i = 0; i < indent_size; i++)
-            {
-                *output_pointer++ = output_buffer->indent_char;
-            }
-            output_buffer->offset += indent_size;
-        }
-
-        if (!print_value(current_element, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
-        
-        if (current_element->next)
-        {
-            length = (size_t)(output_buffer->format ? 2 : 1);
-            output_pointer = ensure(output_buffer, length + 1);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            *output_pointer++ = ',';
-            if(output_buffer->format)
-            {
-                *output_pointer++ = ' ';
-            }
-            *output_pointer = '\0';
-            output_buffer->offset += length;
-        }
-        current_element = current_element->next;
+        goto fail;
     }
 
-    /* 输出右括号前的缩进 */
-    if (output_buffer->format && (output_buffer->depth > 1))
+    if (chunk == 0)
     {
-        size_t i;
-        size_t indent_size = (output_buffer->depth - 1) * output_buffer->indent_count;
-        output_pointer = ensure(output_buffer, indent_size);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        for (i = 0; i < indent_size; i++)
+        buffer_skip_whitespace(skip_utf8_bom(&buffer));
+        if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != '['))
         {
-            *output_pointer++ = output_buffer->indent_char;
+            /* not an array: parse it anyway so that errors in it are found where the serial parser finds them,
+             * a valid value fails at its start */
+            const size_t start = buffer.offset;
+
+            buffer.depth = 0;
+            if (parse_value(item, &buffer))
+            {
+                buffer.offset = start;
+            }
+            goto fail;
         }
-        output_buffer->offset += indent_size;
     }
-
-    output_pointer = ensure(output_buffer, 2);
-    if (output_pointer == NULL)
+    else
     {
-        return false;
+        /* start at the comma in front of the chunk */
+        buffer.offset = chunk_starts[chunk] - 1;
     }
-    *output_pointer++ = ']';
-    *output_pointer = '\0';
-    output_buffer->depth--;
-
-    return true;
-}
 
-/* Build an object from the text. */
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer)
-{
-    cJSON *head = NULL; /* linked list head */
-    cJSON *current_item = NULL;
-
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (!parse_array_chunk(item, &buffer, end, (chunk + 1) == chunk_count))
     {
-        return false; /* to deeply nested */
+        goto fail;
     }
-    input_buffer->depth++;
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    if (return_parse_end)
     {
-        goto fail; /* not an object */
+        *return_parse_end = (const char*)buffer_at_offset(&buffer);
     }
 
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
-    {
-        goto success; /* empty object */
-    }
+    return item;
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+fail:
+    if (item != NULL)
     {
-        input_buffer->offset--;
-        goto fail;
+        cJSON_Delete(item);
     }
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    /* same error position as parse_with_options, but global_error isn't touched because chunks are parsed concurrently */
+    if (return_parse_end != NULL)
     {
-        /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
-
-        /* attach next item to list */
-        if (head == NULL)
+        if (buffer.offset < buffer.length)
         {
-            /* start the linked list */
-            current_item = head = new_item;
+            *return_parse_end = value + buffer.offset;
         }
         else
         {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
+            *return_parse_end = value + buffer.length - 1;
         }
+    }
 
-        if (cannot_access_at_index(input_buffer, 1))
-        {
-            goto fail; /* nothing comes after the comma */
-        }
+    return NULL;
+}
 
-        /* parse the name of the child */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
-        {
-            goto fail; /* failed to parse name */
-        }
-        buffer_skip_whitespace(input_buffer);
+CJSON_PUBLIC(cJSON_bool) cJSON_AppendArrayChunk(cJSON *array, cJSON *chunk)
+{
+    cJSON *tail = NULL;
 
-        /* swap valuestring and string, because we parsed the name */
-        current_item->string = current_item->valuestring;
-        current_item->valuestring = NULL;
+    if ((array == chunk) || !cJSON_IsArray(array) || !cJSON_IsArray(chunk) || (chunk->type & cJSON_IsReference))
+    {
+        return false;
+    }
+    if (!cJSON_UnpackArray(array) || !cJSON_UnpackArray(chunk))
+    {
+        return false;
+    }
 
-        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    if (chunk->child != NULL)
+    {
+        if (array->child == NULL)
         {
-            goto fail; /* invalid object */
+            array->child = chunk->child;
         }
-
-        /* parse the value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+        else
         {
-            goto fail; /* failed to parse value */
+            /* link the lists through their tails, the prev pointer of the first element */
+            tail = array->child->prev;
+            tail->next = chunk->child;
+            array->child->prev = chunk->child->prev;
+            chunk->child->prev = tail;
         }
-        buffer_skip_whitespace(input_buffer);
+        chunk->child = NULL;
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+    cJSON_Delete(chunk);
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
-    {
-        goto fail; /* expected end of object */
-    }
+    return true;
+}
 
-success:
-    input_buffer->depth--;
+/* Default options for cJSON_Parse */
+CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
+{
+    return cJSON_ParseWithOpts(value, 0, 0);
+}
 
-    if (head != NULL) {
-        head->prev = current_item;
-    }
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
+
+static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer buffer[1];
+    unsigned char *printed = NULL;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    /* create buffer */
+    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
+    buffer->length = default_buffer_size;
+    buffer->format = format;
+    buffer->hooks = *hooks;
+    if (buffer->buffer == NULL)
+    {
+        goto fail;
+    }
+
+    /* print the value */
+    if (!print_value(item, buffer))
+    {
+        goto fail;
+    }
+    update_offset(buffer);
+
+    /* check if reallocate is available */
+    if (hooks->reallocate != NULL)
+    {
+        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
+        if (printed == NULL) {
+            goto fail;
+        }
+        buffer->buffer = NULL;
+    }
+    else /* otherwise copy the JSON over to a new buffer */
+    {
+        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
+        if (printed == NULL)
+        {
+            goto fail;
+        }
+        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
+        printed[buffer->offset] = '\0'; /* just to be sure */
+
+        /* free the buffer */
+        hooks->deallocate(buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    return printed;
+
+fail:
+    if (buffer->buffer != NULL)
+    {
+        hooks->deallocate(buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    if (printed != NULL)
+    {
+        hooks->deallocate(printed);
+        printed = NULL;
+    }
+
+    return NULL;
+}
+
+/* Render a cJSON item/entity/structure to text. */
+CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item)
+{
+    return (char*)print(item, true, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
+{
+    return (char*)print(item, false, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, NULL };
+
+    if (prebuffer < 0)
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
+    if (!p.buffer)
+    {
+        return NULL;
+    }
+
+    p.length = (size_t)prebuffer;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = fmt;
+    p.hooks = global_hooks;
+
+    if (!print_value(item, &p))
+    {
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, NULL };
+
+    if ((length < 0) || (buffer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char*)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+
+    return print_value(item, &p);
+}
+
+struct cJSON_Writer
+{
+    printbuffer buffer;
+    print_sink sink;
+    cJSON_bool failed;
+};
+
+static cJSON_bool init_writer(cJSON_Writer * const writer, const cJSON_bool format, cJSON_WriteCallback write_fn, void *user_data)
+{
+    static const size_t chunk_size = 4096;
+
+    memset(writer, '\0', sizeof(cJSON_Writer));
+    writer->sink.write = write_fn;
+    writer->sink.user_data = user_data;
+
+    writer->buffer.buffer = (unsigned char*)global_hooks.allocate(chunk_size);
+    if (writer->buffer.buffer == NULL)
+    {
+        return false;
+    }
+
+    writer->buffer.length = chunk_size;
+    writer->buffer.offset = 0;
+    writer->buffer.noalloc = false;
+    writer->buffer.format = format;
+    writer->buffer.hooks = global_hooks;
+    writer->buffer.sink = &writer->sink;
+
+    return true;
+}
+
+/* flush the rest and free the buffer */
+static cJSON_bool finish_writer(cJSON_Writer * const writer)
+{
+    cJSON_bool success = !writer->failed && (writer->buffer.buffer != NULL);
+
+    if (success && (writer->buffer.offset > 0))
+    {
+        success = writer->sink.write((const char*)writer->buffer.buffer, writer->buffer.offset, writer->sink.user_data);
+    }
+
+    if (writer->buffer.buffer != NULL)
+    {
+        writer->buffer.hooks.deallocate(writer->buffer.buffer);
+        writer->buffer.buffer = NULL;
+    }
+
+    return success;
+}
+
+CJSON_PUBLIC(cJSON_Writer *) cJSON_CreateWriter(const cJSON_bool format, cJSON_WriteCallback write_fn, void *user_data)
+{
+    cJSON_Writer *writer = NULL;
+
+    if (write_fn == NULL)
+    {
+        return NULL;
+    }
+
+    writer = (cJSON_Writer*)global_hooks.allocate(sizeof(cJSON_Writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    if (!init_writer(writer, format, write_fn, user_data))
+    {
+        global_hooks.deallocate(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteItem(cJSON_Writer *writer, const cJSON *item)
+{
+    if ((writer == NULL) || (item == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if (!print_value(item, &writer->buffer))
+    {
+        writer->failed = true;
+        return false;
+    }
+    update_offset(&writer->buffer);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteText(cJSON_Writer *writer, const char *text, size_t length)
+{
+    unsigned char *output_pointer = NULL;
+
+    if ((writer == NULL) || (text == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    output_pointer = ensure(&writer->buffer, length);
+    if (output_pointer == NULL)
+    {
+        writer->failed = true;
+        return false;
+    }
+    memcpy(output_pointer, text, length);
+    output_pointer[length] = '\0';
+    writer->buffer.offset += length;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_CloseWriter(cJSON_Writer *writer)
+{
+    cJSON_bool success = false;
+
+    if (writer == NULL)
+    {
+        return false;
+    }
+
+    success = finish_writer(writer);
+    global_hooks.deallocate(writer);
+
+    return success;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToWriter(const cJSON *item, const cJSON_bool format, cJSON_WriteCallback write_fn, void *user_data)
+{
+    cJSON_Writer writer;
+    cJSON_bool success = false;
+
+    if ((item == NULL) || (write_fn == NULL))
+    {
+        return false;
+    }
+
+    if (!init_writer(&writer, format, write_fn, user_data))
+    {
+        return false;
+    }
+    success = cJSON_WriteItem(&writer, item);
+
+    return finish_writer(&writer) && success;
+}
+
+/* Parser core - when encountering text, process appropriately. */
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* parse the different types of values */
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        item->type = cJSON_NULL;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        item->type = cJSON_False;
+        input_buffer->offset += 5;
+        return true;
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        item->type = cJSON_True;
+        item->valueint = 1;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return parse_string(item, input_buffer);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        return parse_number(item, input_buffer);
+    }
+    /* arrays and objects that are nested deep enough are only validated and kept as text */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '[') || (buffer_at_offset(input_buffer)[0] == '{'))
+        && (input_buffer->options != NULL) && (input_buffer->options->raw_depth > 0) && (input_buffer->depth >= input_buffer->options->raw_depth))
+    {
+        return parse_raw_value(item, input_buffer);
+    }
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return parse_array(item, input_buffer);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return parse_object(item, input_buffer);
+    }
+
+    return false;
+}
+
+/* Render a value to text. */
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+
+    if ((item == NULL) || (output_buffer == NULL))
+    {
+        return false;
+    }
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+            output = ensure(output_buffer, 5);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "null");
+            return true;
+
+        case cJSON_False:
+            output = ensure(output_buffer, 6);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "false");
+            return true;
+
+        case cJSON_True:
+            output = ensure(output_buffer, 5);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "true");
+            return true;
+
+        case cJSON_Number:
+            return print_number(item, output_buffer);
+
+        case cJSON_Raw:
+        {
+            size_t raw_length = 0;
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+
+            raw_length = strlen(item->valuestring) + sizeof("");
+            output = ensure(output_buffer, raw_length);
+            if (output == NULL)
+            {
+                return false;
+            }
+            memcpy(output, item->valuestring, raw_length);
+            return true;
+        }
+
+        case cJSON_String:
+            return print_string(item, output_buffer);
+
+        case cJSON_Array:
+            return print_array(item, output_buffer);
+
+        case cJSON_Object:
+            return print_object(item, output_buffer);
+
+        default:
+            return false;
+    }
+}
+
+/* Packed arrays store their numbers in valuestring as valueint doubles instead of child items. */
+static double get_packed_number(const cJSON * const array, const size_t index)
+{
+    double number = 0;
+    memcpy(&number, array->valuestring + (index * sizeof(double)), sizeof(double));
+
+    return number;
+}
+
+/* Parse an array that only contains numbers (starting at the '[') into a packed array. If there is anything
+ * else in it, the buffer is left untouched so that parse_array can build it (or report the error). */
+static cJSON_bool parse_packed_array(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const size_t start = input_buffer->offset;
+    unsigned char *numbers = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    cJSON number[1];
+
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (cannot_access_at_index(input_buffer, 0)
+            || ((buffer_at_offset(input_buffer)[0] != '-') && ((buffer_at_offset(input_buffer)[0] < '0') || (buffer_at_offset(input_buffer)[0] > '9'))))
+        {
+            goto fail; /* not a number */
+        }
+
+        memset(number, '\0', sizeof(number));
+        if (!parse_number(number, input_buffer))
+        {
+            goto fail;
+        }
+        if (number->valuestring != NULL)
+        {
+            /* a double can't hold this integer exactly */
+            input_buffer->hooks.deallocate(number->valuestring);
+            goto fail;
+        }
+
+        if (count == capacity)
+        {
+            unsigned char *grown = NULL;
+
+            capacity = (capacity == 0) ? 16 : (capacity * 2);
+            if (capacity > ((size_t)INT_MAX / sizeof(double)))
+            {
+                goto fail; /* the size has to fit into valueint */
+            }
+            grown = (unsigned char*)input_buffer->hooks.allocate(capacity * sizeof(double));
+            if (grown == NULL)
+            {
+                goto fail;
+            }
+            if (numbers != NULL)
+            {
+                memcpy(grown, numbers, count * sizeof(double));
+                input_buffer->hooks.deallocate(numbers);
+            }
+            numbers = grown;
+        }
+        memcpy(numbers + (count * sizeof(double)), &number->valuedouble, sizeof(double));
+        count++;
+
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ']'))
+    {
+        goto fail; /* expected end of array */
+    }
+    input_buffer->offset++;
+
+    item->type = cJSON_Array | cJSON_IsPacked;
+    item->valuestring = (char*)numbers;
+    item->valueint = (int)count;
+
+    return true;
+
+fail:
+    if (numbers != NULL)
+    {
+        input_buffer->hooks.deallocate(numbers);
+    }
+    input_buffer->offset = start;
+
+    return false;
+}
+
+/* Build an array from input text. */
+static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer)
+{
+    cJSON *head = NULL; /* head of the linked list */
+    cJSON *current_item = NULL;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (buffer_at_offset(input_buffer)[0] != '[')
+    {
+        /* not an array */
+        goto fail;
+    }
+
+    if ((input_buffer->options != NULL) && input_buffer->options->pack_arrays && parse_packed_array(item, input_buffer))
+    {
+        input_buffer->depth--;
+        return true;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        goto fail;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        /* allocate next item */
+        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        if (new_item == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+
+        /* parse next value */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!parse_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        goto fail; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (head != NULL) {
+        head->prev = current_item;
+    }
+
+    item->type = cJSON_Array;
+    item->child = head;
+
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    if (head != NULL)
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+/* Render the separator between two array elements */
+static cJSON_bool print_element_separator(printbuffer * const output_buffer)
+{
+    size_t length = (size_t) (output_buffer->format ? 2 : 1);
+    unsigned char *output_pointer = ensure(output_buffer, length + 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ',';
+    if(output_buffer->format)
+    {
+        *output_pointer++ = ' ';
+    }
+    *output_pointer = '\0';
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* cJSON_PrintPretty indents every array element by its depth, cJSON_Print keeps arrays on one line */
+static cJSON_bool print_array_indent(printbuffer * const output_buffer, const size_t depth)
+{
+    size_t indent_size = 0;
+    unsigned char *output_pointer = NULL;
+
+    if (!output_buffer->format || (output_buffer->indent_char == '\0'))
+    {
+        return true;
+    }
+
+    indent_size = depth * get_indent_width(output_buffer);
+    output_pointer = ensure(output_buffer, indent_size + 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    memset(output_pointer, get_indent_char(output_buffer), indent_size);
+    output_pointer[indent_size] = '\0';
+    output_buffer->offset += indent_size;
+
+    return true;
+}
+
+/* Print the elements of a packed array with print_function, one number item at a time.
+ * Text output also needs the separators and print_function doesn't update the offset there. */
+static cJSON_bool print_packed_numbers(const cJSON * const item, printbuffer * const output_buffer, const cJSON_bool as_text, cJSON_bool (*print_function)(const cJSON * const item, printbuffer * const output_buffer))
+{
+    cJSON number[1];
+    size_t i = 0;
+
+    memset(number, '\0', sizeof(number));
+    number->type = cJSON_Number;
+    for (i = 0; i < (size_t)item->valueint; i++)
+    {
+        if (as_text && (i > 0) && !print_element_separator(output_buffer))
+        {
+            return false;
+        }
+        if (as_text && !print_array_indent(output_buffer, output_buffer->depth))
+        {
+            return false;
+        }
+        cJSON_SetNumberHelper(number, get_packed_number(item, i));
+        if (!print_function(number, output_buffer))
+        {
+            return false;
+        }
+        if (as_text)
+        {
+            update_offset(output_buffer);
+        }
+    }
+
+    return true;
+}
+
+/* Render an array to text */
+static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    cJSON *current_element = item->child;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* Compose the output array. */
+    /* opening square bracket */
+    output_pointer = ensure(output_buffer, 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer = '[';
+    output_buffer->offset++;
+    output_buffer->depth++;
+
+    if ((item->type & cJSON_IsPacked) && !print_packed_numbers(item, output_buffer, true, print_number))
+    {
+        return false;
+    }
+
+    while (current_element != NULL)
+    {
+        if (!print_array_indent(output_buffer, output_buffer->depth))
+        {
+            return false;
+        }
+        if (!print_value(current_element, output_buffer))
+        {
+            return false;
+        }
+        update_offset(output_buffer);
+        if (current_element->next && !print_element_separator(output_buffer))
+        {
+            return false;
+        }
+        current_element = current_element->next;
+    }
+
+    if (!print_array_indent(output_buffer, output_buffer->depth - 1))
+    {
+        return false;
+    }
+
+    output_pointer = ensure(output_buffer, 2);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ']';
+    *output_pointer = '\0';
+    output_buffer->depth--;
+
+    return true;
+}
+
+/* check if the value of a top level member with this name should be kept as a raw item */
+static cJSON_bool is_raw_member(const parse_options * const options, const char * const name)
+{
+    size_t i = 0;
+
+    if ((options == NULL) || (options->raw_members == NULL) || (name == NULL))
+    {
+        return false;
+    }
+
+    for (i = 0; i < options->raw_member_count; i++)
+    {
+        if ((options->raw_members[i] != NULL) && (strcmp(options->raw_members[i], name) == 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Build an object from the text. */
+static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer)
+{
+    cJSON *head = NULL; /* linked list head */
+    cJSON *current_item = NULL;
+    char *interned_key = NULL;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    {
+        goto fail; /* not an object */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        goto fail;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        cJSON *new_item = NULL;
+
+        /* only the requested members of the top level object are built */
+        if ((input_buffer->depth == 1) && (input_buffer->options != NULL) && (input_buffer->options->members != NULL))
+        {
+            cJSON_bool skipped = false;
+            if (!skip_unwanted_member(input_buffer, &skipped))
+            {
+                goto fail;
+            }
+            if (skipped)
+            {
+                continue;
+            }
+        }
+
+        /* allocate next item */
+        new_item = cJSON_New_Item(&(input_buffer->hooks));
+        if (new_item == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+
+        if (cannot_access_at_index(input_buffer, 1))
+        {
+            goto fail; /* nothing comes after the comma */
+        }
+
+        /* parse the name of the child */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        interned_key = NULL;
+        if ((input_buffer->options != NULL) && (input_buffer->options->keys != NULL))
+        {
+            /* only attached after the value has been parsed, because parse_value resets cJSON_StringIsConst */
+            interned_key = parse_interned_key(input_buffer);
+            if (interned_key == NULL)
+            {
+                goto fail; /* failed to parse name */
+            }
+        }
+        else
+        {
+            if (!parse_string(current_item, input_buffer))
+            {
+                goto fail; /* failed to parse name */
+            }
+
+            /* swap valuestring and string, because we parsed the name */
+            current_item->string = current_item->valuestring;
+            current_item->valuestring = NULL;
+        }
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            goto fail; /* invalid object */
+        }
+
+        /* parse the value */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if ((input_buffer->depth == 1) && is_raw_member(input_buffer->options, (interned_key != NULL) ? interned_key : current_item->string))
+        {
+            if (!parse_raw_value(current_item, input_buffer))
+            {
+                goto fail; /* failed to parse value */
+            }
+        }
+        else if (!parse_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
+        }
+        if (interned_key != NULL)
+        {
+            current_item->string = interned_key;
+            current_item->type |= cJSON_StringIsConst;
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        goto fail; /* expected end of object */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (head != NULL) {
+        head->prev = current_item;
+    }
+
+    item->type = cJSON_Object;
+    item->child = head;
+
+    input_buffer->offset++;
+    return true;
+
+fail:
+    if (head != NULL)
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+/* Validate a string like parse_string does, without unescaping it into a new allocation. */
+static cJSON_bool skip_string(parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    unsigned char utf8[4];
+    unsigned char *utf8_pointer = NULL;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+    {
+        /* is escape sequence */
+        if (input_end[0] == '\\')
+        {
+            if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+            {
+                /* prevent buffer overflow when last input character is a backslash */
+                goto fail;
+            }
+            input_end++;
+        }
+        input_end++;
+    }
+    if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+    {
+        goto fail; /* string ended unexpectedly */
+    }
+
+    /* check the escape sequences */
+    while (input_pointer < input_end)
+    {
+        unsigned char sequence_length = 2;
+        if (*input_pointer != '\\')
+        {
+            input_pointer++;
+            continue;
+        }
+
+        switch (input_pointer[1])
+        {
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+            case '\"':
+            case '\\':
+            case '/':
+                break;
+
+            /* UTF-16 literal */
+            case 'u':
+                utf8_pointer = utf8;
+                sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &utf8_pointer);
+                if (sequence_length == 0)
+                {
+                    /* failed to convert UTF16-literal to UTF-8 */
+                    goto fail;
+                }
+                break;
+
+            default:
+                goto fail;
+        }
+        input_pointer += sequence_length;
+    }
+
+    input_buffer->offset = (size_t) (input_end - input_buffer->content);
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+
+    return false;
+}
+
+/* Validate an array like parse_array does, without building it. */
+static cJSON_bool skip_array(parse_buffer * const input_buffer)
+{
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!skip_value(input_buffer))
+        {
+            return false;
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        return false; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return true;
+}
+
+/* Validate a single "name": value pair of an object like parse_object does (starting at the '{' or ',' in front of it). */
+static cJSON_bool skip_member(parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 1))
+    {
+        return false; /* nothing comes after the comma */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (!skip_string(input_buffer))
+    {
+        return false; /* failed to parse name */
+    }
+    buffer_skip_whitespace(input_buffer);
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    {
+        return false; /* invalid object */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (!skip_value(input_buffer))
+    {
+        return false; /* failed to parse value */
+    }
+    buffer_skip_whitespace(input_buffer);
+
+    return true;
+}
+
+/* Validate an object like parse_object does, without building it. */
+static cJSON_bool skip_object(parse_buffer * const input_buffer)
+{
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
+    {
+        if (!skip_member(input_buffer))
+        {
+            return false;
+        }
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        return false; /* expected end of object */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return true;
+}
+
+/* Skip a number exactly as far as parse_number would read it (strtod stops at the same characters),
+ * without building it, so that skipped numbers don't allocate a temporary copy. */
+static cJSON_bool skip_number(parse_buffer * const input_buffer)
+{
+    size_t length = 0;
+    size_t digits = 0;
+    size_t exponent = 0;
+
+    if (can_access_at_index(input_buffer, length) && ((buffer_at_offset(input_buffer)[length] == '-') || (buffer_at_offset(input_buffer)[length] == '+')))
+    {
+        length++;
+    }
+    for (; can_access_at_index(input_buffer, length) && (buffer_at_offset(input_buffer)[length] >= '0') && (buffer_at_offset(input_buffer)[length] <= '9'); length++)
+    {
+        digits++;
+    }
+    if (can_access_at_index(input_buffer, length) && (buffer_at_offset(input_buffer)[length] == '.'))
+    {
+        for (length++; can_access_at_index(input_buffer, length) && (buffer_at_offset(input_buffer)[length] >= '0') && (buffer_at_offset(input_buffer)[length] <= '9'); length++)
+        {
+            digits++;
+        }
+    }
+    if (digits == 0)
+    {
+        return false; /* parse_error */
+    }
+
+    /* the exponent only counts if it has digits */
+    if (can_access_at_index(input_buffer, length) && ((buffer_at_offset(input_buffer)[length] == 'e') || (buffer_at_offset(input_buffer)[length] == 'E')))
+    {
+        exponent = length + 1;
+        if (can_access_at_index(input_buffer, exponent) && ((buffer_at_offset(input_buffer)[exponent] == '-') || (buffer_at_offset(input_buffer)[exponent] == '+')))
+        {
+            exponent++;
+        }
+        while (can_access_at_index(input_buffer, exponent) && (buffer_at_offset(input_buffer)[exponent] >= '0') && (buffer_at_offset(input_buffer)[exponent] <= '9'))
+        {
+            exponent++;
+            length = exponent;
+        }
+    }
+
+    input_buffer->offset += length;
+
+    return true;
+}
+
+/* Validate a value like parse_value does, without allocating anything for it. */
+static cJSON_bool skip_value(parse_buffer * const input_buffer)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return true;
+    }
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        input_buffer->offset += 5;
+        return true;
+    }
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return true;
+    }
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return skip_string(input_buffer);
+    }
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        return skip_number(input_buffer);
+    }
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return skip_array(input_buffer);
+    }
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return skip_object(input_buffer);
+    }
+
+    return false;
+}
+
+/* Validate the next value and store its text in a raw item instead of building it. */
+static cJSON_bool parse_raw_value(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const size_t start = input_buffer->offset;
+    size_t length = 0;
+
+    if (!skip_value(input_buffer))
+    {
+        return false;
+    }
+    length = input_buffer->offset - start;
+
+    item->valuestring = (char*)input_buffer->hooks.allocate(length + 1);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    memcpy(item->valuestring, input_buffer->content + start, length);
+    item->valuestring[length] = '\0';
+    item->type = cJSON_Raw;
+
+    return true;
+}
+
+/* Skip the next member of an object (starting at the '{' or ',' in front of it) if its name isn't
+ * in the list of requested members. Otherwise the buffer is left untouched and skipped is false. */
+static cJSON_bool skip_unwanted_member(parse_buffer * const input_buffer, cJSON_bool * const skipped)
+{
+    const parse_options * const options = input_buffer->options;
+    size_t start = input_buffer->offset;
+    const unsigned char *name = NULL;
+    size_t name_length = 0;
+    cJSON_bool has_escapes = false;
+    cJSON decoded_name[1];
+    size_t i = 0;
+
+    *skipped = false;
+
+    if (cannot_access_at_index(input_buffer, 1))
+    {
+        return false; /* nothing comes after the comma */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    name = buffer_at_offset(input_buffer) + 1;
+    if (!skip_string(input_buffer))
+    {
+        return false; /* failed to parse name */
+    }
+    name_length = (size_t)(buffer_at_offset(input_buffer) - name) - 1;
+    has_escapes = (memchr(name, '\\', name_length) != NULL);
+
+    memset(decoded_name, '\0', sizeof(decoded_name));
+    if (has_escapes)
+    {
+        /* compare the unescaped name, this is rare enough to not bother about the allocation */
+        input_buffer->offset = (size_t)(name - input_buffer->content) - 1;
+        if (!parse_string(decoded_name, input_buffer))
+        {
+            return false;
+        }
+        name = (const unsigned char*)decoded_name->valuestring;
+        name_length = strlen(decoded_name->valuestring);
+    }
+
+    for (i = 0; i < options->member_count; i++)
+    {
+        const char *member = options->members[i];
+        if ((member != NULL) && (strlen(member) == name_length) && (memcmp(member, name, name_length) == 0))
+        {
+            break;
+        }
+    }
+
+    if (decoded_name->valuestring != NULL)
+    {
+        input_buffer->hooks.deallocate(decoded_name->valuestring);
+        decoded_name->valuestring = NULL;
+    }
+
+    if (i < options->member_count)
+    {
+        /* this member is wanted, rewind so that parse_object can build it */
+        input_buffer->offset = start;
+        return true;
+    }
+
+    input_buffer->offset = start;
+    *skipped = true;
+
+    return skip_member(input_buffer);
+}
+
+/* Parse an object key into the key table of the parse options. Keys without escape sequences
+ * are looked up directly in the input, so keys that are already in the table don't allocate anything. */
+static char *parse_interned_key(parse_buffer * const input_buffer)
+{
+    const unsigned char *name = NULL;
+    size_t name_length = 0;
+    size_t start = input_buffer->offset;
+    cJSON decoded_name[1];
+    char *key = NULL;
+
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return NULL;
+    }
+
+    name = buffer_at_offset(input_buffer) + 1;
+    if (!skip_string(input_buffer))
+    {
+        return NULL;
+    }
+    name_length = (size_t)(buffer_at_offset(input_buffer) - name) - 1;
+
+    if (memchr(name, '\\', name_length) == NULL)
+    {
+        return intern_key(input_buffer->options->keys, name, name_length);
+    }
+
+    memset(decoded_name, '\0', sizeof(decoded_name));
+    input_buffer->offset = start;
+    if (!parse_string(decoded_name, input_buffer))
+    {
+        return NULL;
+    }
+    key = intern_key(input_buffer->options->keys, (const unsigned char*)decoded_name->valuestring, strlen(decoded_name->valuestring));
+    input_buffer->hooks.deallocate(decoded_name->valuestring);
+
+    return key;
+}
+
+/* Render an object to text. */
+static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+    size_t indent_width = 0;
+    unsigned char indent_char = '\t';
+    cJSON *current_item = item->child;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    indent_width = get_indent_width(output_buffer);
+    indent_char = get_indent_char(output_buffer);
+
+    /* Compose the output: */
+    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
+    output_pointer = ensure(output_buffer, length + 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer++ = '{';
+    output_buffer->depth++;
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\n';
+    }
+    output_buffer->offset += length;
+
+    while (current_item)
+    {
+        if (output_buffer->format)
+        {
+            /* 计算缩进：depth * indent_count */
+            size_t indent_size = output_buffer->depth * indent_width;
+            output_pointer = ensure(output_buffer, indent_size);
+            if (output_pointer == NULL)
+            {
+                return false;
+            }
+            memset(output_pointer, indent_char, indent_size);
+            output_buffer->offset += indent_size;
+        }
+
+        /* print key */
+        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
+        {
+            return false;
+        }
+        update_offset(output_buffer);
+
+        length = (size_t) (output_buffer->format ? 2 : 1);
+        output_pointer = ensure(output_buffer, length);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        *output_pointer++ = ':';
+        if (output_buffer->format)
+        {
+            /* cJSON_Print separates with a tab, cJSON_PrintPretty with a space */
+            *output_pointer++ = (output_buffer->indent_char == '\0') ? (unsigned char)'\t' : (unsigned char)' ';
+        }
+        output_buffer->offset += length;
+
+        /* print value */
+        if (!print_value(current_item, output_buffer))
+        {
+            return false;
+        }
+        update_offset(output_buffer);
+
+        /* print comma if not last */
+        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        if (current_item->next)
+        {
+            *output_pointer++ = ',';
+        }
+
+        if (output_buffer->format)
+        {
+            *output_pointer++ = '\n';
+        }
+        *output_pointer = '\0';
+        output_buffer->offset += length;
+
+        current_item = current_item->next;
+    }
+
+    length = output_buffer->format ? ((output_buffer->depth - 1) * indent_width) : 0;
+    output_pointer = ensure(output_buffer, length + 2);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    memset(output_pointer, indent_char, length);
+    output_pointer += length;
+    *output_pointer++ = '}';
+    *output_pointer = '\0';
+    output_buffer->depth--;
+
+    return true;
+}
+
+/* Get Array size/item / object item. */
+CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
+{
+    cJSON *child = NULL;
+    size_t size = 0;
+
+    if (array == NULL)
+    {
+        return 0;
+    }
+
+    if (array->type & cJSON_IsPacked)
+    {
+        return array->valueint;
+    }
+
+    child = array->child;
+
+    while(child != NULL)
+    {
+        size++;
+        child = child->next;
+    }
+
+    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
+
+    return (int)size;
+}
+
+static cJSON* get_array_item(const cJSON *array, size_t index)
+{
+    cJSON *current_child = NULL;
+
+    if (array == NULL)
+    {
+        return NULL;
+    }
+
+    current_child = array->child;
+    while ((current_child != NULL) && (index > 0))
+    {
+        index--;
+        current_child = current_child->next;
+    }
+
+    return current_child;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
+{
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    return get_array_item(array, (size_t)index);
+}
+
+static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
+{
+    cJSON *current_element = NULL;
+
+    if ((object == NULL) || (name == NULL))
+    {
+        return NULL;
+    }
+
+    current_element = object->child;
+    if (case_sensitive)
+    {
+        /* keys from a cJSON_KeyTable match by pointer */
+        while ((current_element != NULL) && (current_element->string != NULL) && (current_element->string != name) && (strcmp(name, current_element->string) != 0))
+        {
+            current_element = current_element->next;
+        }
+    }
+    else
+    {
+        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
+        {
+            current_element = current_element->next;
+        }
+    }
+
+    if ((current_element == NULL) || (current_element->string == NULL)) {
+        return NULL;
+    }
+
+    return current_element;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string)
+{
+    return get_object_item(object, string, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string)
+{
+    return get_object_item(object, string, true);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
+{
+    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+}
+
+/* Utility for array list handling. */
+static void suffix_object(cJSON *prev, cJSON *item)
+{
+    prev->next = item;
+    item->prev = prev;
+}
+
+/* Utility for handling references. */
+static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
+{
+    cJSON *reference = NULL;
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    reference = cJSON_New_Item(hooks);
+    if (reference == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(reference, item, sizeof(cJSON));
+    reference->string = NULL;
+    reference->type |= cJSON_IsReference;
+    reference->next = reference->prev = NULL;
+    return reference;
+}
+
+static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
+{
+    cJSON *child = NULL;
+
+    if ((item == NULL) || (array == NULL) || (array == item))
+    {
+        return false;
+    }
+
+    if ((array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array))
+    {
+        return false;
+    }
+
+    child = array->child;
+    /*
+     * To find the last item in array quickly, we use prev in array
+     */
+    if (child == NULL)
+    {
+        /* list is empty, start new one */
+        array->child = item;
+        item->prev = item;
+        item->next = NULL;
+    }
+    else
+    {
+        /* append to the end */
+        if (child->prev)
+        {
+            suffix_object(child->prev, item);
+            array->child->prev = item;
+        }
+    }
+
+    return true;
+}
+
+/* Add item to array/object. */
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
+{
+    return add_item_to_array(array, item);
+}
+
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void* cast_away_const(const void* string)
+{
+    return (void*)string;
+}
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic pop
+#endif
+
+
+static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
+{
+    char *new_key = NULL;
+    int new_type = cJSON_Invalid;
+
+    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item))
+    {
+        return false;
+    }
+
+    if (constant_key)
+    {
+        new_key = (char*)cast_away_const(string);
+        new_type = item->type | cJSON_StringIsConst;
+    }
+    else
+    {
+        new_key = (char*)cJSON_strdup((const unsigned char*)string, hooks);
+        if (new_key == NULL)
+        {
+            return false;
+        }
+
+        new_type = item->type & ~cJSON_StringIsConst;
+    }
+
+    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+    {
+        hooks->deallocate(item->string);
+    }
+
+    item->string = new_key;
+    item->type = new_type;
+
+    return add_item_to_array(object, item);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
+{
+    return add_item_to_object(object, string, item, &global_hooks, false);
+}
+
+/* Add an item to an object with constant string as key */
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item)
+{
+    return add_item_to_object(object, string, item, &global_hooks, true);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)
+{
+    if (array == NULL)
+    {
+        return false;
+    }
+
+    return add_item_to_array(array, create_reference(item, &global_hooks));
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item)
+{
+    if ((object == NULL) || (string == NULL))
+    {
+        return false;
+    }
+
+    return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
+{
+    cJSON *null = cJSON_CreateNull();
+    if (add_item_to_object(object, name, null, &global_hooks, false))
+    {
+        return null;
+    }
+
+    cJSON_Delete(null);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+{
+    cJSON *true_item = cJSON_CreateTrue();
+    if (add_item_to_object(object, name, true_item, &global_hooks, false))
+    {
+        return true_item;
+    }
+
+    cJSON_Delete(true_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON * const object, const char * const name)
+{
+    cJSON *false_item = cJSON_CreateFalse();
+    if (add_item_to_object(object, name, false_item, &global_hooks, false))
+    {
+        return false_item;
+    }
+
+    cJSON_Delete(false_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean)
+{
+    cJSON *bool_item = cJSON_CreateBool(boolean);
+    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
+    {
+        return bool_item;
+    }
+
+    cJSON_Delete(bool_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number)
+{
+    cJSON *number_item = cJSON_CreateNumber(number);
+    if (add_item_to_object(object, name, number_item, &global_hooks, false))
+    {
+        return number_item;
+    }
+
+    cJSON_Delete(number_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string)
+{
+    cJSON *string_item = cJSON_CreateString(string);
+    if (add_item_to_object(object, name, string_item, &global_hooks, false))
+    {
+        return string_item;
+    }
+
+    cJSON_Delete(string_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw)
+{
+    cJSON *raw_item = cJSON_CreateRaw(raw);
+    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
+    {
+        return raw_item;
+    }
+
+    cJSON_Delete(raw_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name)
+{
+    cJSON *object_item = cJSON_CreateObject();
+    if (add_item_to_object(object, name, object_item, &global_hooks, false))
+    {
+        return object_item;
+    }
+
+    cJSON_Delete(object_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name)
+{
+    cJSON *array = cJSON_CreateArray();
+    if (add_item_to_object(object, name, array, &global_hooks, false))
+    {
+        return array;
+    }
+
+    cJSON_Delete(array);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
+{
+    if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
+    {
+        return NULL;
+    }
+
+    if (item != parent->child)
+    {
+        /* not the first element */
+        item->prev->next = item->next;
+    }
+    if (item->next != NULL)
+    {
+        /* not the last element */
+        item->next->prev = item->prev;
+    }
+
+    if (item == parent->child)
+    {
+        /* first element */
+        parent->child = item->next;
+    }
+    else if (item->next == NULL)
+    {
+        /* last element */
+        parent->child->prev = item->prev;
+    }
+
+    /* make sure the detached item doesn't point anywhere anymore */
+    item->prev = NULL;
+    item->next = NULL;
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which)
+{
+    if ((which < 0) || ((array != NULL) && (array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array)))
+    {
+        return NULL;
+    }
+
+    return cJSON_DetachItemViaPointer(array, get_array_item(array, (size_t)which));
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromArray(cJSON *array, int which)
+{
+    cJSON_Delete(cJSON_DetachItemFromArray(array, which));
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObject(cJSON *object, const char *string)
+{
+    cJSON *to_detach = cJSON_GetObjectItem(object, string);
+
+    return cJSON_DetachItemViaPointer(object, to_detach);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObjectCaseSensitive(cJSON *object, const char *string)
+{
+    cJSON *to_detach = cJSON_GetObjectItemCaseSensitive(object, string);
+
+    return cJSON_DetachItemViaPointer(object, to_detach);
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromObject(cJSON *object, const char *string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObject(object, string));
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromObjectCaseSensitive(cJSON *object, const char *string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObjectCaseSensitive(object, string));
+}
+
+/* Replace array/object items with new ones. */
+CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
+{
+    cJSON *after_inserted = NULL;
+
+    if (which < 0 || newitem == NULL)
+    {
+        return false;
+    }
+
+    if ((array != NULL) && (array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array))
+    {
+        return false;
+    }
+
+    after_inserted = get_array_item(array, (size_t)which);
+    if (after_inserted == NULL)
+    {
+        return add_item_to_array(array, newitem);
+    }
+
+    if (after_inserted != array->child && after_inserted->prev == NULL) {
+        /* return false if after_inserted is a corrupted array item */
+        return false;
+    }
+
+    newitem->next = after_inserted;
+    newitem->prev = after_inserted->prev;
+    after_inserted->prev = newitem;
+    if (after_inserted == array->child)
+    {
+        array->child = newitem;
+    }
+    else
+    {
+        newitem->prev->next = newitem;
+    }
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
+{
+    if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
+    {
+        return false;
+    }
+
+    if (replacement == item)
+    {
+        return true;
+    }
+
+    replacement->next = item->next;
+    replacement->prev = item->prev;
+
+    if (replacement->next != NULL)
+    {
+        replacement->next->prev = replacement;
+    }
+    if (parent->child == item)
+    {
+        if (parent->child->prev == parent->child)
+        {
+            replacement->prev = replacement;
+        }
+        parent->child = replacement;
+    }
+    else
+    {   /*
+         * To find the last item in array quickly, we use prev in array.
+         * We can't modify the last item's next pointer where this item was the parent's child
+         */
+        if (replacement->prev != NULL)
+        {
+            replacement->prev->next = replacement;
+        }
+        if (replacement->next == NULL)
+        {
+            parent->child->prev = replacement;
+        }
+    }
+
+    item->next = NULL;
+    item->prev = NULL;
+    cJSON_Delete(item);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem)
+{
+    if ((which < 0) || ((array != NULL) && (array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array)))
+    {
+        return false;
+    }
+
+    return cJSON_ReplaceItemViaPointer(array, get_array_item(array, (size_t)which), newitem);
+}
+
+static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSON *replacement, cJSON_bool case_sensitive)
+{
+    if ((replacement == NULL) || (string == NULL))
+    {
+        return false;
+    }
+
+    /* replace the name in the replacement */
+    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    {
+        cJSON_free(replacement->string);
+    }
+    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+    if (replacement->string == NULL)
+    {
+        return false;
+    }
+
+    replacement->type &= ~cJSON_StringIsConst;
+
+    return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem)
+{
+    return replace_item_in_object(object, string, newitem, false);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object, const char *string, cJSON *newitem)
+{
+    return replace_item_in_object(object, string, newitem, true);
+}
+
+/* Create basic types: */
+CJSON_PUBLIC(cJSON *) cJSON_CreateNull(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_NULL;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_True;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_False;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = boolean ? cJSON_True : cJSON_False;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateInt64(cJSON_int64 number)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    /* the magnitude of the smallest number doesn't fit into a cJSON_int64 */
+    if (!set_integer(item, number < 0, (number < 0) ? ((cJSON_uint64)(-(number + 1)) + 1) : (cJSON_uint64)number, &global_hooks))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateUInt64(cJSON_uint64 number)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    if (!set_integer(item, false, number, &global_hooks))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_Number;
+        item->valuedouble = num;
+
+        /* use saturation in case of overflow */
+        if (num >= INT_MAX)
+        {
+            item->valueint = INT_MAX;
+        }
+        else if (num <= (double)INT_MIN)
+        {
+            item->valueint = INT_MIN;
+        }
+        else
+        {
+            item->valueint = (int)num;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_String;
+        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+        if(!item->valuestring)
+        {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateStringReference(const char *string)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL)
+    {
+        item->type = cJSON_String | cJSON_IsReference;
+        item->valuestring = (char*)cast_away_const(string);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateObjectReference(const cJSON *child)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL) {
+        item->type = cJSON_Object | cJSON_IsReference;
+        item->child = (cJSON*)cast_away_const(child);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateArrayReference(const cJSON *child) {
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL) {
+        item->type = cJSON_Array | cJSON_IsReference;
+        item->child = (cJSON*)cast_away_const(child);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_Raw;
+        item->valuestring = (char*)cJSON_strdup((const unsigned char*)raw, &global_hooks);
+        if(!item->valuestring)
+        {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateArray(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type=cJSON_Array;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateObject(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item)
+    {
+        item->type = cJSON_Object;
+    }
+
+    return item;
+}
+
+/* Create Arrays: */
+CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber(numbers[i]);
+        if (!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber((double)numbers[i]);
+        if(!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber(numbers[i]);
+        if(!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (strings == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for (i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateString(strings[i]);
+        if(!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p,n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PackArray(cJSON *array)
+{
+    const cJSON *element = NULL;
+    unsigned char *numbers = NULL;
+    size_t count = 0;
+
+    if (!cJSON_IsArray(array) || (array->type & cJSON_IsReference))
+    {
+        return false;
+    }
+    if (array->type & cJSON_IsPacked)
+    {
+        return true;
+    }
+
+    for (element = array->child; element != NULL; element = element->next)
+    {
+        cJSON_bool negative = false;
+        cJSON_uint64 magnitude = 0;
+
+        if (!cJSON_IsNumber(element) || (count >= ((size_t)INT_MAX / sizeof(double))))
+        {
+            return false;
+        }
+        if (get_exact_integer(element, &negative, &magnitude) && (magnitude > CJSON_MAX_SAFE_INTEGER))
+        {
+            return false; /* a double can't hold this integer exactly */
+        }
+        count++;
+    }
+
+    if (count > 0)
+    {
+        numbers = (unsigned char*)global_hooks.allocate(count * sizeof(double));
+        if (numbers == NULL)
+        {
+            return false;
+        }
+    }
+
+    count = 0;
+    for (element = array->child; element != NULL; element = element->next)
+    {
+        memcpy(numbers + (count * sizeof(double)), &element->valuedouble, sizeof(double));
+        count++;
+    }
+
+    cJSON_Delete(array->child);
+    array->child = NULL;
+    array->type |= cJSON_IsPacked;
+    array->valuestring = (char*)numbers;
+    array->valueint = (int)count;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_UnpackArray(cJSON *array)
+{
+    cJSON *head = NULL;
+    cJSON *current_item = NULL;
+    size_t i = 0;
+
+    if (!cJSON_IsArray(array))
+    {
+        return false;
+    }
+    if (!(array->type & cJSON_IsPacked))
+    {
+        return true;
+    }
+    if (array->type & cJSON_IsReference)
+    {
+        /* the numbers belong to the referenced array */
+        return false;
+    }
+
+    for (i = 0; i < (size_t)array->valueint; i++)
+    {
+        cJSON *new_item = cJSON_CreateNumber(get_packed_number(array, i));
+        if (new_item == NULL)
+        {
+            cJSON_Delete(head);
+            return false;
+        }
+
+        if (head == NULL)
+        {
+            current_item = head = new_item;
+        }
+        else
+        {
+            suffix_object(current_item, new_item);
+            current_item = new_item;
+        }
+    }
+    if (head != NULL)
+    {
+        head->prev = current_item;
+    }
+
+    if (array->valuestring != NULL)
+    {
+        global_hooks.deallocate(array->valuestring);
+    }
+    array->valuestring = NULL;
+    array->valueint = 0;
+    array->type &= ~cJSON_IsPacked;
+    array->child = head;
+
+    return true;
+}
+
+/* Extraction */
+CJSON_PUBLIC(int) cJSON_GetDoubleArray(const cJSON *array, double *numbers, int count)
+{
+    const cJSON *element = NULL;
+    int i = 0;
+
+    if (!cJSON_IsArray(array) || (count < 0) || ((numbers == NULL) && (count > 0)))
+    {
+        return -1;
+    }
+
+    if (array->type & cJSON_IsPacked)
+    {
+        i = (count < array->valueint) ? count : array->valueint;
+        if (i > 0)
+        {
+            memcpy(numbers, array->valuestring, (size_t)i * sizeof(double));
+        }
+        return i;
+    }
+
+    for (element = array->child; (element != NULL) && (i < count); element = element->next, i++)
+    {
+        if (!cJSON_IsNumber(element))
+        {
+            return -1;
+        }
+        numbers[i] = element->valuedouble;
+    }
+
+    return i;
+}
+
+CJSON_PUBLIC(int) cJSON_GetInt64Array(const cJSON *array, cJSON_int64 *numbers, int count)
+{
+    const cJSON *element = NULL;
+    int i = 0;
+
+    if (!cJSON_IsArray(array) || (count < 0) || ((numbers == NULL) && (count > 0)))
+    {
+        return -1;
+    }
+
+    if (array->type & cJSON_IsPacked)
+    {
+        for (i = 0; (i < count) && (i < array->valueint); i++)
+        {
+            numbers[i] = double_to_int64(get_packed_number(array, (size_t)i));
+        }
+        return i;
+    }
+
+    for (element = array->child; (element != NULL) && (i < count); element = element->next, i++)
+    {
+        if (!cJSON_IsNumber(element))
+        {
+            return -1;
+        }
+        numbers[i] = get_int64(element);
+    }
+
+    return i;
+}
+
+CJSON_PUBLIC(int) cJSON_GetStringArray(const cJSON *array, const char **strings, int count)
+{
+    const cJSON *element = NULL;
+    int i = 0;
+
+    if (!cJSON_IsArray(array) || (count < 0) || ((strings == NULL) && (count > 0)))
+    {
+        return -1;
+    }
+
+    if ((array->type & cJSON_IsPacked) && (array->valueint > 0) && (count > 0))
+    {
+        return -1; /* only numbers */
+    }
+
+    for (element = array->child; (element != NULL) && (i < count); element = element->next, i++)
+    {
+        if (!cJSON_IsString(element) || (element->valuestring == NULL))
+        {
+            return -1;
+        }
+        strings[i] = element->valuestring;
+    }
+
+    return i;
+}
+
+/* Duplication */
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
+
+CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+{
+    return cJSON_Duplicate_rec(item, 0, recurse );
+}
+
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+{
+    cJSON *newitem = NULL;
+    cJSON *child = NULL;
+    cJSON *next = NULL;
+    cJSON *newchild = NULL;
+
+    /* Bail on bad ptr */
+    if (!item)
+    {
+        goto fail;
+    }
+    /* Create new item */
+    newitem = cJSON_New_Item(&global_hooks);
+    if (!newitem)
+    {
+        goto fail;
+    }
+    /* Copy over all vars */
+    newitem->type = item->type & (~cJSON_IsReference);
+    newitem->valueint = item->valueint;
+    newitem->valuedouble = item->valuedouble;
+    if (item->string)
+    {
+        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
+        if (!newitem->string)
+        {
+            goto fail;
+        }
+    }
+    if (item->type & cJSON_IsPacked)
+    {
+        /* the numbers are the elements, so they are only copied with recurse */
+        if (!recurse || (item->valueint == 0))
+        {
+            newitem->type &= ~cJSON_IsPacked;
+            newitem->valueint = 0;
+            return newitem;
+        }
+        newitem->valuestring = (char*)global_hooks.allocate((size_t)item->valueint * sizeof(double));
+        if (!newitem->valuestring)
+        {
+            goto fail;
+        }
+        memcpy(newitem->valuestring, item->valuestring, (size_t)item->valueint * sizeof(double));
+        return newitem;
+    }
+    if (item->valuestring)
+    {
+        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
+        if (!newitem->valuestring)
+        {
+            goto fail;
+        }
+    }
+    /* If non-recursive, then we're done! */
+    if (!recurse)
+    {
+        return newitem;
+    }
+    /* Walk the ->next chain for the child. */
+    child = item->child;
+    while (child != NULL)
+    {
+        if(depth >= CJSON_CIRCULAR_LIMIT) {
+            goto fail;
+        }
+        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
+        if (!newchild)
+        {
+            goto fail;
+        }
+        if (next != NULL)
+        {
+            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
+            next->next = newchild;
+            newchild->prev = next;
+            next = newchild;
+        }
+        else
+        {
+            /* Set newitem->child and move to it */
+            newitem->child = newchild;
+            next = newchild;
+        }
+        child = child->next;
+    }
+    if (newitem && newitem->child)
+    {
+        newitem->child->prev = newchild;
+    }
+
+    return newitem;
+
+fail:
+    if (newitem != NULL)
+    {
+        cJSON_Delete(newitem);
+    }
+
+    return NULL;
+}
+
+static void skip_oneline_comment(char **input)
+{
+    *input += static_strlen("//");
+
+    for (; (*input)[0] != '\0'; ++(*input))
+    {
+        if ((*input)[0] == '\n') {
+            *input += static_strlen("\n");
+            return;
+        }
+    }
+}
+
+static void skip_multiline_comment(char **input)
+{
+    *input += static_strlen("/*");
+
+    for (; (*input)[0] != '\0'; ++(*input))
+    {
+        if (((*input)[0] == '*') && ((*input)[1] == '/'))
+        {
+            *input += static_strlen("*/");
+            return;
+        }
+    }
+}
+
+static void minify_string(char **input, char **output) {
+    (*output)[0] = (*input)[0];
+    *input += static_strlen("\"");
+    *output += static_strlen("\"");
+
+
+    for (; (*input)[0] != '\0'; (void)++(*input), ++(*output)) {
+        (*output)[0] = (*input)[0];
+
+        if ((*input)[0] == '\"') {
+            (*output)[0] = '\"';
+            *input += static_strlen("\"");
+            *output += static_strlen("\"");
+            return;
+        } else if (((*input)[0] == '\\') && ((*input)[1] == '\"')) {
+            (*output)[1] = (*input)[1];
+            *input += static_strlen("\"");
+            *output += static_strlen("\"");
+        }
+    }
+}
+
+CJSON_PUBLIC(void) cJSON_Minify(char *json)
+{
+    char *into = json;
+
+    if (json == NULL)
+    {
+        return;
+    }
+
+    while (json[0] != '\0')
+    {
+        switch (json[0])
+        {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                json++;
+                break;
+
+            case '/':
+                if (json[1] == '/')
+                {
+                    skip_oneline_comment(&json);
+                }
+                else if (json[1] == '*')
+                {
+                    skip_multiline_comment(&json);
+                } else {
+                    json++;
+                }
+                break;
+
+            case '\"':
+                minify_string(&json, (char**)&into);
+                break;
+
+            default:
+                into[0] = json[0];
+                json++;
+                into++;
+        }
+    }
+
+    /* and null-terminate. */
+    *into = '\0';
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Invalid;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsFalse(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_False;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsTrue(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xff) == cJSON_True;
+}
+
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsBool(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & (cJSON_True | cJSON_False)) != 0;
+}
+CJSON_PUBLIC(cJSON_bool) cJSON_IsNull(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_NULL;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsNumber(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Number;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsString(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_String;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Array;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Object;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Raw;
+}
+
+/* Compare a packed array with another array, which may be packed as well. */
+static cJSON_bool compare_packed_array(const cJSON * const packed, const cJSON * const other)
+{
+    const cJSON *element = other->child;
+    size_t i = 0;
+
+    if (other->type & cJSON_IsPacked)
+    {
+        if (packed->valueint != other->valueint)
+        {
+            return false;
+        }
+        for (i = 0; i < (size_t)packed->valueint; i++)
+        {
+            if (!compare_double(get_packed_number(packed, i), get_packed_number(other, i)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    for (i = 0; element != NULL; element = element->next, i++)
+    {
+        if ((i >= (size_t)packed->valueint) || !cJSON_IsNumber(element) || !compare_double(get_packed_number(packed, i), element->valuedouble))
+        {
+            return false;
+        }
+    }
+
+    return i == (size_t)packed->valueint;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+{
+    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    {
+        return false;
+    }
+
+    /* check if type is valid */
+    switch (a->type & 0xFF)
+    {
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_NULL:
+        case cJSON_Number:
+        case cJSON_String:
+        case cJSON_Raw:
+        case cJSON_Array:
+        case cJSON_Object:
+            break;
+
+        default:
+            return false;
+    }
+
+    /* identical objects are equal */
+    if (a == b)
+    {
+        return true;
+    }
+
+    switch (a->type & 0xFF)
+    {
+        /* in these cases and equal type is enough */
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_NULL:
+            return true;
+
+        case cJSON_Number:
+        {
+            cJSON_bool a_negative = false;
+            cJSON_bool b_negative = false;
+            cJSON_uint64 a_magnitude = 0;
+            cJSON_uint64 b_magnitude = 0;
+
+            const cJSON_bool a_exact = get_exact_integer(a, &a_negative, &a_magnitude);
+            const cJSON_bool b_exact = get_exact_integer(b, &b_negative, &b_magnitude);
+
+            if (a_exact && b_exact)
+            {
+                return (a_magnitude == b_magnitude) && ((a_negative == b_negative) || (a_magnitude == 0));
+            }
+            /* the double of the exact side is rounded, so compare the other double with the exact value */
+            if (a_exact)
+            {
+                return exact_integer_equals_double(a_negative, a_magnitude, b->valuedouble);
+            }
+            if (b_exact)
+            {
+                return exact_integer_equals_double(b_negative, b_magnitude, a->valuedouble);
+            }
+            if (compare_double(a->valuedouble, b->valuedouble))
+            {
+                return true;
+            }
+            return false;
+        }
+
+        case cJSON_String:
+        case cJSON_Raw:
+            if ((a->valuestring == NULL) || (b->valuestring == NULL))
+            {
+                return false;
+            }
+            if (strcmp(a->valuestring, b->valuestring) == 0)
+            {
+                return true;
+            }
+
+            return false;
+
+        case cJSON_Array:
+        {
+            cJSON *a_element = a->child;
+            cJSON *b_element = b->child;
+
+            if ((a->type | b->type) & cJSON_IsPacked)
+            {
+                return compare_packed_array((a->type & cJSON_IsPacked) ? a : b, (a->type & cJSON_IsPacked) ? b : a);
+            }
+
+            for (; (a_element != NULL) && (b_element != NULL);)
+            {
+                if (!cJSON_Compare(a_element, b_element, case_sensitive))
+                {
+                    return false;
+                }
+
+                a_element = a_element->next;
+                b_element = b_element->next;
+            }
+
+            /* one of the arrays is longer than the other */
+            if (a_element != b_element) {
+                return false;
+            }
+
+            return true;
+        }
+
+        case cJSON_Object:
+        {
+            cJSON *a_element = NULL;
+            cJSON *b_element = NULL;
+            cJSON_ArrayForEach(a_element, a)
+            {
+                /* TODO This has O(n^2) runtime, which is horrible! */
+                b_element = get_object_item(b, a_element->string, case_sensitive);
+                if (b_element == NULL)
+                {
+                    return false;
+                }
+
+                if (!cJSON_Compare(a_element, b_element, case_sensitive))
+                {
+                    return false;
+                }
+            }
+
+            /* doing this twice, once on a and b to prevent true comparison if a subset of b
+             * TODO: Do this the proper way, this is just a fix for now */
+            cJSON_ArrayForEach(b_element, b)
+            {
+                a_element = get_object_item(a, b_element->string, case_sensitive);
+                if (a_element == NULL)
+                {
+                    return false;
+                }
+
+                if (!cJSON_Compare(b_element, a_element, case_sensitive))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/* CBOR (RFC 8949) major types, stored in the upper three bits of the initial byte */
+#define CBOR_UNSIGNED_INTEGER 0x00
+#define CBOR_NEGATIVE_INTEGER 0x20
+#define CBOR_BYTE_STRING 0x40
+#define CBOR_TEXT_STRING 0x60
+#define CBOR_ARRAY 0x80
+#define CBOR_MAP 0xA0
+#define CBOR_TAG 0xC0
+#define CBOR_SIMPLE 0xE0
+/* complete initial bytes of major type 7 */
+#define CBOR_FALSE 0xF4
+#define CBOR_TRUE 0xF5
+#define CBOR_NULL 0xF6
+#define CBOR_UNDEFINED 0xF7
+#define CBOR_HALF_FLOAT 0xF9
+#define CBOR_FLOAT 0xFA
+#define CBOR_DOUBLE 0xFB
+#define CBOR_BREAK 0xFF
+/* additional information of strings, arrays and maps with indefinite length */
+#define CBOR_INDEFINITE_LENGTH 31
+/* tag for JSON text embedded in a byte string, used for cJSON_Raw */
+#define CBOR_TAG_EMBEDDED_JSON 262UL
+/* the largest integer up to which every integer can be stored in a double */
+#define CBOR_MAX_SAFE_INTEGER 9007199254740992.0
+
+static cJSON_bool is_little_endian(void)
+{
+    const unsigned int one = 1;
+    unsigned char first_byte = 0;
+
+    memcpy(&first_byte, &one, sizeof(first_byte));
+
+    return first_byte == 1;
+}
+
+/* copy a float or double from native into network byte order or back */
+static void swap_to_big_endian(unsigned char * const destination, const void * const source, const size_t size)
+{
+    const unsigned char *bytes = (const unsigned char*)source;
+    size_t i = 0;
+
+    if (!is_little_endian())
+    {
+        memcpy(destination, bytes, size);
+        return;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        destination[i] = bytes[size - 1 - i];
+    }
+}
+
+/* copy a double from native into little endian byte order or back */
+static void swap_to_little_endian(unsigned char * const destination, const void * const source, const size_t size)
+{
+    const unsigned char *bytes = (const unsigned char*)source;
+    size_t i = 0;
+
+    if (is_little_endian())
+    {
+        memcpy(destination, bytes, size);
+        return;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        destination[i] = bytes[size - 1 - i];
+    }
+}
+
+/* write an initial byte with its argument, high and low are the upper and lower 32 bits of it */
+static cJSON_bool print_cbor_head(printbuffer * const output_buffer, const unsigned char major_type, const unsigned long high, const unsigned long low)
+{
+    unsigned char *output_pointer = NULL;
+    unsigned char additional_information = 0;
+    size_t argument_size = 0;
+    size_t i = 0;
+
+    if (high != 0)
+    {
+        additional_information = 27;
+        argument_size = 8;
+    }
+    else if (low > 0xFFFFUL)
+    {
+        additional_information = 26;
+        argument_size = 4;
+    }
+    else if (low > 0xFFUL)
+    {
+        additional_information = 25;
+        argument_size = 2;
+    }
+    else if (low >= 24)
+    {
+        additional_information = 24;
+        argument_size = 1;
+    }
+    else
+    {
+        additional_information = (unsigned char)low;
+    }
+
+    output_pointer = ensure(output_buffer, argument_size + 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer++ = (unsigned char)(major_type | additional_information);
+    for (i = argument_size; i > 0; i--)
+    {
+        /* big endian, the upper 32 bits come first */
+        if (i > 4)
+        {
+            *output_pointer++ = (unsigned char)((high >> (8 * (i - 5))) & 0xFF);
+        }
+        else
+        {
+            *output_pointer++ = (unsigned char)((low >> (8 * (i - 1))) & 0xFF);
+        }
+    }
+    output_buffer->offset += argument_size + 1;
+
+    return true;
+}
+
+static cJSON_bool print_cbor_byte(printbuffer * const output_buffer, const unsigned char byte)
+{
+    unsigned char *output_pointer = ensure(output_buffer, 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer = byte;
+    output_buffer->offset++;
+
+    return true;
+}
+
+static cJSON_bool print_cbor_size(printbuffer * const output_buffer, const unsigned char major_type, const size_t size)
+{
+    /* shift twice, shifting a 32 bit size_t by 32 is undefined */
+    return print_cbor_head(output_buffer, major_type, (unsigned long)((size >> 16) >> 16), (unsigned long)(size & 0xFFFFFFFFUL));
+}
+
+static cJSON_bool print_cbor_string(printbuffer * const output_buffer, const unsigned char major_type, const char * const string)
+{
+    const char *content = (string == NULL) ? "" : string;
+    size_t length = strlen(content);
+    unsigned char *output_pointer = NULL;
+
+    if (!print_cbor_size(output_buffer, major_type, length))
+    {
+        return false;
+    }
+
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    memcpy(output_pointer, content, length);
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* Integers are written as integers, other numbers as float if that doesn't lose precision, otherwise as double. */
+static cJSON_bool print_cbor_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    double d = item->valuedouble;
+    unsigned char *output_pointer = NULL;
+    cJSON_bool negative = false;
+    cJSON_uint64 exact_magnitude = 0;
+
+    if (get_exact_integer(item, &negative, &exact_magnitude) && (exact_magnitude > CJSON_MAX_SAFE_INTEGER))
+    {
+        if (negative)
+        {
+            exact_magnitude--; /* -1 - argument */
+        }
+        return print_cbor_head(output_buffer, negative ? CBOR_NEGATIVE_INTEGER : CBOR_UNSIGNED_INTEGER, (unsigned long)(exact_magnitude >> 32), (unsigned long)(exact_magnitude & 0xFFFFFFFFUL));
+    }
+
+    if ((d == floor(d)) && (fabs(d) <= CBOR_MAX_SAFE_INTEGER))
+    {
+        unsigned char major_type = CBOR_UNSIGNED_INTEGER;
+        double magnitude = d;
+        unsigned long high = 0;
+
+        if (d < 0)
+        {
+            major_type = CBOR_NEGATIVE_INTEGER;
+            magnitude = -1.0 - d;
+        }
+        high = (unsigned long)floor(magnitude / 4294967296.0);
+
+        return print_cbor_head(output_buffer, major_type, high, (unsigned long)(magnitude - ((double)high * 4294967296.0)));
+    }
+
+    if ((fabs(d) <= (double)FLT_MAX) && ((double)(float)d == d))
+    {
+        float f = (float)d;
+
+        output_pointer = ensure(output_buffer, sizeof(f) + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        output_pointer[0] = CBOR_FLOAT;
+        swap_to_big_endian(output_pointer + 1, &f, sizeof(f));
+        output_buffer->offset += sizeof(f) + 1;
+
+        return true;
+    }
+
+    output_pointer = ensure(output_buffer, sizeof(d) + 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    output_pointer[0] = CBOR_DOUBLE;
+    swap_to_big_endian(output_pointer + 1, &d, sizeof(d));
+    output_buffer->offset += sizeof(d) + 1;
+
+    return true;
+}
+
+static cJSON_bool print_cbor_value(const cJSON * const item, printbuffer * const output_buffer)
+{
+    const cJSON *child = NULL;
+    size_t count = 0;
+    cJSON_bool success = true;
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+            return print_cbor_byte(output_buffer, CBOR_NULL);
+
+        case cJSON_False:
+            return print_cbor_byte(output_buffer, CBOR_FALSE);
+
+        case cJSON_True:
+            return print_cbor_byte(output_buffer, CBOR_TRUE);
+
+        case cJSON_Number:
+            return print_cbor_number(item, output_buffer);
+
+        case cJSON_String:
+            return print_cbor_string(output_buffer, CBOR_TEXT_STRING, item->valuestring);
+
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            return print_cbor_head(output_buffer, CBOR_TAG, 0, CBOR_TAG_EMBEDDED_JSON)
+                && print_cbor_string(output_buffer, CBOR_BYTE_STRING, item->valuestring);
+
+        case cJSON_Array:
+        case cJSON_Object:
+            if (output_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                return false; /* too deeply nested */
+            }
+
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                count++;
+            }
+            if (item->type & cJSON_IsPacked)
+            {
+                count = (size_t)item->valueint;
+            }
+            if (!print_cbor_size(output_buffer, (((item->type & 0xFF) == cJSON_Array) ? CBOR_ARRAY : CBOR_MAP), count))
+            {
+                return false;
+            }
+
+            output_buffer->depth++;
+            if (item->type & cJSON_IsPacked)
+            {
+                success = print_packed_numbers(item, output_buffer, false, print_cbor_number);
+            }
+            for (child = item->child; success && (child != NULL); child = child->next)
+            {
+                if ((item->type & 0xFF) == cJSON_Object)
+                {
+                    success = print_cbor_string(output_buffer, CBOR_TEXT_STRING, child->string);
+                }
+                success = success && print_cbor_value(child, output_buffer);
+            }
+            output_buffer->depth--;
+
+            return success;
+
+        default:
+            return false;
+    }
+}
+
+/* encode item with one of the binary formats into a buffer allocated with the global hooks */
+static unsigned char *print_binary(const cJSON * const item, size_t * const length, cJSON_bool (*print_function)(const cJSON * const item, printbuffer * const output_buffer))
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer buffer[1];
+    unsigned char *printed = NULL;
+
+    if ((item == NULL) || (length == NULL))
+    {
+        return NULL;
+    }
+
+    memset(buffer, 0, sizeof(buffer));
+    buffer->buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+    buffer->length = default_buffer_size;
+    buffer->hooks = global_hooks;
+    if (buffer->buffer == NULL)
+    {
+        return NULL;
+    }
+
+    if (!print_function(item, buffer))
+    {
+        if (buffer->buffer != NULL)
+        {
+            global_hooks.deallocate(buffer->buffer);
+        }
+        return NULL;
+    }
+
+    printed = buffer->buffer;
+    if (global_hooks.reallocate != NULL)
+    {
+        /* shrink to the encoded size, ensure always leaves room for one more byte */
+        printed = (unsigned char*)global_hooks.reallocate(buffer->buffer, buffer->offset + 1);
+        if (printed == NULL)
+        {
+            global_hooks.deallocate(buffer->buffer);
+            return NULL;
+        }
+    }
+    *length = buffer->offset;
+
+    return printed;
+}
+
+CJSON_PUBLIC(unsigned char *) cJSON_PrintCBOR(const cJSON *item, size_t *length)
+{
+    return print_binary(item, length, print_cbor_value);
+}
+
+/* read the argument of the initial byte, integers above 2^53 are rounded */
+static cJSON_bool parse_cbor_argument(parse_buffer * const input_buffer, const unsigned char initial_byte, cJSON_uint64 * const argument)
+{
+    unsigned char additional_information = (unsigned char)(initial_byte & 0x1F);
+    size_t argument_size = 0;
+    size_t i = 0;
+
+    if (additional_information < 24)
+    {
+        *argument = additional_information;
+        return true;
+    }
+    if (additional_information > 27)
+    {
+        return false; /* reserved or indefinite length */
+    }
+
+    argument_size = (size_t)1 << (additional_information - 24);
+    if (!can_read(input_buffer, argument_size))
+    {
+        return false;
+    }
+
+    *argument = 0;
+    for (i = 0; i < argument_size; i++)
+    {
+        *argument = (*argument << 8) | buffer_at_offset(input_buffer)[i];
+    }
+    input_buffer->offset += argument_size;
+
+    return true;
+}
+
+/* read the length of a string or the number of elements of an array or map,
+ * every byte or element takes at least one byte, so it can't be more than what is left of the input */
+static cJSON_bool parse_cbor_length(parse_buffer * const input_buffer, const unsigned char initial_byte, size_t * const length)
+{
+    cJSON_uint64 argument = 0;
+
+    if (!parse_cbor_argument(input_buffer, initial_byte, &argument) || (argument > (cJSON_uint64)(input_buffer->length - input_buffer->offset)))
+    {
+        return false;
+    }
+    *length = (size_t)argument;
+
+    return true;
+}
+
+/* Parse a byte or text string (of the given major type) into a newly allocated null terminated string.
+ * Strings of indefinite length are measured first and then copied in one go. */
+static unsigned char *parse_cbor_string(parse_buffer * const input_buffer, const unsigned char major_type)
+{
+    unsigned char *string = NULL;
+    size_t length = 0;
+    size_t chunk_length = 0;
+    size_t start = 0;
+    unsigned char initial_byte = 0;
+
+    if (cannot_access_at_index(input_buffer, 0) || ((buffer_at_offset(input_buffer)[0] & 0xE0) != major_type))
+    {
+        return NULL;
+    }
+    initial_byte = buffer_at_offset(input_buffer)[0];
+    input_buffer->offset++;
+
+    if ((initial_byte & 0x1F) != CBOR_INDEFINITE_LENGTH)
+    {
+        if (!parse_cbor_length(input_buffer, initial_byte, &length))
+        {
+            return NULL;
+        }
+
+        string = (unsigned char*)input_buffer->hooks.allocate(length + sizeof(""));
+        if (string == NULL)
+        {
+            return NULL;
+        }
+        memcpy(string, buffer_at_offset(input_buffer), length);
+        string[length] = '\0';
+        input_buffer->offset += length;
+
+        return string;
+    }
+
+    /* measure the chunks, which have to be definite length strings of the same major type */
+    start = input_buffer->offset;
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] != CBOR_BREAK))
+    {
+        initial_byte = buffer_at_offset(input_buffer)[0];
+        input_buffer->offset++;
+        if (((initial_byte & 0xE0) != major_type) || ((initial_byte & 0x1F) == CBOR_INDEFINITE_LENGTH)
+            || !parse_cbor_length(input_buffer, initial_byte, &chunk_length))
+        {
+            return NULL;
+        }
+        input_buffer->offset += chunk_length;
+        length += chunk_length;
+    }
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return NULL; /* missing break */
+    }
+
+    string = (unsigned char*)input_buffer->hooks.allocate(length + sizeof(""));
+    if (string == NULL)
+    {
+        return NULL;
+    }
+
+    /* copy the chunks */
+    input_buffer->offset = start;
+    length = 0;
+    while (buffer_at_offset(input_buffer)[0] != CBOR_BREAK)
+    {
+        initial_byte = buffer_at_offset(input_buffer)[0];
+        input_buffer->offset++;
+        parse_cbor_length(input_buffer, initial_byte, &chunk_length);
+        memcpy(string + length, buffer_at_offset(input_buffer), chunk_length);
+        input_buffer->offset += chunk_length;
+        length += chunk_length;
+    }
+    string[length] = '\0';
+    input_buffer->offset++;
+
+    return string;
+}
+
+/* parse a half, single or double precision float of size bytes in network byte order */
+static cJSON_bool parse_binary_float(cJSON * const item, parse_buffer * const input_buffer, const size_t size)
+{
+    double number = 0;
+
+    if (!can_read(input_buffer, size))
+    {
+        return false;
+    }
+
+    if (size == 2)
+    {
+        unsigned int half = ((unsigned int)buffer_at_offset(input_buffer)[0] << 8) | buffer_at_offset(input_buffer)[1];
+        int exponent = (int)((half >> 10) & 0x1F);
+        double mantissa = (double)(half & 0x3FF);
+
+        if (exponent == 0)
+        {
+            number = ldexp(mantissa, -24);
+        }
+        else if (exponent != 31)
+        {
+            number = ldexp(mantissa + 1024.0, exponent - 25);
+        }
+        else
+        {
+            number = (mantissa == 0) ? HUGE_VAL : NAN;
+        }
+        if ((half & 0x8000) != 0)
+        {
+            number = -number;
+        }
+    }
+    else if (size == sizeof(float))
+    {
+        float f = 0;
+        swap_to_big_endian((unsigned char*)&f, buffer_at_offset(input_buffer), sizeof(f));
+        number = (double)f;
+    }
+    else
+    {
+        swap_to_big_endian((unsigned char*)&number, buffer_at_offset(input_buffer), sizeof(number));
+    }
+    input_buffer->offset += size;
+
+    item->type = cJSON_Number;
+    cJSON_SetNumberHelper(item, number);
+
+    return true;
+}
+
+static cJSON_bool parse_cbor_value(cJSON * const item, parse_buffer * const input_buffer);
+
+/* parse an array or map of definite or indefinite length */
+static cJSON_bool parse_cbor_container(cJSON * const item, parse_buffer * const input_buffer)
+{
+    cJSON *head = NULL; /* head of the linked list */
+    cJSON *current_item = NULL;
+    unsigned char initial_byte = buffer_at_offset(input_buffer)[0];
+    cJSON_bool indefinite = (initial_byte & 0x1F) == CBOR_INDEFINITE_LENGTH;
+    size_t remaining = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    if (!indefinite && !parse_cbor_length(input_buffer, initial_byte, &remaining))
+    {
+        goto fail;
+    }
+
+    for (;;)
+    {
+        cJSON *new_item = NULL;
+
+        if (indefinite)
+        {
+            if (cannot_access_at_index(input_buffer, 0))
+            {
+                goto fail; /* missing break */
+            }
+            if (buffer_at_offset(input_buffer)[0] == CBOR_BREAK)
+            {
+                input_buffer->offset++;
+                break;
+            }
+        }
+        else if (remaining-- == 0)
+        {
+            break;
+        }
+
+        /* allocate next item */
+        new_item = cJSON_New_Item(&(input_buffer->hooks));
+        if (new_item == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+
+        if ((initial_byte & 0xE0) == CBOR_MAP)
+        {
+            /* only text strings can be keys */
+            current_item->string = (char*)parse_cbor_string(input_buffer, CBOR_TEXT_STRING);
+            if (current_item->string == NULL)
+            {
+                goto fail;
+            }
+        }
+
+        if (!parse_cbor_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
+        }
+    }
+
+    input_buffer->depth--;
+
+    if (head != NULL) {
+        head->prev = current_item;
+    }
+
+    item->type = ((initial_byte & 0xE0) == CBOR_MAP) ? cJSON_Object : cJSON_Array;
+    item->child = head;
+
+    return true;
+
+fail:
+    if (head != NULL)
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+static cJSON_bool parse_cbor_value(cJSON * const item, parse_buffer * const input_buffer)
+{
+    unsigned char initial_byte = 0;
+    cJSON_uint64 argument = 0;
+    cJSON_bool success = false;
+
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+    initial_byte = buffer_at_offset(input_buffer)[0];
+
+    switch (initial_byte & 0xE0)
+    {
+        case CBOR_UNSIGNED_INTEGER:
+        case CBOR_NEGATIVE_INTEGER:
+            input_buffer->offset++;
+            if (!parse_cbor_argument(input_buffer, initial_byte, &argument))
+            {
+                return false;
+            }
+            if ((initial_byte & 0xE0) == CBOR_UNSIGNED_INTEGER)
+            {
+                return set_integer(item, false, argument, &(input_buffer->hooks));
+            }
+            if (argument == CJSON_UINT64_MAX)
+            {
+                /* -2^64 */
+                item->type = cJSON_Number;
+                cJSON_SetNumberHelper(item, -18446744073709551616.0);
+                return true;
+            }
+            return set_integer(item, true, argument + 1, &(input_buffer->hooks));
+
+        case CBOR_TEXT_STRING:
+            item->valuestring = (char*)parse_cbor_string(input_buffer, CBOR_TEXT_STRING);
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            item->type = cJSON_String;
+            return true;
+
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+            return parse_cbor_container(item, input_buffer);
+
+        case CBOR_TAG:
+            input_buffer->offset++;
+            if (!parse_cbor_argument(input_buffer, initial_byte, &argument))
+            {
+                return false;
+            }
+            if (argument == CBOR_TAG_EMBEDDED_JSON)
+            {
+                /* embedded JSON becomes a raw item, it isn't checked */
+                if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] & 0xE0) == CBOR_TEXT_STRING))
+                {
+                    item->valuestring = (char*)parse_cbor_string(input_buffer, CBOR_TEXT_STRING);
+                }
+                else
+                {
+                    item->valuestring = (char*)parse_cbor_string(input_buffer, CBOR_BYTE_STRING);
+                }
+                if (item->valuestring == NULL)
+                {
+                    return false;
+                }
+                item->type = cJSON_Raw;
+                return true;
+            }
+
+            /* other tags don't have a JSON representation, use the tagged value */
+            if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                return false;
+            }
+            input_buffer->depth++;
+            success = parse_cbor_value(item, input_buffer);
+            input_buffer->depth--;
+            return success;
+
+        case CBOR_SIMPLE:
+            input_buffer->offset++;
+            switch (initial_byte)
+            {
+                case CBOR_FALSE:
+                    item->type = cJSON_False;
+                    return true;
+
+                case CBOR_TRUE:
+                    item->type = cJSON_True;
+                    item->valueint = 1;
+                    return true;
+
+                case CBOR_NULL:
+                case CBOR_UNDEFINED:
+                    item->type = cJSON_NULL;
+                    return true;
+
+                case CBOR_HALF_FLOAT:
+                    return parse_binary_float(item, input_buffer, 2);
+
+                case CBOR_FLOAT:
+                    return parse_binary_float(item, input_buffer, sizeof(float));
+
+                case CBOR_DOUBLE:
+                    return parse_binary_float(item, input_buffer, sizeof(double));
+
+                default:
+                    return false;
+            }
+
+        default:
+            /* byte strings have no JSON representation */
+            return false;
+    }
+}
 
-    item->type = cJSON_Object;
-    item->child = head;
+/* decode one item of one of the binary formats */
+static cJSON *parse_binary(const unsigned char * const value, const size_t buffer_length, const unsigned char ** const return_parse_end, cJSON_bool (*parse_function)(cJSON * const item, parse_buffer * const input_buffer))
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+    cJSON *item = NULL;
 
-    input_buffer->offset++;
-    return true;
+    if ((value == NULL) || (buffer_length == 0))
+    {
+        return NULL;
+    }
 
-fail:
-    if (head != NULL)
+    buffer.content = value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
+
+    item = cJSON_New_Item(&global_hooks);
+    if (item == NULL)
     {
-        cJSON_Delete(head);
+        return NULL;
     }
 
-    return false;
+    if (!parse_function(item, &buffer) || ((return_parse_end == NULL) && (buffer.offset != buffer.length)))
+    {
+        cJSON_Delete(item);
+        item = NULL;
+    }
+
+    if (return_parse_end != NULL)
+    {
+        *return_parse_end = value + ((buffer.offset < buffer.length) ? buffer.offset : buffer.length);
+    }
+
+    return item;
 }
 
-/* Render an object to text. */
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+CJSON_PUBLIC(cJSON *) cJSON_ParseCBOR(const unsigned char *value, size_t buffer_length, const unsigned char **return_parse_end)
+{
+    return parse_binary(value, buffer_length, return_parse_end, parse_cbor_value);
+}
+
+/* MessagePack type bytes, the fix types carry their value or size in the low bits */
+#define MSGPACK_POSITIVE_FIXINT_MAX 0x7F
+#define MSGPACK_FIXMAP 0x80
+#define MSGPACK_FIXARRAY 0x90
+#define MSGPACK_FIXSTR 0xA0
+#define MSGPACK_NIL 0xC0
+#define MSGPACK_FALSE 0xC2
+#define MSGPACK_TRUE 0xC3
+#define MSGPACK_BIN8 0xC4
+#define MSGPACK_BIN16 0xC5
+#define MSGPACK_BIN32 0xC6
+#define MSGPACK_EXT8 0xC7
+#define MSGPACK_EXT16 0xC8
+#define MSGPACK_EXT32 0xC9
+#define MSGPACK_FLOAT32 0xCA
+#define MSGPACK_FLOAT64 0xCB
+#define MSGPACK_UINT8 0xCC
+#define MSGPACK_UINT16 0xCD
+#define MSGPACK_UINT32 0xCE
+#define MSGPACK_UINT64 0xCF
+#define MSGPACK_INT8 0xD0
+#define MSGPACK_INT16 0xD1
+#define MSGPACK_INT32 0xD2
+#define MSGPACK_INT64 0xD3
+#define MSGPACK_FIXEXT1 0xD4
+#define MSGPACK_FIXEXT16 0xD8
+#define MSGPACK_STR8 0xD9
+#define MSGPACK_STR16 0xDA
+#define MSGPACK_STR32 0xDB
+#define MSGPACK_ARRAY16 0xDC
+#define MSGPACK_ARRAY32 0xDD
+#define MSGPACK_MAP16 0xDE
+#define MSGPACK_MAP32 0xDF
+#define MSGPACK_NEGATIVE_FIXINT 0xE0
+
+/* write a type byte followed by value_size bytes of value */
+static cJSON_bool print_msgpack_head(printbuffer * const output_buffer, const unsigned char type, const unsigned long value, const size_t value_size)
+{
+    unsigned char *output_pointer = ensure(output_buffer, value_size + 1);
+    size_t i = 0;
+
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer++ = type;
+    for (i = value_size; i > 0; i--)
+    {
+        *output_pointer++ = (unsigned char)((value >> (8 * (i - 1))) & 0xFF);
+    }
+    output_buffer->offset += value_size + 1;
+
+    return true;
+}
+
+/* write a type byte followed by a 64 bit value, high and low are its upper and lower 32 bits */
+static cJSON_bool print_msgpack_int64(printbuffer * const output_buffer, const unsigned char type, const unsigned long high, const unsigned long low)
 {
     unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    cJSON *current_item = item->child;
 
-    if (output_buffer == NULL)
+    if (!print_msgpack_head(output_buffer, type, high, 4))
     {
         return false;
     }
 
-    /* 输出左大括号 */
-    length = (size_t) (output_buffer->format ? 2 : 1);
-    output_pointer = ensure(output_buffer, length + 1);
+    output_pointer = ensure(output_buffer, 4);
     if (output_pointer == NULL)
     {
         return false;
     }
+    output_pointer[0] = (unsigned char)((low >> 24) & 0xFF);
+    output_pointer[1] = (unsigned char)((low >> 16) & 0xFF);
+    output_pointer[2] = (unsigned char)((low >> 8) & 0xFF);
+    output_pointer[3] = (unsigned char)(low & 0xFF);
+    output_buffer->offset += 4;
 
-    *output_pointer++ = '{';
-    output_buffer->depth++;
-    if (output_buffer->format)
+    return true;
+}
+
+/* write the size of a string, array or map with the smallest of its formats, type8 is 0 for arrays and maps */
+static cJSON_bool print_msgpack_size(printbuffer * const output_buffer, const unsigned char fix_type, const size_t fix_limit, const unsigned char type8, const unsigned char type16, const size_t size)
+{
+    if (((size >> 16) >> 16) != 0)
     {
-        *output_pointer++ = '\n';
+        return false; /* MessagePack sizes are at most 32 bit */
+    }
+
+    if ((fix_type != 0) && (size < fix_limit))
+    {
+        return print_msgpack_head(output_buffer, (unsigned char)(fix_type | size), 0, 0);
+    }
+    if ((type8 != 0) && (size <= 0xFF))
+    {
+        return print_msgpack_head(output_buffer, type8, (unsigned long)size, 1);
+    }
+    if (size <= 0xFFFF)
+    {
+        return print_msgpack_head(output_buffer, type16, (unsigned long)size, 2);
+    }
+
+    /* the 32 bit format always follows the 16 bit one */
+    return print_msgpack_head(output_buffer, (unsigned char)(type16 + 1), (unsigned long)size, 4);
+}
+
+static cJSON_bool print_msgpack_bytes(printbuffer * const output_buffer, const char * const bytes, const size_t length)
+{
+    unsigned char *output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
     }
+
+    memcpy(output_pointer, bytes, length);
     output_buffer->offset += length;
 
-    while (current_item)
+    return true;
+}
+
+/* Integers are written in the smallest integer format, other numbers as float32 if that doesn't lose precision, otherwise as float64. */
+static cJSON_bool print_msgpack_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    double d = item->valuedouble;
+    unsigned char *output_pointer = NULL;
+    cJSON_bool negative = false;
+    cJSON_uint64 exact_magnitude = 0;
+
+    if (get_exact_integer(item, &negative, &exact_magnitude) && (exact_magnitude > CJSON_MAX_SAFE_INTEGER))
     {
-        if (output_buffer->format)
+        /* exact integers that a double can't hold are always outside of the smaller formats */
+        if (negative)
         {
-            size_t i;
-            /* 计算缩进：depth * indent_count */
-            size_t indent_size = output_buffer->depth * output_buffer->indent_count;
-            output_pointer = ensure(output_buffer, indent_size);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            for (i = 0; i < indent_size; i++)
-            {
-                *output_pointer++ = output_buffer->indent_char;
-            }
-            output_buffer->offset += indent_size;
+            exact_magnitude = (~exact_magnitude) + 1; /* two's complement */
         }
+        return print_msgpack_int64(output_buffer, negative ? MSGPACK_INT64 : MSGPACK_UINT64, (unsigned long)(exact_magnitude >> 32), (unsigned long)(exact_magnitude & 0xFFFFFFFFUL));
+    }
 
-        /* 打印键名 */
-        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+    if ((d == floor(d)) && (fabs(d) <= CBOR_MAX_SAFE_INTEGER))
+    {
+        double magnitude = fabs(d);
+        unsigned long high = (unsigned long)floor(magnitude / 4294967296.0);
+        unsigned long low = (unsigned long)(magnitude - ((double)high * 4294967296.0));
 
-        length = (size_t) (output_buffer->format ? 2 : 1);
-        output_pointer = ensure(output_buffer, length);
-        if (output_pointer == NULL)
+        if (d >= 0)
         {
-            return false;
-        }
-        *output_pointer++ = ':';
-        if (output_buffer->format)
-        {
-            *output_pointer++ = ' ';
+            if (high != 0)
+            {
+                return print_msgpack_int64(output_buffer, MSGPACK_UINT64, high, low);
+            }
+            if (low <= MSGPACK_POSITIVE_FIXINT_MAX)
+            {
+                return print_msgpack_head(output_buffer, (unsigned char)low, 0, 0);
+            }
+            if (low <= 0xFF)
+            {
+                return print_msgpack_head(output_buffer, MSGPACK_UINT8, low, 1);
+            }
+            if (low <= 0xFFFF)
+            {
+                return print_msgpack_head(output_buffer, MSGPACK_UINT16, low, 2);
+            }
+            return print_msgpack_head(output_buffer, MSGPACK_UINT32, low, 4);
         }
-        output_buffer->offset += length;
 
-        /* 打印值 */
-        if (!print_value(current_item, output_buffer))
+        if (d >= -32.0)
         {
-            return false;
+            return print_msgpack_head(output_buffer, (unsigned char)(0x100UL - low), 0, 0);
         }
-        update_offset(output_buffer);
-
-        /* 打印逗号（如果不是最后一个） */
-        length = (size_t)(current_item->next ? 1 : 0);
-        output_pointer = ensure(output_buffer, length + 1);
-        if (output_pointer == NULL)
+        if (d >= -128.0)
         {
-            return false;
+            return print_msgpack_head(output_buffer, MSGPACK_INT8, (0x100UL - low) & 0xFF, 1);
         }
-        if (current_item->next)
+        if (d >= -32768.0)
         {
-            *output_pointer++ = ',';
+            return print_msgpack_head(output_buffer, MSGPACK_INT16, (0x10000UL - low) & 0xFFFF, 2);
         }
-
-        if (output_buffer->format)
+        if (d >= -2147483648.0)
         {
-            *output_pointer++ = '\n';
+            return print_msgpack_head(output_buffer, MSGPACK_INT32, ((~low) + 1) & 0xFFFFFFFFUL, 4);
         }
-        *output_pointer = '\0';
-        output_buffer->offset += length + (output_buffer->format ? 1 : 0);
 
-        current_item = current_item->next;
+        /* two's complement of the 64 bit magnitude */
+        low = ((~low) + 1) & 0xFFFFFFFFUL;
+        high = ((~high) + ((low == 0) ? 1 : 0)) & 0xFFFFFFFFUL;
+        return print_msgpack_int64(output_buffer, MSGPACK_INT64, high, low);
     }
 
-    /* 输出右大括号前的缩进 */
-    if (output_buffer->format && (output_buffer->depth > 1))
+    if ((fabs(d) <= (double)FLT_MAX) && ((double)(float)d == d))
     {
-        size_t i;
-        size_t indent_size = (output_buffer->depth - 1) * output_buffer->indent_count;
-        output_pointer = ensure(output_buffer, indent_size);
+        float f = (float)d;
+
+        output_pointer = ensure(output_buffer, sizeof(f) + 1);
         if (output_pointer == NULL)
         {
             return false;
         }
-        for (i = 0; i < indent_size; i++)
-        {
-            *output_pointer++ = output_buffer->indent_char;
-        }
-        output_buffer->offset += indent_size;
+        output_pointer[0] = MSGPACK_FLOAT32;
+        swap_to_big_endian(output_pointer + 1, &f, sizeof(f));
+        output_buffer->offset += sizeof(f) + 1;
+
+        return true;
     }
 
-    output_pointer = ensure(output_buffer, 2);
+    output_pointer = ensure(output_buffer, sizeof(d) + 1);
     if (output_pointer == NULL)
     {
         return false;
     }
-    *output_pointer++ = '}';
-    *output_pointer = '\0';
-    output_buffer->depth--;
+    output_pointer[0] = MSGPACK_FLOAT64;
+    swap_to_big_endian(output_pointer + 1, &d, sizeof(d));
+    output_buffer->offset += sizeof(d) + 1;
 
     return true;
 }
 
-/* Get Array size/item / object item. */
-CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
+static cJSON_bool print_msgpack_string(printbuffer * const output_buffer, const char * const string)
 {
-    cJSON *child = NULL;
-    size_t size = 0;
-
-    if (array == NULL)
-    {
-        return 0;
-    }
-
-    child = array->child;
-
-    while(child != NULL)
-    {
-        size++;
-        child = child->next;
-    }
-
-    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
+    const char *content = (string == NULL) ? "" : string;
+    size_t length = strlen(content);
 
-    return (int)size;
+    return print_msgpack_size(output_buffer, MSGPACK_FIXSTR, 32, MSGPACK_STR8, MSGPACK_STR16, length)
+        && print_msgpack_bytes(output_buffer, content, length);
 }
 
-static cJSON* get_array_item(const cJSON *array, size_t index)
+static cJSON_bool print_msgpack_value(const cJSON * const item, printbuffer * const output_buffer)
 {
-    cJSON *current_child = NULL;
+    const cJSON *child = NULL;
+    size_t count = 0;
+    cJSON_bool success = true;
 
-    if (array == NULL)
+    switch ((item->type) & 0xFF)
     {
-        return NULL;
-    }
+        case cJSON_NULL:
+            return print_msgpack_head(output_buffer, MSGPACK_NIL, 0, 0);
 
-    current_child = array->child;
-    while ((current_child != NULL) && (index > 0))
-    {
-        index--;
-        current_child = current_child->next;
-    }
+        case cJSON_False:
+            return print_msgpack_head(output_buffer, MSGPACK_FALSE, 0, 0);
 
-    return current_child;
-}
+        case cJSON_True:
+            return print_msgpack_head(output_buffer, MSGPACK_TRUE, 0, 0);
 
-CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
-{
-    if (index < 0)
-    {
-        return NULL;
-    }
+        case cJSON_Number:
+            return print_msgpack_number(item, output_buffer);
 
-    return get_array_item(array, (size_t)index);
-}
+        case cJSON_String:
+            return print_msgpack_string(output_buffer, item->valuestring);
 
-static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
-{
-    cJSON *current_element = NULL;
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            count = strlen(item->valuestring);
+            return print_msgpack_size(output_buffer, 0, 0, MSGPACK_EXT8, MSGPACK_EXT16, count)
+                && print_msgpack_head(output_buffer, (unsigned char)CJSON_MSGPACK_RAW_EXTENSION, 0, 0)
+                && print_msgpack_bytes(output_buffer, item->valuestring, count);
 
-    if ((object == NULL) || (name == NULL))
-    {
-        return NULL;
-    }
+        case cJSON_Array:
+        case cJSON_Object:
+            if (output_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                return false; /* too deeply nested */
+            }
 
-    current_element = object->child;
-    if (case_sensitive)
-    {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
-        {
-            current_element = current_element->next;
-        }
-    }
-    else
-    {
-        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
-        {
-            current_element = current_element->next;
-        }
-    }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                count++;
+            }
+            if (item->type & cJSON_IsPacked)
+            {
+                count = (size_t)item->valueint;
+            }
+            if ((item->type & 0xFF) == cJSON_Array)
+            {
+                success = print_msgpack_size(output_buffer, MSGPACK_FIXARRAY, 16, 0, MSGPACK_ARRAY16, count);
+            }
+            else
+            {
+                success = print_msgpack_size(output_buffer, MSGPACK_FIXMAP, 16, 0, MSGPACK_MAP16, count);
+            }
 
-    if ((current_element == NULL) || (current_element->string == NULL)) {
-        return NULL;
-    }
+            output_buffer->depth++;
+            if (success && (item->type & cJSON_IsPacked))
+            {
+                success = print_packed_numbers(item, output_buffer, false, print_msgpack_number);
+            }
+            for (child = item->child; success && (child != NULL); child = child->next)
+            {
+                if ((item->type & 0xFF) == cJSON_Object)
+                {
+                    success = print_msgpack_string(output_buffer, child->string);
+                }
+                success = success && print_msgpack_value(child, output_buffer);
+            }
+            output_buffer->depth--;
 
-    return current_element;
-}
+            return success;
 
-CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string)
-{
-    return get_object_item(object, string, false);
+        default:
+            return false;
+    }
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string)
+CJSON_PUBLIC(unsigned char *) cJSON_PrintMessagePack(const cJSON *item, size_t *length)
 {
-    return get_object_item(object, string, true);
+    return print_binary(item, length, print_msgpack_value);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintMessagePackToWriter(const cJSON *item, cJSON_WriteCallback write_fn, void *user_data)
 {
-    return cJSON_GetObjectItem(object, string) ? 1 : 0;
-}
+    static const size_t chunk_size = 4096;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, NULL };
+    print_sink sink;
+    cJSON_bool success = false;
+
+    if ((item == NULL) || (write_fn == NULL))
+    {
+        return false;
+    }
+
+    sink.write = write_fn;
+    sink.user_data = user_data;
+
+    p.buffer = (unsigned char*)global_hooks.allocate(chunk_size);
+    if (p.buffer == NULL)
+    {
+        return false;
+    }
 
-/* Utility for array list handling. */
-static void suffix_object(cJSON *prev, cJSON *item)
-{
-    prev->next = item;
-    item->prev = prev;
-}
+    p.length = chunk_size;
+    p.hooks = global_hooks;
+    p.sink = &sink;
 
-/* Utility for handling references. */
-static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
-{
-    cJSON *reference = NULL;
-    if (item == NULL)
+    if (print_msgpack_value(item, &p))
     {
-        return NULL;
+        /* flush the rest */
+        success = (p.offset == 0) || write_fn((const char*)p.buffer, p.offset, user_data);
     }
 
-    reference = cJSON_New_Item(hooks);
-    if (reference == NULL)
+    if (p.buffer != NULL)
     {
-        return NULL;
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
     }
 
-    memcpy(reference, item, sizeof(cJSON));
-    reference->string = NULL;
-    reference->type |= cJSON_IsReference;
-    reference->next = reference->prev = NULL;
-    return reference;
+    return success;
 }
 
-static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
+/* read a big endian unsigned integer of size bytes (at most 4) */
+static cJSON_bool parse_msgpack_unsigned(parse_buffer * const input_buffer, const size_t size, unsigned long * const value)
 {
-    cJSON *child = NULL;
+    size_t i = 0;
 
-    if ((item == NULL) || (array == NULL) || (array == item))
+    if (!can_read(input_buffer, size))
     {
         return false;
     }
 
-    child = array->child;
-    /*
-     * To find the last item in array quickly, we use prev in array
-     */
-    if (child == NULL)
-    {
-        /* list is empty, start new one */
-        array->child = item;
-        item->prev = item;
-        item->next = NULL;
-    }
-    else
+    *value = 0;
+    for (i = 0; i < size; i++)
     {
-        /* append to the end */
-        if (child->prev)
-        {
-            suffix_object(child->prev, item);
-            array->child->prev = item;
-        }
+        *value = (*value << 8) | buffer_at_offset(input_buffer)[i];
     }
+    input_buffer->offset += size;
 
     return true;
 }
 
-/* Add item to array/object. */
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
+/* read a size of size bytes, every byte or element takes at least one byte, so it can't be more than what is left of the input */
+static cJSON_bool parse_msgpack_size(parse_buffer * const input_buffer, const size_t size, size_t * const length)
 {
-    return add_item_to_array(array, item);
+    unsigned long value = 0;
+
+    if (!parse_msgpack_unsigned(input_buffer, size, &value) || (value > (input_buffer->length - input_buffer->offset)))
+    {
+        return false;
+    }
+    *length = (size_t)value;
+
+    return true;
 }
 
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void* cast_away_const(const void* string)
+/* copy length bytes of the input into a newly allocated null terminated string */
+static unsigned char *parse_msgpack_bytes(parse_buffer * const input_buffer, const size_t length)
 {
-    return (void*)string;
-}
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic pop
-#endif
+    unsigned char *string = NULL;
 
+    if (!can_read(input_buffer, length))
+    {
+        return NULL;
+    }
 
-static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
+    string = (unsigned char*)input_buffer->hooks.allocate(length + sizeof(""));
+    if (string == NULL)
+    {
+        return NULL;
+    }
+    memcpy(string, buffer_at_offset(input_buffer), length);
+    string[length] = '\0';
+    input_buffer->offset += length;
+
+    return string;
+}
+
+/* parse a str or bin of any size into a newly allocated string, NULL if the input is something else */
+static unsigned char *parse_msgpack_string(parse_buffer * const input_buffer)
 {
-    char *new_key = NULL;
-    int new_type = cJSON_Invalid;
+    unsigned char type = 0;
+    size_t length = 0;
 
-    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item))
+    if (cannot_access_at_index(input_buffer, 0))
     {
-        return false;
+        return NULL;
     }
+    type = buffer_at_offset(input_buffer)[0];
+    input_buffer->offset++;
 
-    if (constant_key)
+    if ((type & 0xE0) == MSGPACK_FIXSTR)
     {
-        new_key = (char*)cast_away_const(string);
-        new_type = item->type | cJSON_StringIsConst;
+        length = (size_t)(type & 0x1F);
     }
-    else
+    else if ((type == MSGPACK_STR8) || (type == MSGPACK_BIN8))
     {
-        new_key = (char*)cJSON_strdup((const unsigned char*)string, hooks);
-        if (new_key == NULL)
+        if (!parse_msgpack_size(input_buffer, 1, &length))
         {
-            return false;
+            return NULL;
         }
-
-        new_type = item->type & ~cJSON_StringIsConst;
     }
-
-    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+    else if ((type == MSGPACK_STR16) || (type == MSGPACK_BIN16))
     {
-        hooks->deallocate(item->string);
+        if (!parse_msgpack_size(input_buffer, 2, &length))
+        {
+            return NULL;
+        }
     }
-
-    item->string = new_key;
-    item->type = new_type;
-
-    return add_item_to_array(object, item);
-}
-
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
-{
-    return add_item_to_object(object, string, item, &global_hooks, false);
-}
-
-/* Add an item to an object with constant string as key */
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item)
-{
-    return add_item_to_object(object, string, item, &global_hooks, true);
-}
-
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)
-{
-    if (array == NULL)
+    else if ((type == MSGPACK_STR32) || (type == MSGPACK_BIN32))
     {
-        return false;
+        if (!parse_msgpack_size(input_buffer, 4, &length))
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        input_buffer->offset--;
+        return NULL;
     }
 
-    return add_item_to_array(array, create_reference(item, &global_hooks));
+    return parse_msgpack_bytes(input_buffer, length);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item)
+/* parse a 64 bit integer, rounded to the nearest double */
+static cJSON_bool parse_msgpack_int64(cJSON * const item, parse_buffer * const input_buffer, const cJSON_bool is_signed)
 {
-    if ((object == NULL) || (string == NULL))
+    unsigned long high = 0;
+    unsigned long low = 0;
+    cJSON_uint64 value = 0;
+
+    if (!parse_msgpack_unsigned(input_buffer, 4, &high) || !parse_msgpack_unsigned(input_buffer, 4, &low))
     {
         return false;
     }
+    value = ((cJSON_uint64)high << 32) | low;
 
-    return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
-{
-    cJSON *null = cJSON_CreateNull();
-    if (add_item_to_object(object, name, null, &global_hooks, false))
+    if (is_signed && ((high & 0x80000000UL) != 0))
     {
-        return null;
+        /* negate the two's complement */
+        return set_integer(item, true, (~value) + 1, &(input_buffer->hooks));
     }
 
-    cJSON_Delete(null);
-    return NULL;
+    return set_integer(item, false, value, &(input_buffer->hooks));
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+/* parse a fixed size integer of size bytes (at most 4) */
+static cJSON_bool parse_msgpack_integer(cJSON * const item, parse_buffer * const input_buffer, const size_t size, const cJSON_bool is_signed)
 {
-    cJSON *true_item = cJSON_CreateTrue();
-    if (add_item_to_object(object, name, true_item, &global_hooks, false))
+    unsigned long value = 0;
+    double number = 0;
+
+    if (!parse_msgpack_unsigned(input_buffer, size, &value))
     {
-        return true_item;
+        return false;
     }
 
-    cJSON_Delete(true_item);
-    return NULL;
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON * const object, const char * const name)
-{
-    cJSON *false_item = cJSON_CreateFalse();
-    if (add_item_to_object(object, name, false_item, &global_hooks, false))
+    number = (double)value;
+    if (is_signed && ((value >> ((8 * size) - 1)) != 0))
     {
-        return false_item;
+        /* sign bit is set */
+        number -= ldexp(1.0, (int)(8 * size));
     }
 
-    cJSON_Delete(false_item);
-    return NULL;
+    item->type = cJSON_Number;
+    cJSON_SetNumberHelper(item, number);
+
+    return true;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean)
+static cJSON_bool parse_msgpack_value(cJSON * const item, parse_buffer * const input_buffer);
+
+static cJSON_bool parse_msgpack_container(cJSON * const item, parse_buffer * const input_buffer, size_t count, const cJSON_bool is_map)
 {
-    cJSON *bool_item = cJSON_CreateBool(boolean);
-    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
+    cJSON *head = NULL; /* head of the linked list */
+    cJSON *current_item = NULL;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
     {
-        return bool_item;
+        return false; /* to deeply nested */
     }
+    input_buffer->depth++;
 
-    cJSON_Delete(bool_item);
-    return NULL;
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number)
-{
-    cJSON *number_item = cJSON_CreateNumber(number);
-    if (add_item_to_object(object, name, number_item, &global_hooks, false))
+    for (; count > 0; count--)
     {
-        return number_item;
-    }
+        /* allocate next item */
+        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        if (new_item == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
 
-    cJSON_Delete(number_item);
-    return NULL;
-}
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string)
-{
-    cJSON *string_item = cJSON_CreateString(string);
-    if (add_item_to_object(object, name, string_item, &global_hooks, false))
-    {
-        return string_item;
+        if (is_map)
+        {
+            /* only str and bin can be keys */
+            current_item->string = (char*)parse_msgpack_string(input_buffer);
+            if (current_item->string == NULL)
+            {
+                goto fail;
+            }
+        }
+
+        if (!parse_msgpack_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
+        }
     }
 
-    cJSON_Delete(string_item);
-    return NULL;
-}
+    input_buffer->depth--;
 
-CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw)
-{
-    cJSON *raw_item = cJSON_CreateRaw(raw);
-    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
-    {
-        return raw_item;
+    if (head != NULL) {
+        head->prev = current_item;
     }
 
-    cJSON_Delete(raw_item);
-    return NULL;
-}
+    item->type = is_map ? cJSON_Object : cJSON_Array;
+    item->child = head;
 
-CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name)
-{
-    cJSON *object_item = cJSON_CreateObject();
-    if (add_item_to_object(object, name, object_item, &global_hooks, false))
+    return true;
+
+fail:
+    if (head != NULL)
     {
-        return object_item;
+        cJSON_Delete(head);
     }
 
-    cJSON_Delete(object_item);
-    return NULL;
+    return false;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name)
+/* parse an extension of length bytes, only the raw extension has a representation in cJSON */
+static cJSON_bool parse_msgpack_extension(cJSON * const item, parse_buffer * const input_buffer, const size_t length)
 {
-    cJSON *array = cJSON_CreateArray();
-    if (add_item_to_object(object, name, array, &global_hooks, false))
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (unsigned char)CJSON_MSGPACK_RAW_EXTENSION))
     {
-        return array;
+        return false;
     }
+    input_buffer->offset++;
 
-    cJSON_Delete(array);
-    return NULL;
+    item->valuestring = (char*)parse_msgpack_bytes(input_buffer, length);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    item->type = cJSON_Raw;
+
+    return true;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
+static cJSON_bool parse_msgpack_value(cJSON * const item, parse_buffer * const input_buffer)
 {
-    if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
+    unsigned char type = 0;
+    size_t size = 0;
+
+    if (cannot_access_at_index(input_buffer, 0))
     {
-        return NULL;
+        return false;
     }
+    type = buffer_at_offset(input_buffer)[0];
 
-    if (item != parent->child)
+    if (((type & 0xE0) == MSGPACK_FIXSTR) || ((type >= MSGPACK_BIN8) && (type <= MSGPACK_BIN32)) || ((type >= MSGPACK_STR8) && (type <= MSGPACK_STR32)))
     {
-        /* not the first element */
-        item->prev->next = item->next;
+        item->valuestring = (char*)parse_msgpack_string(input_buffer);
+        if (item->valuestring == NULL)
+        {
+            return false;
+        }
+        item->type = cJSON_String;
+        return true;
     }
-    if (item->next != NULL)
+
+    input_buffer->offset++;
+    if ((type <= MSGPACK_POSITIVE_FIXINT_MAX) || (type >= MSGPACK_NEGATIVE_FIXINT))
     {
-        /* not the last element */
-        item->next->prev = item->prev;
+        item->type = cJSON_Number;
+        cJSON_SetNumberHelper(item, (type <= MSGPACK_POSITIVE_FIXINT_MAX) ? (double)type : ((double)type - 256.0));
+        return true;
     }
-
-    if (item == parent->child)
+    if ((type & 0xF0) == MSGPACK_FIXMAP)
     {
-        /* first element */
-        parent->child = item->next;
+        return parse_msgpack_container(item, input_buffer, (size_t)(type & 0x0F), true);
     }
-    else if (item->next == NULL)
+    if ((type & 0xF0) == MSGPACK_FIXARRAY)
     {
-        /* last element */
-        parent->child->prev = item->prev;
+        return parse_msgpack_container(item, input_buffer, (size_t)(type & 0x0F), false);
     }
 
-    /* make sure the detached item doesn't point anywhere anymore */
-    item->prev = NULL;
-    item->next = NULL;
+    switch (type)
+    {
+        case MSGPACK_NIL:
+            item->type = cJSON_NULL;
+            return true;
 
-    return item;
-}
+        case MSGPACK_FALSE:
+            item->type = cJSON_False;
+            return true;
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which)
-{
-    if (which < 0)
-    {
-        return NULL;
-    }
+        case MSGPACK_TRUE:
+            item->type = cJSON_True;
+            item->valueint = 1;
+            return true;
 
-    return cJSON_DetachItemViaPointer(array, get_array_item(array, (size_t)which));
-}
+        case MSGPACK_FLOAT32:
+            return parse_binary_float(item, input_buffer, sizeof(float));
 
-CJSON_PUBLIC(void) cJSON_DeleteItemFromArray(cJSON *array, int which)
-{
-    cJSON_Delete(cJSON_DetachItemFromArray(array, which));
-}
+        case MSGPACK_FLOAT64:
+            return parse_binary_float(item, input_buffer, sizeof(double));
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObject(cJSON *object, const char *string)
-{
-    cJSON *to_detach = cJSON_GetObjectItem(object, string);
+        case MSGPACK_UINT8:
+        case MSGPACK_UINT16:
+        case MSGPACK_UINT32:
+            return parse_msgpack_integer(item, input_buffer, (size_t)1 << (type - MSGPACK_UINT8), false);
 
-    return cJSON_DetachItemViaPointer(object, to_detach);
+        case MSGPACK_INT8:
+        case MSGPACK_INT16:
+        case MSGPACK_INT32:
+            return parse_msgpack_integer(item, input_buffer, (size_t)1 << (type - MSGPACK_INT8), true);
+
+        case MSGPACK_UINT64:
+            return parse_msgpack_int64(item, input_buffer, false);
+
+        case MSGPACK_INT64:
+            return parse_msgpack_int64(item, input_buffer, true);
+
+        case MSGPACK_ARRAY16:
+        case MSGPACK_ARRAY32:
+            return parse_msgpack_size(input_buffer, (type == MSGPACK_ARRAY16) ? 2 : 4, &size)
+                && parse_msgpack_container(item, input_buffer, size, false);
+
+        case MSGPACK_MAP16:
+        case MSGPACK_MAP32:
+            return parse_msgpack_size(input_buffer, (type == MSGPACK_MAP16) ? 2 : 4, &size)
+                && parse_msgpack_container(item, input_buffer, size, true);
+
+        case MSGPACK_EXT8:
+        case MSGPACK_EXT16:
+        case MSGPACK_EXT32:
+            return parse_msgpack_size(input_buffer, (size_t)1 << (type - MSGPACK_EXT8), &size)
+                && parse_msgpack_extension(item, input_buffer, size);
+
+        default:
+            if ((type >= MSGPACK_FIXEXT1) && (type <= MSGPACK_FIXEXT16))
+            {
+                return parse_msgpack_extension(item, input_buffer, (size_t)1 << (type - MSGPACK_FIXEXT1));
+            }
+            return false; /* never used */
+    }
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObjectCaseSensitive(cJSON *object, const char *string)
+CJSON_PUBLIC(cJSON *) cJSON_ParseMessagePack(const unsigned char *value, size_t buffer_length, const unsigned char **return_parse_end)
 {
-    cJSON *to_detach = cJSON_GetObjectItemCaseSensitive(object, string);
+    return parse_binary(value, buffer_length, return_parse_end, parse_msgpack_value);
+}
 
-    return cJSON_DetachItemViaPointer(object, to_detach);
+/* Snapshot layout, all fields little endian:
+ * header: "cJSS", version (4 bytes), total length (8), number of nodes (8), Adler-32 of everything after the header (4), reserved (4)
+ * nodes in breadth first order, so the children of a node are consecutive:
+ *   type (4), number of children (4), offset of the key from the node or 0 (8),
+ *   number as double, offset of the string from the node or offset of the first child from the node (8)
+ * strings, null terminated */
+#define SNAPSHOT_VERSION 1UL
+#define SNAPSHOT_HEADER_SIZE 32
+#define SNAPSHOT_NODE_SIZE 24
+
+static void write_snapshot_u32(unsigned char * const destination, const unsigned long value)
+{
+    destination[0] = (unsigned char)(value & 0xFF);
+    destination[1] = (unsigned char)((value >> 8) & 0xFF);
+    destination[2] = (unsigned char)((value >> 16) & 0xFF);
+    destination[3] = (unsigned char)((value >> 24) & 0xFF);
 }
 
-CJSON_PUBLIC(void) cJSON_DeleteItemFromObject(cJSON *object, const char *string)
+static void write_snapshot_size(unsigned char * const destination, const size_t value)
 {
-    cJSON_Delete(cJSON_DetachItemFromObject(object, string));
+    /* shift twice, shifting a 32 bit size_t by 32 is undefined */
+    write_snapshot_u32(destination, (unsigned long)(value & 0xFFFFFFFFUL));
+    write_snapshot_u32(destination + 4, (unsigned long)((value >> 16) >> 16));
 }
 
-CJSON_PUBLIC(void) cJSON_DeleteItemFromObjectCaseSensitive(cJSON *object, const char *string)
+static unsigned long read_snapshot_u32(const unsigned char * const source)
 {
-    cJSON_Delete(cJSON_DetachItemFromObjectCaseSensitive(object, string));
+    return (unsigned long)source[0] | ((unsigned long)source[1] << 8) | ((unsigned long)source[2] << 16) | ((unsigned long)source[3] << 24);
 }
 
-/* Replace array/object items with new ones. */
-CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
+/* read a 64 bit size, sizes that don't fit into size_t become (size_t)-1 */
+static size_t read_snapshot_size(const unsigned char * const source)
 {
-    cJSON *after_inserted = NULL;
+    unsigned long high = read_snapshot_u32(source + 4);
+    size_t value = (size_t)read_snapshot_u32(source);
 
-    if (which < 0 || newitem == NULL)
+    if (high != 0)
     {
-        return false;
+        if (sizeof(size_t) <= 4)
+        {
+            return (size_t)-1;
+        }
+        value |= ((size_t)high << 16) << 16;
     }
 
-    after_inserted = get_array_item(array, (size_t)which);
-    if (after_inserted == NULL)
-    {
-        return add_item_to_array(array, newitem);
-    }
+    return value;
+}
 
-    if (after_inserted != array->child && after_inserted->prev == NULL) {
-        /* return false if after_inserted is a corrupted array item */
-        return false;
-    }
+static unsigned long adler32(const unsigned char *data, size_t length)
+{
+    unsigned long a = 1;
+    unsigned long b = 0;
 
-    newitem->next = after_inserted;
-    newitem->prev = after_inserted->prev;
-    after_inserted->prev = newitem;
-    if (after_inserted == array->child)
-    {
-        array->child = newitem;
-    }
-    else
+    while (length > 0)
     {
-        newitem->prev->next = newitem;
+        /* the largest number of bytes before b can overflow 32 bits */
+        size_t block = (length < 5552) ? length : 5552;
+        length -= block;
+        while (block-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521UL;
+        b %= 65521UL;
     }
-    return true;
+
+    return ((b << 16) | a) & 0xFFFFFFFFUL;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
+/* count the nodes and the bytes of the strings of a tree */
+static cJSON_bool measure_snapshot(const cJSON * const item, const size_t depth, size_t * const node_count, size_t * const string_size)
 {
-    if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
+    const cJSON *child = NULL;
+
+    if (depth > CJSON_NESTING_LIMIT)
     {
         return false;
     }
 
-    if (replacement == item)
+    (*node_count)++;
+    if (item->string != NULL)
     {
-        return true;
+        *string_size += strlen(item->string) + sizeof("");
     }
 
-    replacement->next = item->next;
-    replacement->prev = item->prev;
-
-    if (replacement->next != NULL)
-    {
-        replacement->next->prev = replacement;
-    }
-    if (parent->child == item)
+    switch (item->type & 0xFF)
     {
-        if (parent->child->prev == parent->child)
-        {
-            replacement->prev = replacement;
-        }
-        parent->child = replacement;
-    }
-    else
-    {   /*
-         * To find the last item in array quickly, we use prev in array.
-         * We can't modify the last item's next pointer where this item was the parent's child
-         */
-        if (replacement->prev != NULL)
-        {
-            replacement->prev->next = replacement;
-        }
-        if (replacement->next == NULL)
-        {
-            parent->child->prev = replacement;
-        }
-    }
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_NULL:
+        case cJSON_Number:
+            return true;
 
-    item->next = NULL;
-    item->prev = NULL;
-    cJSON_Delete(item);
+        case cJSON_String:
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            *string_size += strlen(item->valuestring) + sizeof("");
+            return true;
 
-    return true;
+        case cJSON_Array:
+        case cJSON_Object:
+            if (item->type & cJSON_IsPacked)
+            {
+                return false; /* snapshots need the elements as items */
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if (!measure_snapshot(child, depth + 1, node_count, string_size))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem)
+static size_t add_snapshot_string(unsigned char * const snapshot, size_t * const string_position, const size_t node_position, const char * const string)
 {
-    if (which < 0)
-    {
-        return false;
-    }
+    size_t length = strlen(string) + sizeof("");
+    size_t offset = *string_position - node_position;
 
-    return cJSON_ReplaceItemViaPointer(array, get_array_item(array, (size_t)which), newitem);
+    memcpy(snapshot + *string_position, string, length);
+    *string_position += length;
+
+    return offset;
 }
 
-static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSON *replacement, cJSON_bool case_sensitive)
+CJSON_PUBLIC(unsigned char *) cJSON_CreateSnapshot(const cJSON *item, size_t *length)
 {
-    if ((replacement == NULL) || (string == NULL))
+    const cJSON **queue = NULL;
+    unsigned char *snapshot = NULL;
+    size_t node_count = 0;
+    size_t string_size = 0;
+    size_t total_length = 0;
+    size_t string_position = 0;
+    size_t queued = 1;
+    size_t i = 0;
+
+    if ((item == NULL) || (length == NULL) || !measure_snapshot(item, 0, &node_count, &string_size))
     {
-        return false;
+        return NULL;
     }
 
-    /* replace the name in the replacement */
-    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    if (node_count > ((((size_t)-1) - SNAPSHOT_HEADER_SIZE - string_size) / SNAPSHOT_NODE_SIZE))
     {
-        cJSON_free(replacement->string);
+        return NULL; /* overflow */
     }
-    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
-    if (replacement->string == NULL)
+    total_length = SNAPSHOT_HEADER_SIZE + (node_count * SNAPSHOT_NODE_SIZE) + string_size;
+
+    /* the items in breadth first order, a node's children are queued when the node is written */
+    queue = (const cJSON**)global_hooks.allocate(node_count * sizeof(cJSON*));
+    snapshot = (unsigned char*)global_hooks.allocate(total_length);
+    if ((queue == NULL) || (snapshot == NULL))
     {
-        return false;
+        goto fail;
     }
+    memset(snapshot, '\0', SNAPSHOT_HEADER_SIZE + (node_count * SNAPSHOT_NODE_SIZE));
 
-    replacement->type &= ~cJSON_StringIsConst;
-
-    return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
-}
+    string_position = SNAPSHOT_HEADER_SIZE + (node_count * SNAPSHOT_NODE_SIZE);
+    queue[0] = item;
+    for (i = 0; i < node_count; i++)
+    {
+        const cJSON *current = queue[i];
+        const cJSON *child = NULL;
+        size_t node_position = SNAPSHOT_HEADER_SIZE + (i * SNAPSHOT_NODE_SIZE);
+        unsigned char *node = snapshot + node_position;
+        size_t child_count = 0;
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem)
-{
-    return replace_item_in_object(object, string, newitem, false);
-}
+        write_snapshot_u32(node, (unsigned long)(current->type & 0xFF));
+        if (current->string != NULL)
+        {
+            write_snapshot_size(node + 8, add_snapshot_string(snapshot, &string_position, node_position, current->string));
+        }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object, const char *string, cJSON *newitem)
-{
-    return replace_item_in_object(object, string, newitem, true);
-}
+        switch (current->type & 0xFF)
+        {
+            case cJSON_Number:
+                swap_to_little_endian(node + 16, &current->valuedouble, sizeof(current->valuedouble));
+                break;
 
-/* Create basic types: */
-CJSON_PUBLIC(cJSON *) cJSON_CreateNull(void)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type = cJSON_NULL;
-    }
+            case cJSON_String:
+            case cJSON_Raw:
+                write_snapshot_size(node + 16, add_snapshot_string(snapshot, &string_position, node_position, current->valuestring));
+                break;
 
-    return item;
-}
+            case cJSON_Array:
+            case cJSON_Object:
+                write_snapshot_size(node + 16, SNAPSHOT_HEADER_SIZE + (queued * SNAPSHOT_NODE_SIZE) - node_position);
+                for (child = current->child; child != NULL; child = child->next)
+                {
+                    queue[queued++] = child;
+                    child_count++;
+                }
+                if (((child_count >> 16) >> 16) != 0)
+                {
+                    goto fail;
+                }
+                write_snapshot_u32(node + 4, (unsigned long)child_count);
+                break;
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type = cJSON_True;
+            default:
+                break;
+        }
     }
 
-    return item;
-}
+    memcpy(snapshot, "cJSS", 4);
+    write_snapshot_u32(snapshot + 4, SNAPSHOT_VERSION);
+    write_snapshot_size(snapshot + 8, total_length);
+    write_snapshot_size(snapshot + 16, node_count);
+    write_snapshot_u32(snapshot + 24, adler32(snapshot + SNAPSHOT_HEADER_SIZE, total_length - SNAPSHOT_HEADER_SIZE));
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type = cJSON_False;
-    }
+    global_hooks.deallocate((void*)queue);
+    *length = total_length;
 
-    return item;
-}
+    return snapshot;
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+fail:
+    if (queue != NULL)
     {
-        item->type = boolean ? cJSON_True : cJSON_False;
+        global_hooks.deallocate((void*)queue);
+    }
+    if (snapshot != NULL)
+    {
+        global_hooks.deallocate(snapshot);
     }
 
-    return item;
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
+/* check that every offset stays inside of the snapshot and every string is terminated */
+static cJSON_bool verify_snapshot_nodes(const unsigned char * const snapshot, const size_t length, const size_t node_count)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    size_t strings_start = SNAPSHOT_HEADER_SIZE + (node_count * SNAPSHOT_NODE_SIZE);
+    size_t i = 0;
+
+    if ((strings_start < length) && (snapshot[length - 1] != '\0'))
     {
-        item->type = cJSON_Number;
-        item->valuedouble = num;
+        return false; /* unterminated string */
+    }
 
-        /* use saturation in case of overflow */
-        if (num >= INT_MAX)
-        {
-            item->valueint = INT_MAX;
-        }
-        else if (num <= (double)INT_MIN)
+    for (i = 0; i < node_count; i++)
+    {
+        size_t node_position = SNAPSHOT_HEADER_SIZE + (i * SNAPSHOT_NODE_SIZE);
+        const unsigned char *node = snapshot + node_position;
+        size_t key = read_snapshot_size(node + 8);
+        size_t value = read_snapshot_size(node + 16);
+        size_t child_count = (size_t)read_snapshot_u32(node + 4);
+
+        if ((key != 0) && ((key > (length - node_position)) || ((node_position + key) < strings_start) || ((node_position + key) >= length)))
         {
-            item->valueint = INT_MIN;
+            return false;
         }
-        else
+
+        switch (read_snapshot_u32(node))
         {
-            item->valueint = (int)num;
+            case cJSON_False:
+            case cJSON_True:
+            case cJSON_NULL:
+            case cJSON_Number:
+                break;
+
+            case cJSON_String:
+            case cJSON_Raw:
+                if ((value > (length - node_position)) || ((node_position + value) < strings_start) || ((node_position + value) >= length))
+                {
+                    return false;
+                }
+                break;
+
+            case cJSON_Array:
+            case cJSON_Object:
+                /* children always come after their parent and are whole nodes */
+                if ((value == 0) || ((value % SNAPSHOT_NODE_SIZE) != 0) || (value > (strings_start - node_position))
+                    || (child_count > ((strings_start - node_position - value) / SNAPSHOT_NODE_SIZE)))
+                {
+                    return false;
+                }
+                break;
+
+            default:
+                return false;
         }
     }
 
-    return item;
+    return true;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string)
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_OpenSnapshot(const void *snapshot, size_t length, cJSON_bool verify)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    const unsigned char *bytes = (const unsigned char*)snapshot;
+    size_t node_count = 0;
+
+    if ((bytes == NULL) || (length < (SNAPSHOT_HEADER_SIZE + SNAPSHOT_NODE_SIZE))
+        || (memcmp(bytes, "cJSS", 4) != 0) || (read_snapshot_u32(bytes + 4) != SNAPSHOT_VERSION)
+        || (read_snapshot_size(bytes + 8) != length) || (read_snapshot_u32(bytes + 28) != 0))
     {
-        item->type = cJSON_String;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
-        if(!item->valuestring)
-        {
-            cJSON_Delete(item);
-            return NULL;
-        }
+        return NULL;
     }
 
-    return item;
-}
+    node_count = read_snapshot_size(bytes + 16);
+    if ((node_count == 0) || (node_count > ((length - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_NODE_SIZE)))
+    {
+        return NULL;
+    }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateStringReference(const char *string)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL)
+    if (verify && ((adler32(bytes + SNAPSHOT_HEADER_SIZE, length - SNAPSHOT_HEADER_SIZE) != read_snapshot_u32(bytes + 24))
+        || !verify_snapshot_nodes(bytes, length, node_count)))
     {
-        item->type = cJSON_String | cJSON_IsReference;
-        item->valuestring = (char*)cast_away_const(string);
+        return NULL;
     }
 
-    return item;
+    return (const cJSON_SnapshotItem*)(const void*)(bytes + SNAPSHOT_HEADER_SIZE);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateObjectReference(const cJSON *child)
+CJSON_PUBLIC(int) cJSON_SnapshotGetType(const cJSON_SnapshotItem *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Object | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
+    if (item == NULL)
+    {
+        return cJSON_Invalid;
     }
 
-    return item;
+    return (int)read_snapshot_u32((const unsigned char*)(const void*)item);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateArrayReference(const cJSON *child) {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Array | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
+CJSON_PUBLIC(int) cJSON_SnapshotGetSize(const cJSON_SnapshotItem *item)
+{
+    int type = cJSON_SnapshotGetType(item);
+    unsigned long size = 0;
+
+    if ((type != cJSON_Array) && (type != cJSON_Object))
+    {
+        return 0;
     }
 
-    return item;
+    size = read_snapshot_u32((const unsigned char*)(const void*)item + 4);
+
+    return (size > INT_MAX) ? INT_MAX : (int)size;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw)
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetArrayItem(const cJSON_SnapshotItem *array, int index)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    const unsigned char *node = (const unsigned char*)(const void*)array;
+
+    if ((index < 0) || (index >= cJSON_SnapshotGetSize(array)))
     {
-        item->type = cJSON_Raw;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)raw, &global_hooks);
-        if(!item->valuestring)
-        {
-            cJSON_Delete(item);
-            return NULL;
-        }
+        return NULL;
     }
 
-    return item;
+    /* the children are consecutive */
+    return (const cJSON_SnapshotItem*)(const void*)(node + read_snapshot_size(node + 16) + ((size_t)index * SNAPSHOT_NODE_SIZE));
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateArray(void)
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItem(const cJSON_SnapshotItem *object, const char *name)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    int size = 0;
+    int i = 0;
+
+    if ((cJSON_SnapshotGetType(object) != cJSON_Object) || (name == NULL))
     {
-        item->type=cJSON_Array;
+        return NULL;
     }
 
-    return item;
+    size = cJSON_SnapshotGetSize(object);
+    for (i = 0; i < size; i++)
+    {
+        const cJSON_SnapshotItem *member = cJSON_SnapshotGetArrayItem(object, i);
+        const char *key = cJSON_SnapshotGetKey(member);
+        if ((key != NULL) && (strcmp(key, name) == 0))
+        {
+            return member;
+        }
+    }
+
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateObject(void)
+CJSON_PUBLIC(const char *) cJSON_SnapshotGetKey(const cJSON_SnapshotItem *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item)
+    const unsigned char *node = (const unsigned char*)(const void*)item;
+    size_t offset = 0;
+
+    if (item == NULL)
     {
-        item->type = cJSON_Object;
+        return NULL;
     }
 
-    return item;
+    offset = read_snapshot_size(node + 8);
+
+    return (offset == 0) ? NULL : (const char*)(node + offset);
 }
 
-/* Create Arrays: */
-CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count)
+CJSON_PUBLIC(const char *) cJSON_SnapshotGetString(const cJSON_SnapshotItem *item)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    const unsigned char *node = (const unsigned char*)(const void*)item;
+    int type = cJSON_SnapshotGetType(item);
 
-    if ((count < 0) || (numbers == NULL))
+    if ((type != cJSON_String) && (type != cJSON_Raw))
     {
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    return (const char*)(node + read_snapshot_size(node + 16));
+}
 
-    for(i = 0; a && (i < (size_t)count); i++)
+CJSON_PUBLIC(double) cJSON_SnapshotGetNumber(const cJSON_SnapshotItem *item)
+{
+    double number = 0;
+
+    if (cJSON_SnapshotGetType(item) != cJSON_Number)
     {
-        n = cJSON_CreateNumber(numbers[i]);
-        if (!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+        return (double)NAN;
     }
 
-    if (a && a->child) {
-        a->child->prev = n;
-    }
+    swap_to_little_endian((unsigned char*)&number, (const unsigned char*)(const void*)item + 16, sizeof(number));
 
-    return a;
+    return number;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count)
+static cJSON *snapshot_to_tree(const cJSON_SnapshotItem * const item, const size_t depth)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    cJSON *tree = NULL;
+    cJSON *last_child = NULL;
+    int size = 0;
+    int i = 0;
 
-    if ((count < 0) || (numbers == NULL))
+    if (depth > CJSON_NESTING_LIMIT)
     {
         return NULL;
     }
 
-    a = cJSON_CreateArray();
-
-    for(i = 0; a && (i < (size_t)count); i++)
+    tree = cJSON_New_Item(&global_hooks);
+    if (tree == NULL)
     {
-        n = cJSON_CreateNumber((double)numbers[i]);
-        if(!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+        return NULL;
     }
+    tree->type = cJSON_SnapshotGetType(item);
 
-    if (a && a->child) {
-        a->child->prev = n;
+    switch (tree->type)
+    {
+        case cJSON_True:
+            tree->valueint = 1;
+            break;
+
+        case cJSON_Number:
+            cJSON_SetNumberHelper(tree, cJSON_SnapshotGetNumber(item));
+            break;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            tree->valuestring = (char*)cJSON_strdup((const unsigned char*)cJSON_SnapshotGetString(item), &global_hooks);
+            if (tree->valuestring == NULL)
+            {
+                goto fail;
+            }
+            break;
+
+        case cJSON_Array:
+        case cJSON_Object:
+            size = cJSON_SnapshotGetSize(item);
+            for (i = 0; i < size; i++)
+            {
+                const cJSON_SnapshotItem *snapshot_child = cJSON_SnapshotGetArrayItem(item, i);
+                cJSON *child = snapshot_to_tree(snapshot_child, depth + 1);
+                if (child == NULL)
+                {
+                    goto fail;
+                }
+
+                if (last_child == NULL)
+                {
+                    tree->child = child;
+                }
+                else
+                {
+                    last_child->next = child;
+                    child->prev = last_child;
+                }
+                last_child = child;
+                tree->child->prev = last_child;
+
+                if ((tree->type == cJSON_Object) && (cJSON_SnapshotGetKey(snapshot_child) != NULL))
+                {
+                    child->string = (char*)cJSON_strdup((const unsigned char*)cJSON_SnapshotGetKey(snapshot_child), &global_hooks);
+                    if (child->string == NULL)
+                    {
+                        goto fail;
+                    }
+                }
+            }
+            break;
+
+        default:
+            break;
     }
 
-    return a;
+    return tree;
+
+fail:
+    cJSON_Delete(tree);
+
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count)
+CJSON_PUBLIC(cJSON *) cJSON_SnapshotToTree(const cJSON_SnapshotItem *item)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
-
-    if ((count < 0) || (numbers == NULL))
+    if (item == NULL)
     {
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    return snapshot_to_tree(item, 0);
+}
 
-    for(i = 0; a && (i < (size_t)count); i++)
-    {
-        n = cJSON_CreateNumber(numbers[i]);
-        if(!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+/* Columnar extraction */
+
+typedef struct
+{
+    size_t string_size; /* bytes of the column's strings buffer that are in use */
+    size_t string_capacity;
+    cJSON_bool seen; /* the current record already had a member for this column */
+} column_state;
+
+typedef struct
+{
+    cJSON_Column *columns;
+    column_state *states;
+    size_t column_count;
+    size_t count; /* number of records */
+    size_t capacity; /* number of records the buffers have room for */
+    internal_hooks hooks;
+} column_builder;
+
+#define column_is_null(column, index) ((((column)->nulls[(index) / 8] >> ((index) % 8)) & 1) != 0)
+
+/* Move the first used bytes of buffer into a new allocation of size bytes, the rest of it is zeroed. */
+static void *grow_column_buffer(const internal_hooks * const hooks, void * const buffer, const size_t used, const size_t size)
+{
+    unsigned char *grown = (unsigned char*)hooks->allocate(size);
+    if (grown == NULL)
+    {
+        return NULL;
     }
 
-    if (a && a->child) {
-        a->child->prev = n;
+    if (buffer != NULL)
+    {
+        memcpy(grown, buffer, used);
+        hooks->deallocate(buffer);
     }
+    memset(grown + used, '\0', size - used);
 
-    return a;
+    return grown;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count)
+/* make sure that every column has room for capacity records */
+static cJSON_bool reserve_records(column_builder * const builder, size_t capacity)
 {
     size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
 
-    if ((count < 0) || (strings == NULL))
+    if (capacity <= builder->capacity)
     {
-        return NULL;
+        return true;
     }
 
-    a = cJSON_CreateArray();
+    /* round up so that the null bitmaps always consist of whole bytes */
+    capacity = (capacity + 7) & ~(size_t)7;
+    if (capacity > (((size_t)-1) / sizeof(double)) - 1)
+    {
+        return false;
+    }
 
-    for (i = 0; a && (i < (size_t)count); i++)
+    for (i = 0; i < builder->column_count; i++)
     {
-        n = cJSON_CreateString(strings[i]);
-        if(!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
+        cJSON_Column * const column = &builder->columns[i];
+        void *grown = NULL;
+
+        if (column->type == cJSON_String)
         {
-            a->child = n;
+            grown = grow_column_buffer(&builder->hooks, column->string_offsets, (builder->capacity + 1) * sizeof(size_t), (capacity + 1) * sizeof(size_t));
+            if (grown == NULL)
+            {
+                return false;
+            }
+            column->string_offsets = (size_t*)grown;
         }
         else
         {
-            suffix_object(p,n);
+            grown = grow_column_buffer(&builder->hooks, column->numbers, builder->capacity * sizeof(double), capacity * sizeof(double));
+            if (grown == NULL)
+            {
+                return false;
+            }
+            column->numbers = (double*)grown;
         }
-        p = n;
-    }
 
-    if (a && a->child) {
-        a->child->prev = n;
+        grown = grow_column_buffer(&builder->hooks, column->nulls, builder->capacity / 8, capacity / 8);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        column->nulls = (unsigned char*)grown;
     }
+    builder->capacity = capacity;
 
-    return a;
-}
-
-/* Duplication */
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
-
-CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
-{
-    return cJSON_Duplicate_rec(item, 0, recurse );
+    return true;
 }
 
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+/* start a record where every column is null */
+static cJSON_bool begin_record(column_builder * const builder)
 {
-    cJSON *newitem = NULL;
-    cJSON *child = NULL;
-    cJSON *next = NULL;
-    cJSON *newchild = NULL;
+    size_t i = 0;
 
-    /* Bail on bad ptr */
-    if (!item)
-    {
-        goto fail;
-    }
-    /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
-    if (!newitem)
+    if ((builder->count == builder->capacity) && !reserve_records(builder, (builder->capacity == 0) ? 16 : builder->capacity * 2))
     {
-        goto fail;
+        return false;
     }
-    /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
-    newitem->valueint = item->valueint;
-    newitem->valuedouble = item->valuedouble;
-    if (item->valuestring)
+
+    for (i = 0; i < builder->column_count; i++)
     {
-        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
-        if (!newitem->valuestring)
+        cJSON_Column * const column = &builder->columns[i];
+
+        builder->states[i].seen = false;
+        column->nulls[builder->count / 8] = (unsigned char)(column->nulls[builder->count / 8] | (1 << (builder->count % 8)));
+        if (column->type == cJSON_String)
         {
-            goto fail;
+            column->string_offsets[builder->count] = builder->states[i].string_size;
         }
-    }
-    if (item->string)
-    {
-        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
-        if (!newitem->string)
+        else
         {
-            goto fail;
+            column->numbers[builder->count] = 0;
         }
     }
-    /* If non-recursive, then we're done! */
-    if (!recurse)
-    {
-        return newitem;
-    }
-    /* Walk the ->next chain for the child. */
-    child = item->child;
-    while (child != NULL)
+
+    return true;
+}
+
+static cJSON_bool add_column_string(column_builder * const builder, const size_t index, const char * const string, const size_t length)
+{
+    cJSON_Column * const column = &builder->columns[index];
+    column_state * const state = &builder->states[index];
+
+    if (length >= (state->string_capacity - state->string_size))
     {
-        if(depth >= CJSON_CIRCULAR_LIMIT) {
-            goto fail;
-        }
-        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
-        if (!newchild)
+        size_t capacity = state->string_capacity * 2;
+        void *grown = NULL;
+
+        if (capacity < (state->string_size + length + 1))
         {
-            goto fail;
+            capacity = state->string_size + length + 64;
         }
-        if (next != NULL)
+        if ((capacity < state->string_capacity) || (capacity < length))
         {
-            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
-            next = newchild;
+            return false; /* overflow */
         }
-        else
+
+        grown = grow_column_buffer(&builder->hooks, column->strings, state->string_size, capacity);
+        if (grown == NULL)
         {
-            /* Set newitem->child and move to it */
-            newitem->child = newchild;
-            next = newchild;
+            return false;
         }
-        child = child->next;
+        column->strings = (char*)grown;
+        state->string_capacity = capacity;
     }
-    if (newitem && newitem->child)
+
+    memcpy(column->strings + state->string_size, string, length);
+    column->strings[state->string_size + length] = '\0';
+    state->string_size += length + 1;
+
+    return true;
+}
+
+/* Store the value of a member of the current record. Only the first member with the column's name counts,
+ * values that don't have the column's type leave it null. */
+static cJSON_bool set_column_value(column_builder * const builder, const size_t index, const cJSON * const value)
+{
+    cJSON_Column * const column = &builder->columns[index];
+    cJSON_bool matches = false;
+
+    if (builder->states[index].seen)
     {
-        newitem->child->prev = newchild;
+        return true;
     }
+    builder->states[index].seen = true;
 
-    return newitem;
+    switch (column->type)
+    {
+        case cJSON_Number:
+            matches = cJSON_IsNumber(value);
+            if (matches)
+            {
+                column->numbers[builder->count] = value->valuedouble;
+            }
+            break;
 
-fail:
-    if (newitem != NULL)
+        case cJSON_True:
+            matches = cJSON_IsBool(value);
+            if (matches)
+            {
+                column->numbers[builder->count] = cJSON_IsTrue(value) ? 1 : 0;
+            }
+            break;
+
+        case cJSON_String:
+            matches = cJSON_IsString(value) && (value->valuestring != NULL);
+            if (matches && !add_column_string(builder, index, value->valuestring, strlen(value->valuestring)))
+            {
+                return false;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (matches)
     {
-        cJSON_Delete(newitem);
+        column->nulls[builder->count / 8] = (unsigned char)(column->nulls[builder->count / 8] & ~(1 << (builder->count % 8)));
     }
 
-    return NULL;
+    return true;
 }
 
-static void skip_oneline_comment(char **input)
+static cJSON_bool end_record(column_builder * const builder)
 {
-    *input += static_strlen("//");
+    size_t i = 0;
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    for (i = 0; i < builder->column_count; i++)
     {
-        if ((*input)[0] == '\n') {
-            *input += static_strlen("\n");
-            return;
+        /* null strings are stored as empty strings */
+        if ((builder->columns[i].type == cJSON_String) && column_is_null(&builder->columns[i], builder->count) && !add_column_string(builder, i, "", 0))
+        {
+            return false;
         }
     }
+    builder->count++;
+
+    return true;
 }
 
-static void skip_multiline_comment(char **input)
+/* Returns the index of the column with the given name or column_count if there is none. */
+static size_t find_column(const column_builder * const builder, const unsigned char * const name, const size_t name_length)
 {
-    *input += static_strlen("/*");
+    size_t i = 0;
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    for (i = 0; i < builder->column_count; i++)
     {
-        if (((*input)[0] == '*') && ((*input)[1] == '/'))
+        const char *column_name = builder->columns[i].name;
+        if ((strlen(column_name) == name_length) && (memcmp(column_name, name, name_length) == 0))
         {
-            *input += static_strlen("*/");
-            return;
+            break;
         }
     }
-}
 
-static void minify_string(char **input, char **output) {
-    (*output)[0] = (*input)[0];
-    *input += static_strlen("\"");
-    *output += static_strlen("\"");
-
-
-    for (; (*input)[0] != '\0'; (void)++(*input), ++(*output)) {
-        (*output)[0] = (*input)[0];
-
-        if ((*input)[0] == '\"') {
-            (*output)[0] = '\"';
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
-            return;
-        } else if (((*input)[0] == '\\') && ((*input)[1] == '\"')) {
-            (*output)[1] = (*input)[1];
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
-        }
-    }
+    return i;
 }
 
-CJSON_PUBLIC(void) cJSON_Minify(char *json)
+static cJSON_bool begin_columns(column_builder * const builder, cJSON_Column * const columns, const int column_count)
 {
-    char *into = json;
+    size_t i = 0;
 
-    if (json == NULL)
+    if ((column_count < 0) || ((columns == NULL) && (column_count > 0)))
     {
-        return;
+        return false;
     }
 
-    while (json[0] != '\0')
+    memset(builder, '\0', sizeof(*builder));
+    builder->columns = columns;
+    builder->column_count = (size_t)column_count;
+    builder->hooks = global_hooks;
+
+    for (i = 0; i < builder->column_count; i++)
     {
-        switch (json[0])
+        if ((columns[i].name == NULL) || ((columns[i].type != cJSON_Number) && (columns[i].type != cJSON_True) && (columns[i].type != cJSON_String)))
         {
-            case ' ':
-            case '\t':
-            case '\r':
-            case '\n':
-                json++;
-                break;
-
-            case '/':
-                if (json[1] == '/')
-                {
-                    skip_oneline_comment(&json);
-                }
-                else if (json[1] == '*')
-                {
-                    skip_multiline_comment(&json);
-                } else {
-                    json++;
-                }
-                break;
-
-            case '\"':
-                minify_string(&json, (char**)&into);
-                break;
+            return false;
+        }
+        columns[i].numbers = NULL;
+        columns[i].string_offsets = NULL;
+        columns[i].strings = NULL;
+        columns[i].nulls = NULL;
+    }
 
-            default:
-                into[0] = json[0];
-                json++;
-                into++;
+    if (builder->column_count > 0)
+    {
+        builder->states = (column_state*)builder->hooks.allocate(builder->column_count * sizeof(column_state));
+        if (builder->states == NULL)
+        {
+            return false;
         }
+        memset(builder->states, '\0', builder->column_count * sizeof(column_state));
     }
 
-    /* and null-terminate. */
-    *into = '\0';
+    return true;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item)
+static cJSON_bool end_columns(column_builder * const builder, const cJSON_bool success, size_t * const record_count)
 {
-    if (item == NULL)
+    size_t i = 0;
+    cJSON_bool finished = success && reserve_records(builder, 1);
+
+    if (finished)
     {
-        return false;
+        for (i = 0; i < builder->column_count; i++)
+        {
+            if (builder->columns[i].type == cJSON_String)
+            {
+                builder->columns[i].string_offsets[builder->count] = builder->states[i].string_size;
+            }
+        }
+        *record_count = builder->count;
+    }
+    else
+    {
+        cJSON_FreeColumns(builder->columns, (int)builder->column_count);
+    }
+
+    if (builder->states != NULL)
+    {
+        builder->hooks.deallocate(builder->states);
+        builder->states = NULL;
     }
 
-    return (item->type & 0xFF) == cJSON_Invalid;
+    return finished;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsFalse(const cJSON * const item)
+CJSON_PUBLIC(cJSON_bool) cJSON_ExtractColumns(const cJSON *array, cJSON_Column *columns, int column_count, size_t *record_count)
 {
-    if (item == NULL)
+    column_builder builder;
+    const cJSON *record = NULL;
+    cJSON_bool success = false;
+
+    if (!cJSON_IsArray(array) || (record_count == NULL) || !begin_columns(&builder, columns, column_count))
     {
         return false;
     }
 
-    return (item->type & 0xFF) == cJSON_False;
-}
+    if (!reserve_records(&builder, (size_t)cJSON_GetArraySize(array)))
+    {
+        goto end;
+    }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsTrue(const cJSON * const item)
-{
-    if (item == NULL)
+    /* the numbers of packed arrays are records without any members */
+    while ((array->type & cJSON_IsPacked) && (builder.count < (size_t)array->valueint))
     {
-        return false;
+        if (!begin_record(&builder) || !end_record(&builder))
+        {
+            goto end;
+        }
     }
 
-    return (item->type & 0xff) == cJSON_True;
-}
+    for (record = array->child; record != NULL; record = record->next)
+    {
+        const cJSON *member = NULL;
 
+        if (!begin_record(&builder))
+        {
+            goto end;
+        }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsBool(const cJSON * const item)
-{
-    if (item == NULL)
-    {
-        return false;
+        if (cJSON_IsObject(record))
+        {
+            for (member = record->child; member != NULL; member = member->next)
+            {
+                size_t index = 0;
+
+                if (member->string == NULL)
+                {
+                    continue;
+                }
+                index = find_column(&builder, (const unsigned char*)member->string, strlen(member->string));
+                if ((index < builder.column_count) && !set_column_value(&builder, index, member))
+                {
+                    goto end;
+                }
+            }
+        }
+
+        if (!end_record(&builder))
+        {
+            goto end;
+        }
     }
+    success = true;
 
-    return (item->type & (cJSON_True | cJSON_False)) != 0;
+end:
+    return end_columns(&builder, success, record_count);
 }
-CJSON_PUBLIC(cJSON_bool) cJSON_IsNull(const cJSON * const item)
+
+/* Read a "name": value pair of a record (starting at the '{' or ',' in front of it) into the columns.
+ * Values of other members are only validated. */
+static cJSON_bool extract_member_columns(column_builder * const builder, parse_buffer * const input_buffer)
 {
-    if (item == NULL)
+    const unsigned char *name = NULL;
+    size_t name_length = 0;
+    size_t index = 0;
+    cJSON value[1];
+    cJSON_bool success = false;
+
+    if (cannot_access_at_index(input_buffer, 1))
     {
-        return false;
+        return false; /* nothing comes after the comma */
     }
 
-    return (item->type & 0xFF) == cJSON_NULL;
-}
-
-CJSON_PUBLIC(cJSON_bool) cJSON_IsNumber(const cJSON * const item)
-{
-    if (item == NULL)
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    name = buffer_at_offset(input_buffer) + 1;
+    if (!skip_string(input_buffer))
     {
-        return false;
+        return false; /* failed to parse name */
     }
+    name_length = (size_t)(buffer_at_offset(input_buffer) - name) - 1;
 
-    return (item->type & 0xFF) == cJSON_Number;
-}
+    memset(value, '\0', sizeof(value));
+    if (memchr(name, '\\', name_length) != NULL)
+    {
+        /* compare the unescaped name */
+        input_buffer->offset = (size_t)(name - input_buffer->content) - 1;
+        if (!parse_string(value, input_buffer))
+        {
+            return false;
+        }
+        index = find_column(builder, (const unsigned char*)value->valuestring, strlen(value->valuestring));
+        input_buffer->hooks.deallocate(value->valuestring);
+        value->valuestring = NULL;
+    }
+    else
+    {
+        index = find_column(builder, name, name_length);
+    }
+    buffer_skip_whitespace(input_buffer);
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsString(const cJSON * const item)
-{
-    if (item == NULL)
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
     {
-        return false;
+        return false; /* invalid object */
     }
 
-    return (item->type & 0xFF) == cJSON_String;
-}
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
-{
-    if (item == NULL)
+    /* arrays and objects never match a column, so they don't need to be built either */
+    if ((index == builder->column_count) || builder->states[index].seen
+        || (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '[') || (buffer_at_offset(input_buffer)[0] == '{'))))
     {
-        return false;
+        if (index < builder->column_count)
+        {
+            builder->states[index].seen = true;
+        }
+        success = skip_value(input_buffer);
+    }
+    else
+    {
+        success = parse_value(value, input_buffer) && set_column_value(builder, index, value);
+        if (value->valuestring != NULL)
+        {
+            input_buffer->hooks.deallocate(value->valuestring);
+        }
     }
+    buffer_skip_whitespace(input_buffer);
 
-    return (item->type & 0xFF) == cJSON_Array;
+    return success;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
+/* Read an object of the array (starting at the '{') into the columns. */
+static cJSON_bool extract_record_columns(column_builder * const builder, parse_buffer * const input_buffer)
 {
-    if (item == NULL)
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
     {
+        input_buffer->offset--;
         return false;
     }
 
-    return (item->type & 0xFF) == cJSON_Object;
-}
+    /* step back to character in front of the first member */
+    input_buffer->offset--;
+    do
+    {
+        if (!extract_member_columns(builder, input_buffer))
+        {
+            return false;
+        }
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
-{
-    if (item == NULL)
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
     {
-        return false;
+        return false; /* expected end of object */
     }
 
-    return (item->type & 0xFF) == cJSON_Raw;
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return true;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+static cJSON_bool extract_array_columns(column_builder * const builder, parse_buffer * const input_buffer)
 {
-    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '['))
     {
-        return false;
+        return false; /* not an array */
     }
+    input_buffer->depth++;
 
-    /* check if type is valid */
-    switch (a->type & 0xFF)
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
     {
-        case cJSON_False:
-        case cJSON_True:
-        case cJSON_NULL:
-        case cJSON_Number:
-        case cJSON_String:
-        case cJSON_Raw:
-        case cJSON_Array:
-        case cJSON_Object:
-            break;
-
-        default:
-            return false;
+        return true; /* empty array */
     }
 
-    /* identical objects are equal */
-    if (a == b)
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
     {
-        return true;
+        return false;
     }
 
-    switch (a->type & 0xFF)
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
     {
-        /* in these cases and equal type is enough */
-        case cJSON_False:
-        case cJSON_True:
-        case cJSON_NULL:
-            return true;
-
-        case cJSON_Number:
-            if (compare_double(a->valuedouble, b->valuedouble))
-            {
-                return true;
-            }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!begin_record(builder))
+        {
             return false;
+        }
 
-        case cJSON_String:
-        case cJSON_Raw:
-            if ((a->valuestring == NULL) || (b->valuestring == NULL))
+        if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+        {
+            if (!extract_record_columns(builder, input_buffer))
             {
                 return false;
             }
-            if (strcmp(a->valuestring, b->valuestring) == 0)
-            {
-                return true;
-            }
-
+        }
+        else if (!skip_value(input_buffer))
+        {
             return false;
+        }
 
-        case cJSON_Array:
+        if (!end_record(builder))
         {
-            cJSON *a_element = a->child;
-            cJSON *b_element = b->child;
-
-            for (; (a_element != NULL) && (b_element != NULL);)
-            {
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
+            return false;
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
 
-                a_element = a_element->next;
-                b_element = b_element->next;
-            }
+    return can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']');
+}
 
-            /* one of the arrays is longer than the other */
-            if (a_element != b_element) {
-                return false;
-            }
+CJSON_PUBLIC(cJSON_bool) cJSON_ExtractColumnsFromText(const char *value, size_t buffer_length, cJSON_Column *columns, int column_count, size_t *record_count)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+    column_builder builder;
 
-            return true;
-        }
+    if ((value == NULL) || (buffer_length == 0) || (record_count == NULL) || !begin_columns(&builder, columns, column_count))
+    {
+        return false;
+    }
 
-        case cJSON_Object:
-        {
-            cJSON *a_element = NULL;
-            cJSON *b_element = NULL;
-            cJSON_ArrayForEach(a_element, a)
-            {
-                /* TODO This has O(n^2) runtime, which is horrible! */
-                b_element = get_object_item(b, a_element->string, case_sensitive);
-                if (b_element == NULL)
-                {
-                    return false;
-                }
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
 
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
-            }
+    return end_columns(&builder, extract_array_columns(&builder, buffer_skip_whitespace(skip_utf8_bom(&buffer))), record_count);
+}
 
-            /* doing this twice, once on a and b to prevent true comparison if a subset of b
-             * TODO: Do this the proper way, this is just a fix for now */
-            cJSON_ArrayForEach(b_element, b)
-            {
-                a_element = get_object_item(a, b_element->string, case_sensitive);
-                if (a_element == NULL)
-                {
-                    return false;
-                }
+CJSON_PUBLIC(void) cJSON_FreeColumns(cJSON_Column *columns, int column_count)
+{
+    int i = 0;
 
-                if (!cJSON_Compare(b_element, a_element, case_sensitive))
-                {
-                    return false;
-                }
-            }
+    if (columns == NULL)
+    {
+        return;
+    }
 
-            return true;
+    for (i = 0; i < column_count; i++)
+    {
+        if (columns[i].numbers != NULL)
+        {
+            global_hooks.deallocate(columns[i].numbers);
+            columns[i].numbers = NULL;
+        }
+        if (columns[i].string_offsets != NULL)
+        {
+            global_hooks.deallocate(columns[i].string_offsets);
+            columns[i].string_offsets = NULL;
+        }
+        if (columns[i].strings != NULL)
+        {
+            global_hooks.deallocate(columns[i].strings);
+            columns[i].strings = NULL;
+        }
+        if (columns[i].nulls != NULL)
+        {
+            global_hooks.deallocate(columns[i].nulls);
+            columns[i].nulls = NULL;
         }
-
-        default:
-            return false;
     }
 }
 
@@ -98,6 +98,7 @@ scode-server#define CJSON_PUBLIC(type)   type CJSON_STDCALL
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_IsPacked 1024 /* array of numbers stored as doubles in valuestring, valueint is the count */
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -111,7 +112,9 @@ typedef struct cJSON
     /* The type of the item, as above. */
     int type;
 
-    /* The item's string, if type==cJSON_String  and type == cJSON_Raw */
+    /* The item's string, if type==cJSON_String  and type == cJSON_Raw
+     * (also the text of numbers, see cJSON_GetInt64Value and cJSON_ParseWithNumberText, which is used instead of
+     * valuedouble until the number is changed with cJSON_SetNumberValue or cJSON_SetIntValue) */
     char *valuestring;
     /* writing to valueint is DEPRECATED, use cJSON_SetNumberValue instead */
     int valueint;
@@ -131,12 +134,40 @@ typedef struct cJSON_Hooks
 
 typedef int cJSON_bool;
 
+/* Integers with at least 64 bits, for values that don't fit into valueint. */
+#if defined(_MSC_VER)
+typedef __int64 cJSON_int64;
+typedef unsigned __int64 cJSON_uint64;
+#elif defined(__GNUC__)
+__extension__ typedef long long cJSON_int64;
+__extension__ typedef unsigned long long cJSON_uint64;
+#else
+typedef long long cJSON_int64;
+typedef unsigned long long cJSON_uint64;
+#endif
+
+/* A set of interned object keys, see cJSON_CreateKeyTable */
+typedef struct cJSON_KeyTable cJSON_KeyTable;
+
+/* An item inside of a snapshot, see cJSON_OpenSnapshot */
+typedef struct cJSON_SnapshotItem cJSON_SnapshotItem;
+
+/* Receives consecutive chunks of the output of cJSON_PrintToWriter. Return 0 to abort printing. */
+typedef cJSON_bool (CJSON_CDECL *cJSON_WriteCallback)(const char *data, size_t length, void *user_data);
+/* Prints several items and pieces of text to one cJSON_WriteCallback through the same buffer, see cJSON_CreateWriter */
+typedef struct cJSON_Writer cJSON_Writer;
+
 /* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_NESTING_LIMIT
 #define CJSON_NESTING_LIMIT 1000
 #endif
 
+/* The MessagePack extension type used for cJSON_Raw items (JSON text) */
+#ifndef CJSON_MSGPACK_RAW_EXTENSION
+#define CJSON_MSGPACK_RAW_EXTENSION 74
+#endif
+
 /* Limits the length of circular references can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_CIRCULAR_LIMIT
@@ -157,6 +188,41 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* Parse one big top level array on several threads: cJSON_SplitArray scans the text once and stores the offsets of up to
+ * max_chunks chunks of about the same size in chunk_starts, every chunk but the first starts after a comma between two elements.
+ * It returns the number of chunks (0 for invalid arguments). Each chunk can then be parsed on its own thread with
+ * cJSON_ParseArrayChunk, and the results are joined in order with cJSON_AppendArrayChunk. */
+CJSON_PUBLIC(int) cJSON_SplitArray(const char *value, size_t buffer_length, size_t *chunk_starts, int max_chunks);
+/* Parse chunk number chunk into an array with its elements. cJSON_GetErrorPtr isn't changed, so chunks can be parsed concurrently
+ * (but not while cJSON_InitHooks is called). If chunks fail, return_parse_end of the first one that failed is the same as with cJSON_ParseWithLengthOpts.
+ * If the text is valid JSON but not an array, the first chunk fails and return_parse_end points to the start of the value. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseArrayChunk(const char *value, size_t buffer_length, const size_t *chunk_starts, int chunk_count, int chunk, const char **return_parse_end);
+/* Move the elements of chunk to the end of array without walking them and delete chunk. */
+CJSON_PUBLIC(cJSON_bool) cJSON_AppendArrayChunk(cJSON *array, cJSON *chunk);
+/* Only build the members of the top level object whose names (case sensitive) are listed in members, in document order.
+ * All other members are still validated exactly like cJSON_ParseWithLengthOpts would, but nothing is allocated for them.
+ * If the JSON isn't an object, it is parsed completely. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseMembers(const char *value, size_t buffer_length, const char * const *members, int member_count, const char **return_parse_end);
+/* A key table stores every distinct object key once, for documents that repeat the same keys in many objects.
+ * Keys parsed with a table point into it and are flagged cJSON_StringIsConst, so the table has to outlive every tree
+ * (and every duplicate of one) parsed with it. A table must not be used by multiple threads at the same time. */
+CJSON_PUBLIC(cJSON_KeyTable *) cJSON_CreateKeyTable(void);
+CJSON_PUBLIC(void) cJSON_DeleteKeyTable(cJSON_KeyTable *table);
+/* Returns the copy of key in the table, adding it if necessary. Case sensitive lookups with it only compare pointers for matching keys. */
+CJSON_PUBLIC(const char *) cJSON_InternKey(cJSON_KeyTable *table, const char *key);
+/* Like cJSON_ParseWithLengthOpts, but object keys are stored in keys (if it isn't NULL). */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithKeyTable(const char *value, size_t buffer_length, cJSON_KeyTable *keys, const char **return_parse_end);
+/* Like cJSON_ParseWithLengthOpts, but non-empty arrays that only contain numbers become packed arrays (see cJSON_PackArray). */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithPackedArrays(const char *value, size_t buffer_length, const char **return_parse_end);
+/* Like cJSON_ParseWithLengthOpts, but every number keeps its text in valuestring and is printed from it (e.g. 1.50 stays 1.50)
+ * until its value is changed with cJSON_SetNumberValue (writing to valuedouble directly leaves the old text in place).
+ * valuedouble is still set while parsing, this costs an allocation per number. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithNumberText(const char *value, size_t buffer_length, const char **return_parse_end);
+/* Like cJSON_ParseWithLengthOpts, but the values of the listed top level members (case sensitive) are only validated
+ * and stored as cJSON_Raw items with their text, which is printed back unchanged. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithRawMembers(const char *value, size_t buffer_length, const char * const *members, int member_count, const char **return_parse_end);
+/* Same for all arrays and objects nested at least depth levels deep (1 for the values in the top level array or object). */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithRawDepth(const char *value, size_t buffer_length, int depth, const char **return_parse_end);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
@@ -167,6 +233,80 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Render a cJSON entity to text and hand it to write_fn in chunks instead of building one string.
+ * The concatenated chunks are identical to the output of cJSON_Print (format=1) or cJSON_PrintUnformatted (format=0).
+ * Only a small buffer is allocated (it only grows if a single string or number doesn't fit).
+ * Returns 1 on success and 0 if printing or one of the calls to write_fn failed. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToWriter(const cJSON *item, const cJSON_bool format, cJSON_WriteCallback write_fn, void *user_data);
+/* Like cJSON_PrintToWriter, but for output that is put together from several items and text (e.g. separators).
+ * Everything written goes through one buffer, which is flushed to write_fn when it runs full and by cJSON_CloseWriter.
+ * After a failed write all further writes fail. cJSON_CloseWriter frees the writer and returns 1 if all writes succeeded. */
+CJSON_PUBLIC(cJSON_Writer *) cJSON_CreateWriter(const cJSON_bool format, cJSON_WriteCallback write_fn, void *user_data);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteItem(cJSON_Writer *writer, const cJSON *item);
+/* Writes text as is, without escaping it. */
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteText(cJSON_Writer *writer, const char *text, size_t length);
+CJSON_PUBLIC(cJSON_bool) cJSON_CloseWriter(cJSON_Writer *writer);
+/* Encode a cJSON entity as CBOR (RFC 8949) and store the size of the encoding in length.
+ * Integers up to 2^53 are encoded as integers, other numbers as float or double. cJSON_Raw is encoded as tag 262 (embedded JSON).
+ * The result is allocated with the hooks and has to be freed with cJSON_free. Returns NULL on failure. */
+CJSON_PUBLIC(unsigned char *) cJSON_PrintCBOR(const cJSON *item, size_t *length);
+/* Decode one CBOR data item. Byte strings and map keys that aren't text strings are rejected, other tags than 262 are ignored.
+ * Without return_parse_end the item has to fill the whole buffer, otherwise it receives the end of the item or the error position. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseCBOR(const unsigned char *value, size_t buffer_length, const unsigned char **return_parse_end);
+/* Encode a cJSON entity as MessagePack and store the size of the encoding in length.
+ * Integers up to 2^53 use the smallest integer format, other numbers float32 or float64.
+ * cJSON_Raw is encoded as an extension of type CJSON_MSGPACK_RAW_EXTENSION.
+ * The result is allocated with the hooks and has to be freed with cJSON_free. Returns NULL on failure. */
+CJSON_PUBLIC(unsigned char *) cJSON_PrintMessagePack(const cJSON *item, size_t *length);
+/* Encode a cJSON entity as MessagePack and hand it to write_fn in chunks. Returns 1 on success. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintMessagePackToWriter(const cJSON *item, cJSON_WriteCallback write_fn, void *user_data);
+/* Decode one MessagePack object. str and bin both become strings, keys have to be one of them.
+ * Extensions other than CJSON_MSGPACK_RAW_EXTENSION are rejected. return_parse_end works like in cJSON_ParseCBOR. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseMessagePack(const unsigned char *value, size_t buffer_length, const unsigned char **return_parse_end);
+
+/* Snapshots are a versioned binary image of a tree that can be read in place (e.g. from a mapped file) without parsing.
+ * Nodes refer to their children and strings with relative offsets, so a snapshot can be loaded at any address. */
+/* Create a snapshot of item and store its size in length. Free the result with cJSON_free. Returns NULL on failure,
+ * which includes trees with packed arrays in them (unpack them with cJSON_UnpackArray first). */
+CJSON_PUBLIC(unsigned char *) cJSON_CreateSnapshot(const cJSON *item, size_t *length);
+/* Returns the root item of a snapshot or NULL if the header doesn't match. With verify, the checksum and every offset
+ * are checked as well, this reads the whole snapshot but doesn't allocate. Only skip it for snapshots you created yourself. */
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_OpenSnapshot(const void *snapshot, size_t length, cJSON_bool verify);
+/* Read only accessors, they work like their counterparts for cJSON items. Object lookups are case sensitive. */
+CJSON_PUBLIC(int) cJSON_SnapshotGetType(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(int) cJSON_SnapshotGetSize(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetArrayItem(const cJSON_SnapshotItem *array, int index);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItem(const cJSON_SnapshotItem *object, const char *name);
+CJSON_PUBLIC(const char *) cJSON_SnapshotGetKey(const cJSON_SnapshotItem *item);
+/* the value of a string or raw item */
+CJSON_PUBLIC(const char *) cJSON_SnapshotGetString(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(double) cJSON_SnapshotGetNumber(const cJSON_SnapshotItem *item);
+/* Build a mutable copy of a snapshot item and everything below it. */
+CJSON_PUBLIC(cJSON *) cJSON_SnapshotToTree(const cJSON_SnapshotItem *item);
+
+/* Columnar extraction copies the members of an array of similar objects (records) into one buffer per member.
+ * Fill in name (compared case sensitively) and type of each column, the buffers are allocated by the extraction. */
+typedef struct cJSON_Column
+{
+    const char *name;
+    /* cJSON_Number, cJSON_String or cJSON_True for booleans */
+    int type;
+    /* number and boolean columns: the value of every record, booleans are 1 or 0 and nulls are 0 */
+    double *numbers;
+    /* string columns: the string of record i starts at strings + string_offsets[i], the offset after the last record
+     * is the size of strings. Every string is null terminated, nulls are empty strings. */
+    size_t *string_offsets;
+    char *strings;
+    /* bit (i % 8) of nulls[i / 8] is set if record i is no object, misses the member or the value has another type */
+    unsigned char *nulls;
+} cJSON_Column;
+/* Fill the columns from the elements of array in one pass and store the number of records in record_count.
+ * Only the first member with a column's name counts. On failure the columns don't hold any buffers. */
+CJSON_PUBLIC(cJSON_bool) cJSON_ExtractColumns(const cJSON *array, cJSON_Column *columns, int column_count, size_t *record_count);
+/* Same as cJSON_ExtractColumns, but for an array in text form. No tree is built, other members are only validated. */
+CJSON_PUBLIC(cJSON_bool) cJSON_ExtractColumnsFromText(const char *value, size_t buffer_length, cJSON_Column *columns, int column_count, size_t *record_count);
+/* Free the buffers of the columns. */
+CJSON_PUBLIC(void) cJSON_FreeColumns(cJSON_Column *columns, int column_count);
 
 /* 新增：美化打印函数，可自定义缩进 */
 CJSON_PUBLIC(char *) cJSON_PrintPretty(const cJSON *item, int indent_count, char indent_char);
@@ -175,7 +315,14 @@ CJSON_PUBLIC(char *) cJSON_PrintPretty(const cJSON *item, int indent_count, char
 CJSON_PUBLIC(char *) cJSON_PrintPrettyBuffered(const cJSON *item, int prebuffer, int indent_count, char indent_char);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
-
+/* Delete at most max_items items of a cJSON entity and its subentities. Returns what is left to be deleted
+ * (NULL once everything has been freed), pass it to the next call. This allows spreading the cost of deleting
+ * huge trees over time, e.g. a few thousand items per iteration of an event loop.
+ * The returned chain is only meant to be passed back to cJSON_DeleteIncremental or cJSON_Delete. */
+CJSON_PUBLIC(cJSON *) cJSON_DeleteIncremental(cJSON *item, size_t max_items);
+
+/* The lookup functions below never modify the tree, so they can be called concurrently from multiple threads
+ * on the same tree as long as no thread modifies it at the same time. */
 /* Returns the number of items in an array (or object). */
 CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array);
 /* Retrieve item number "index" from array "array". Returns NULL if unsuccessful. */
@@ -190,6 +337,10 @@ CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
 /* Check item type and return its value */
 CJSON_PUBLIC(char *) cJSON_GetStringValue(const cJSON * const item);
 CJSON_PUBLIC(double) cJSON_GetNumberValue(const cJSON * const item);
+/* Integers beyond +-2^53 that fit into 64 bits keep their exact digits in valuestring, these return them exactly
+ * (change such numbers with cJSON_SetNumberValue, which drops the digits, not by writing to valuedouble). Other numbers are truncated towards zero, both saturate at their limits and return 0 for anything but numbers. */
+CJSON_PUBLIC(cJSON_int64) cJSON_GetInt64Value(const cJSON * const item);
+CJSON_PUBLIC(cJSON_uint64) cJSON_GetUInt64Value(const cJSON * const item);
 
 /* These functions check the type of an item */
 CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item);
@@ -209,6 +360,9 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void);
 CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void);
 CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean);
 CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num);
+/* Numbers that keep the exact value of 64 bit integers, valuedouble is the closest double. */
+CJSON_PUBLIC(cJSON *) cJSON_CreateInt64(cJSON_int64 number);
+CJSON_PUBLIC(cJSON *) cJSON_CreateUInt64(cJSON_uint64 number);
 CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string);
 /* raw json */
 CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw);
@@ -229,6 +383,24 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count);
+/* These utilities copy the first count elements of an array into a buffer of the caller. They return the number of
+ * elements copied (less than count for shorter arrays) or -1 if array isn't an array or an element has the wrong type. */
+CJSON_PUBLIC(int) cJSON_GetDoubleArray(const cJSON *array, double *numbers, int count);
+/* Values are truncated towards zero and saturated at the limits of cJSON_int64. */
+CJSON_PUBLIC(int) cJSON_GetInt64Array(const cJSON *array, cJSON_int64 *numbers, int count);
+/* The strings are not copied, they belong to the array. */
+CJSON_PUBLIC(int) cJSON_GetStringArray(const cJSON *array, const char **strings, int count);
+/* A packed array stores its numbers in one buffer instead of an item for each of them. Printing, cJSON_GetArraySize,
+ * cJSON_Duplicate, cJSON_Compare, the array extractors and cJSON_Utils handle them like other arrays, functions that
+ * add, detach or replace array items unpack them first. Everything else, including cJSON_GetArrayItem and
+ * cJSON_ArrayForEach, only sees the elements after cJSON_UnpackArray. cJSON_CreateSnapshot fails on packed arrays. */
+/* Pack an array that only contains numbers. Returns 1 on success (or if it is packed already). Like the parser, it
+ * doesn't pack integers that keep their exact digits because a double can't hold them. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PackArray(cJSON *array);
+/* Create an item for every number of a packed array. Returns 1 on success (or if it isn't packed).
+ * References to packed arrays can't be unpacked (their numbers belong to the referenced array), so adding, detaching
+ * or replacing their elements fails. */
+CJSON_PUBLIC(cJSON_bool) cJSON_UnpackArray(cJSON *array);
 
 /* Append item to the specified array/object. */
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item);
@@ -283,8 +455,8 @@ CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * con
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name);
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name);
 
-/* When assigning an integer value, it needs to be propagated to valuedouble too. */
-#define cJSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
+/* When assigning an integer value, it needs to be propagated to valuedouble too (and the text of the number dropped). */
+#define cJSON_SetIntValue(object, number) ((object) ? ((void)cJSON_SetNumberHelper(object, (double)(number)), (object)->valueint) : (number))
 /* helper for the cJSON_SetNumberValue macro */
 CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number);
 #define cJSON_SetNumberValue(object, number) ((object != NULL) ? cJSON_SetNumberHelper(object, (double)number) : (number))
@@ -108,14 +108,6 @@ static int compare_strings(const unsigned char *string1, const unsigned char *st
     return tolower(*string1) - tolower(*string2);
 }
 
-/* securely comparison of floating-point variables */
-static cJSON_bool compare_double(double a, double b)
-{
-    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
-    return (fabs(a - b) <= maxVal * DBL_EPSILON);
-}
-
-
 /* Compare the next path element of two JSON pointers, two NULL pointers are considered unequal: */
 static cJSON_bool compare_pointers(const unsigned char *name, const unsigned char *pointer, const cJSON_bool case_sensitive)
 {
@@ -258,251 +250,1200 @@ CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const obje
     return NULL;
 }
 
-/* non broken version of cJSON_GetArrayItem */
-static cJSON *get_array_item(const cJSON *array, size_t item)
+/* An index from every item of a tree to its parent and its position in the parent,
+ * kept in an open addressing hash table keyed by the address of the item. */
+typedef struct
 {
-    cJSON *child = array ? array->child : NULL;
-    while ((child != NULL) && (item > 0))
-    {
-        item--;
-        child = child->next;
-    }
+    const cJSON *item;
+    const cJSON *parent;
+    size_t position;
+} pointer_index_entry;
 
-    return child;
+struct cJSONUtils_PointerIndex
+{
+    const cJSON *root;
+    pointer_index_entry *entries;
+    size_t capacity; /* always a power of two */
+    size_t count;
+};
+
+static size_t hash_item_address(const cJSON * const item)
+{
+    size_t address = (size_t)(const void*)item;
+    /* the lower bits are always zero because of alignment */
+    return (address >> 4) ^ (address >> 12);
 }
 
-static cJSON_bool decode_array_index_from_pointer(const unsigned char * const pointer, size_t * const index)
+static pointer_index_entry *find_index_entry(pointer_index_entry * const entries, const size_t capacity, const cJSON * const item)
 {
-    size_t parsed_index = 0;
-    size_t position = 0;
+    size_t slot = hash_item_address(item) & (capacity - 1);
 
-    if ((pointer[0] == '0') && ((pointer[1] != '\0') && (pointer[1] != '/')))
+    while ((entries[slot].item != NULL) && (entries[slot].item != item))
     {
-        /* leading zeroes are not permitted */
-        return 0;
+        slot = (slot + 1) & (capacity - 1);
     }
 
-    for (position = 0; (pointer[position] >= '0') && (pointer[position] <= '9'); position++)
+    return entries + slot;
+}
+
+static cJSON_bool add_index_entry(cJSONUtils_PointerIndex * const index, const cJSON * const item, const cJSON * const parent, const size_t position)
+{
+    pointer_index_entry *entry = NULL;
+
+    /* keep the load factor below one half */
+    if (((index->count + 1) * 2) > index->capacity)
     {
-        parsed_index = (10 * parsed_index) + (size_t)(pointer[position] - '0');
+        size_t new_capacity = index->capacity * 2;
+        pointer_index_entry *new_entries = NULL;
+        size_t slot = 0;
+
+        new_entries = (pointer_index_entry*)cJSON_malloc(new_capacity * sizeof(pointer_index_entry));
+        if (new_entries == NULL)
+        {
+            return false;
+        }
+        memset(new_entries, '\0', new_capacity * sizeof(pointer_index_entry));
+
+        for (slot = 0; slot < index->capacity; slot++)
+        {
+            if (index->entries[slot].item != NULL)
+            {
+                *find_index_entry(new_entries, new_capacity, index->entries[slot].item) = index->entries[slot];
+            }
+        }
 
+        cJSON_free(index->entries);
+        index->entries = new_entries;
+        index->capacity = new_capacity;
     }
 
-    if ((pointer[position] != '\0') && (pointer[position] != '/'))
+    entry = find_index_entry(index->entries, index->capacity, item);
+    if (entry->item == NULL)
     {
-        return 0;
+        index->count++;
     }
+    entry->item = item;
+    entry->parent = parent;
+    entry->position = position;
 
-    *index = parsed_index;
-
-    return 1;
+    return true;
 }
 
-static cJSON *get_item_from_pointer(cJSON * const object, const char * pointer, const cJSON_bool case_sensitive)
+CJSON_PUBLIC(cJSONUtils_PointerIndex *) cJSONUtils_CreatePointerIndex(const cJSON * const object)
 {
-    cJSON *current_element = object;
+    cJSONUtils_PointerIndex *index = NULL;
+    const cJSON *current = object;
+    size_t position = 0;
 
-    if (pointer == NULL)
+    if (object == NULL)
     {
         return NULL;
     }
 
-    /* follow path of the pointer */
-    while ((pointer[0] == '/') && (current_element != NULL))
+    index = (cJSONUtils_PointerIndex*)cJSON_malloc(sizeof(cJSONUtils_PointerIndex));
+    if (index == NULL)
     {
-        pointer++;
-        if (cJSON_IsArray(current_element))
+        return NULL;
+    }
+    index->root = object;
+    index->count = 0;
+    index->capacity = 64;
+    index->entries = (pointer_index_entry*)cJSON_malloc(index->capacity * sizeof(pointer_index_entry));
+    if (index->entries == NULL)
+    {
+        cJSON_free(index);
+        return NULL;
+    }
+    memset(index->entries, '\0', index->capacity * sizeof(pointer_index_entry));
+
+    if (!add_index_entry(index, object, NULL, 0))
+    {
+        goto fail;
+    }
+
+    /* walk the tree without recursion, the index itself is used to climb back up */
+    while (current != NULL)
+    {
+        if (current->child != NULL)
         {
-            size_t index = 0;
-            if (!decode_array_index_from_pointer((const unsigned char*)pointer, &index))
+            if (!add_index_entry(index, current->child, current, 0))
             {
-                return NULL;
+                goto fail;
             }
-
-            current_element = get_array_item(current_element, index);
+            current = current->child;
+            continue;
         }
-        else if (cJSON_IsObject(current_element))
+
+        while ((current != object) && (current->next == NULL))
         {
-            current_element = current_element->child;
-            /* GetObjectItem. */
-            while ((current_element != NULL) && !compare_pointers((unsigned char*)current_element->string, (const unsigned char*)pointer, case_sensitive))
-            {
-                current_element = current_element->next;
-            }
+            current = find_index_entry(index->entries, index->capacity, current)->parent;
         }
-        else
+        if (current == object)
         {
-            return NULL;
+            break;
         }
 
-        /* skip to the next path token or end of string */
-        while ((pointer[0] != '\0') && (pointer[0] != '/'))
+        position = find_index_entry(index->entries, index->capacity, current)->position + 1;
+        if (!add_index_entry(index, current->next, find_index_entry(index->entries, index->capacity, current)->parent, position))
         {
-            pointer++;
+            goto fail;
         }
+        current = current->next;
     }
 
-    return current_element;
+    return index;
+
+fail:
+    cJSONUtils_DeletePointerIndex(index);
+
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointer(cJSON * const object, const char *pointer)
+CJSON_PUBLIC(void) cJSONUtils_DeletePointerIndex(cJSONUtils_PointerIndex * const index)
 {
-    return get_item_from_pointer(object, pointer, false);
+    if (index == NULL)
+    {
+        return;
+    }
+
+    cJSON_free(index->entries);
+    cJSON_free(index);
 }
 
-CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, const char *pointer)
+/* number of decimal digits of an array index */
+static size_t index_length(size_t index)
 {
-    return get_item_from_pointer(object, pointer, true);
+    size_t length = 1;
+    for (; index >= 10; index /= 10)
+    {
+        length++;
+    }
+
+    return length;
 }
 
-/* JSON Patch implementation. */
-static void decode_pointer_inplace(unsigned char *string)
+CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromIndex(const cJSONUtils_PointerIndex * const index, const cJSON * const target)
 {
-    unsigned char *decoded_string = string;
+    const pointer_index_entry *entry = NULL;
+    unsigned char *pointer = NULL;
+    size_t length = 0;
 
-    if (string == NULL) {
-        return;
+    if ((index == NULL) || (target == NULL))
+    {
+        return NULL;
     }
 
-    for (; *string; (void)decoded_string++, string++)
+    /* first pass: calculate the length of the pointer */
+    for (entry = find_index_entry(index->entries, index->capacity, target); (entry->item != NULL) && (entry->parent != NULL); entry = find_index_entry(index->entries, index->capacity, entry->parent))
     {
-        if (string[0] == '~')
+        if (cJSON_IsArray(entry->parent))
         {
-            if (string[1] == '0')
-            {
-                decoded_string[0] = '~';
-            }
-            else if (string[1] == '1')
+            length += sizeof("/") - 1 + index_length(entry->position);
+        }
+        else if (cJSON_IsObject(entry->parent) && (entry->item->string != NULL))
+        {
+            length += sizeof("/") - 1 + pointer_encoded_length((const unsigned char*)entry->item->string);
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    if (entry->item == NULL)
+    {
+        /* target isn't part of the indexed tree */
+        return NULL;
+    }
+
+    pointer = (unsigned char*)cJSON_malloc(length + sizeof(""));
+    if (pointer == NULL)
+    {
+        return NULL;
+    }
+    pointer[length] = '\0';
+
+    /* second pass: fill in the tokens from the end */
+    for (entry = find_index_entry(index->entries, index->capacity, target); entry->parent != NULL; entry = find_index_entry(index->entries, index->capacity, entry->parent))
+    {
+        if (cJSON_IsArray(entry->parent))
+        {
+            size_t position = entry->position;
+            do
             {
-                decoded_string[1] = '/';
-            }
-            else
+                pointer[--length] = (unsigned char)('0' + (position % 10));
+                position /= 10;
+            } while (position > 0);
+        }
+        else
+        {
+            const unsigned char *key = (const unsigned char*)entry->item->string;
+            size_t position = 0;
+
+            length -= pointer_encoded_length(key);
+            for (position = length; *key != '\0'; key++)
             {
-                /* invalid escape sequence */
-                return;
+                if ((*key == '~') || (*key == '/'))
+                {
+                    pointer[position++] = '~';
+                    pointer[position++] = (*key == '~') ? '0' : '1';
+                }
+                else
+                {
+                    pointer[position++] = *key;
+                }
             }
-
-            string++;
         }
+        pointer[--length] = '/';
     }
 
-    decoded_string[0] = '\0';
+    return (char*)pointer;
 }
 
-/* non-broken cJSON_DetachItemFromArray */
-static cJSON *detach_item_from_array(cJSON *array, size_t which)
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_FindPointersFromObjectTo(const cJSON * const object, const cJSON * const * const targets, const size_t count, char ** const pointers)
 {
-    cJSON *c = array->child;
-    while (c && (which > 0))
-    {
-        c = c->next;
-        which--;
-    }
-    if (!c)
+    cJSONUtils_PointerIndex *index = NULL;
+    size_t i = 0;
+
+    if ((object == NULL) || (targets == NULL) || (pointers == NULL))
     {
-        /* item doesn't exist */
-        return NULL;
+        return false;
     }
-    if (c != array->child)
+
+    index = cJSONUtils_CreatePointerIndex(object);
+    if (index == NULL)
     {
-        /* not the first element */
-        c->prev->next = c->next;
+        return false;
     }
-    if (c->next)
+
+    for (i = 0; i < count; i++)
     {
-        c->next->prev = c->prev;
+        pointers[i] = cJSONUtils_FindPointerFromIndex(index, targets[i]);
     }
-    if (c == array->child)
+
+    cJSONUtils_DeletePointerIndex(index);
+
+    return true;
+}
+
+/* non broken version of cJSON_GetArrayItem, packed arrays are unpacked because their numbers have no items */
+static cJSON *get_array_item(cJSON *array, size_t item)
+{
+    cJSON *child = NULL;
+    if ((array == NULL) || ((array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array)))
     {
-        array->child = c->next;
+        return NULL;
     }
-    else if (c->next == NULL)
+
+    child = array->child;
+    while ((child != NULL) && (item > 0))
     {
-        array->child->prev = c->prev;
+        item--;
+        child = child->next;
     }
-    /* make sure the detached item doesn't point anywhere anymore */
-    c->prev = c->next = NULL;
 
-    return c;
+    return child;
 }
 
-/* detach an item at the given path */
-static cJSON *detach_path(cJSON *object, const unsigned char *path, const cJSON_bool case_sensitive)
+static cJSON_bool decode_array_index_from_pointer(const unsigned char * const pointer, size_t * const index)
 {
-    unsigned char *parent_pointer = NULL;
-    unsigned char *child_pointer = NULL;
-    cJSON *parent = NULL;
-    cJSON *detached_item = NULL;
+    size_t parsed_index = 0;
+    size_t position = 0;
 
-    /* copy path and split it in parent and child */
-    parent_pointer = cJSONUtils_strdup(path);
-    if (parent_pointer == NULL) {
-        goto cleanup;
+    if ((pointer[0] == '0') && ((pointer[1] != '\0') && (pointer[1] != '/')))
+    {
+        /* leading zeroes are not permitted */
+        return 0;
     }
 
-    child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/'); /* last '/' */
-    if (child_pointer == NULL)
+    for (position = 0; (pointer[position] >= '0') && (pointer[position] <= '9'); position++)
     {
-        goto cleanup;
+        parsed_index = (10 * parsed_index) + (size_t)(pointer[position] - '0');
+
     }
-    /* split strings */
-    child_pointer[0] = '\0';
-    child_pointer++;
 
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
-    decode_pointer_inplace(child_pointer);
+    if ((pointer[position] != '\0') && (pointer[position] != '/'))
+    {
+        return 0;
+    }
 
-    if (cJSON_IsArray(parent))
+    *index = parsed_index;
+
+    return 1;
+}
+
+/* resolve the path token that pointer points to (the part after a '/') relative to current_element */
+static cJSON *get_item_from_pointer_token(cJSON * const current_element, const char * const pointer, const cJSON_bool case_sensitive)
+{
+    cJSON *child = NULL;
+
+    if (cJSON_IsArray(current_element))
     {
         size_t index = 0;
-        if (!decode_array_index_from_pointer(child_pointer, &index))
+        if (!decode_array_index_from_pointer((const unsigned char*)pointer, &index))
         {
-            goto cleanup;
+            return NULL;
         }
-        detached_item = detach_item_from_array(parent, index);
-    }
-    else if (cJSON_IsObject(parent))
-    {
-        detached_item = cJSON_DetachItemFromObject(parent, (char*)child_pointer);
-    }
-    else
-    {
-        /* Couldn't find object to remove child from. */
-        goto cleanup;
+
+        return get_array_item(current_element, index);
     }
 
-cleanup:
-    if (parent_pointer != NULL)
+    if (cJSON_IsObject(current_element))
     {
-        cJSON_free(parent_pointer);
+        child = current_element->child;
+        /* GetObjectItem. */
+        while ((child != NULL) && !compare_pointers((unsigned char*)child->string, (const unsigned char*)pointer, case_sensitive))
+        {
+            child = child->next;
+        }
+
+        return child;
     }
 
-    return detached_item;
+    return NULL;
 }
 
-/* sort lists using mergesort */
-static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
+static cJSON *get_item_from_pointer(cJSON * const object, const char * pointer, const cJSON_bool case_sensitive)
 {
-    cJSON *first = list;
-    cJSON *second = list;
-    cJSON *current_item = list;
-    cJSON *result = list;
-    cJSON *result_tail = NULL;
+    cJSON *current_element = object;
 
-    if ((list == NULL) || (list->next == NULL))
+    if (pointer == NULL)
     {
-        /* One entry is sorted already. */
-        return result;
+        return NULL;
     }
 
-    while ((current_item != NULL) && (current_item->next != NULL) && (compare_strings((unsigned char*)current_item->string, (unsigned char*)current_item->next->string, case_sensitive) < 0))
-    {
-        /* Test for list sorted. */
-        current_item = current_item->next;
-    }
-    if ((current_item == NULL) || (current_item->next == NULL))
+    /* follow path of the pointer */
+    while ((pointer[0] == '/') && (current_element != NULL))
     {
-        /* Leave sorted lists unmodified. */
+        pointer++;
+        current_element = get_item_from_pointer_token(current_element, pointer, case_sensitive);
+
+        /* skip to the next path token or end of string */
+        while ((pointer[0] != '\0') && (pointer[0] != '/'))
+        {
+            pointer++;
+        }
+    }
+
+    return current_element;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointer(cJSON * const object, const char *pointer)
+{
+    return get_item_from_pointer(object, pointer, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, const char *pointer)
+{
+    return get_item_from_pointer(object, pointer, true);
+}
+
+/* A compiled JSON pointer: every path token is decoded once up front so that
+ * evaluating it doesn't have to re-scan the pointer string and its ~0/~1 escapes */
+typedef struct
+{
+    const unsigned char *name; /* decoded token, '\0' terminated */
+    size_t length;
+    size_t index; /* only valid if is_index is set */
+    cJSON_bool is_index;
+    cJSON_bool is_valid; /* false if the token contains an invalid escape sequence */
+} pointer_token;
+
+struct cJSONUtils_Pointer
+{
+    size_t token_count;
+    cJSON_bool case_sensitive;
+    pointer_token *tokens;
+};
+
+static cJSONUtils_Pointer *compile_pointer(const char * const pointer, const cJSON_bool case_sensitive)
+{
+    cJSONUtils_Pointer *compiled = NULL;
+    const unsigned char *position = (const unsigned char*)pointer;
+    unsigned char *names = NULL;
+    size_t token_count = 0;
+    size_t length = 0;
+
+    if (pointer == NULL)
+    {
+        return NULL;
+    }
+
+    /* count the tokens, everything after the first character that isn't part of a token is ignored, like in get_item_from_pointer */
+    for (; position[length] == '/'; token_count++)
+    {
+        length++;
+        while ((position[length] != '\0') && (position[length] != '/'))
+        {
+            length++;
+        }
+    }
+
+    /* tokens and decoded names share the allocation of the pointer itself */
+    compiled = (cJSONUtils_Pointer*)cJSON_malloc(sizeof(cJSONUtils_Pointer) + (token_count * sizeof(pointer_token)) + length + sizeof(""));
+    if (compiled == NULL)
+    {
+        return NULL;
+    }
+    compiled->token_count = token_count;
+    compiled->case_sensitive = case_sensitive;
+    compiled->tokens = (pointer_token*)(void*)(compiled + 1);
+    names = (unsigned char*)(compiled->tokens + token_count);
+
+    for (token_count = 0; token_count < compiled->token_count; token_count++)
+    {
+        pointer_token *token = &compiled->tokens[token_count];
+
+        position++; /* skip the '/' */
+        token->is_index = decode_array_index_from_pointer(position, &token->index);
+        token->is_valid = true;
+        token->name = names;
+        for (; (*position != '\0') && (*position != '/'); position++)
+        {
+            if (*position == '~')
+            {
+                if (position[1] == '0')
+                {
+                    *names = '~';
+                }
+                else if (position[1] == '1')
+                {
+                    *names = '/';
+                }
+                else
+                {
+                    /* invalid escape sequence, the token can't match any key */
+                    token->is_valid = false;
+                    break;
+                }
+                position++;
+            }
+            else
+            {
+                *names = *position;
+            }
+            names++;
+        }
+        /* skip the remainder of an invalid token */
+        while ((*position != '\0') && (*position != '/'))
+        {
+            position++;
+        }
+
+        token->length = (size_t)(names - token->name);
+        *names = '\0';
+        names++;
+    }
+
+    return compiled;
+}
+
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointer(const char * const pointer)
+{
+    return compile_pointer(pointer, false);
+}
+
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointerCaseSensitive(const char * const pointer)
+{
+    return compile_pointer(pointer, true);
+}
+
+CJSON_PUBLIC(void) cJSONUtils_DeletePointer(cJSONUtils_Pointer * const pointer)
+{
+    cJSON_free(pointer);
+}
+
+/* compare an object key to a decoded pointer token */
+static cJSON_bool compare_token(const unsigned char *name, const pointer_token * const token, const cJSON_bool case_sensitive)
+{
+    size_t position = 0;
+
+    if ((name == NULL) || !token->is_valid)
+    {
+        return false;
+    }
+
+    for (position = 0; position < token->length; position++)
+    {
+        if ((name[position] == '\0')
+            || (case_sensitive && (name[position] != token->name[position]))
+            || (!case_sensitive && (tolower(name[position]) != tolower(token->name[position]))))
+        {
+            return false;
+        }
+    }
+
+    return name[position] == '\0';
+}
+
+/* resolve a single token relative to current_element */
+static cJSON *get_item_from_token(cJSON * const current_element, const pointer_token * const token, const cJSON_bool case_sensitive)
+{
+    cJSON *child = NULL;
+
+    if (cJSON_IsArray(current_element))
+    {
+        if (!token->is_index)
+        {
+            return NULL;
+        }
+
+        return get_array_item(current_element, token->index);
+    }
+
+    if (cJSON_IsObject(current_element))
+    {
+        for (child = current_element->child; (child != NULL) && !compare_token((const unsigned char*)child->string, token, case_sensitive); child = child->next)
+        {
+            /* GetObjectItem. */
+        }
+
+        return child;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_EvalPointer(cJSON * const object, const cJSONUtils_Pointer * const pointer)
+{
+    cJSON *current_element = object;
+    size_t token = 0;
+
+    if (pointer == NULL)
+    {
+        return NULL;
+    }
+
+    for (token = 0; (token < pointer->token_count) && (current_element != NULL); token++)
+    {
+        current_element = get_item_from_token(current_element, &pointer->tokens[token], pointer->case_sensitive);
+    }
+
+    return current_element;
+}
+
+static cJSON_bool compare_tokens(const pointer_token * const a, const pointer_token * const b, const cJSON_bool case_sensitive)
+{
+    return (a->length == b->length) && (a->is_valid == b->is_valid) && (a->is_index == b->is_index)
+        && (!a->is_index || (a->index == b->index))
+        && (case_sensitive ? (memcmp(a->name, b->name, a->length) == 0) : (compare_strings(a->name, b->name, false) == 0));
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_EvalPointers(cJSON * const object, const cJSONUtils_Pointer * const * const pointers, const size_t count, cJSON ** const results)
+{
+    /* path[depth] is the element that the previous pointer resolved after depth tokens */
+    cJSON **path = NULL;
+    const cJSONUtils_Pointer *previous = NULL;
+    size_t max_depth = 0;
+    size_t resolved = 0; /* number of valid entries in path */
+    size_t i = 0;
+
+    if ((object == NULL) || (pointers == NULL) || (results == NULL))
+    {
+        return false;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (pointers[i] == NULL)
+        {
+            return false;
+        }
+        if (pointers[i]->token_count > max_depth)
+        {
+            max_depth = pointers[i]->token_count;
+        }
+    }
+
+    path = (cJSON**)cJSON_malloc((max_depth + 1) * sizeof(cJSON*));
+    if (path == NULL)
+    {
+        return false;
+    }
+    path[0] = object;
+
+    for (i = 0; i < count; i++)
+    {
+        const cJSONUtils_Pointer *pointer = pointers[i];
+        size_t depth = 0;
+
+        /* reuse the part of the walk that is shared with the previous pointer */
+        if ((previous != NULL) && (previous->case_sensitive == pointer->case_sensitive))
+        {
+            while ((depth < pointer->token_count) && ((depth + 1) < resolved)
+                && compare_tokens(&previous->tokens[depth], &pointer->tokens[depth], pointer->case_sensitive))
+            {
+                depth++;
+            }
+        }
+        else
+        {
+            resolved = 1;
+        }
+
+        if (depth < pointer->token_count)
+        {
+            const pointer_token *token = &pointer->tokens[depth];
+            cJSON *parent = path[depth];
+
+            /* siblings further down the same array can be reached from where the previous pointer left off */
+            if (((depth + 1) < resolved) && cJSON_IsArray(parent) && token->is_index
+                && previous->tokens[depth].is_index && (previous->tokens[depth].index <= token->index))
+            {
+                cJSON *element = path[depth + 1];
+                size_t index = previous->tokens[depth].index;
+                for (; (element != NULL) && (index < token->index); index++)
+                {
+                    element = element->next;
+                }
+                path[depth + 1] = element;
+            }
+            else
+            {
+                path[depth + 1] = get_item_from_token(parent, token, pointer->case_sensitive);
+            }
+            depth++;
+
+            for (; (depth < pointer->token_count) && (path[depth] != NULL); depth++)
+            {
+                path[depth + 1] = get_item_from_token(path[depth], &pointer->tokens[depth], pointer->case_sensitive);
+            }
+        }
+
+        if (depth < pointer->token_count)
+        {
+            /* path[depth] is NULL, the walk stopped early */
+            results[i] = NULL;
+            resolved = depth;
+        }
+        else
+        {
+            results[i] = path[depth];
+            resolved = (path[depth] != NULL) ? (depth + 1) : depth;
+        }
+        previous = pointer;
+    }
+
+    cJSON_free(path);
+
+    return true;
+}
+
+/* Remembers the items along the last pointer that was resolved while applying patches,
+ * so that consecutive operations on nearby paths don't resolve their common prefix again. */
+typedef struct
+{
+    unsigned char *pointer; /* the last resolved pointer */
+    cJSON **items; /* items[n] is the item after resolving n tokens of the pointer */
+    size_t count; /* number of valid entries in items */
+    size_t capacity;
+} pointer_cache;
+
+static cJSON *get_item_from_cached_pointer(pointer_cache * const cache, cJSON * const object, const char * const pointer, const cJSON_bool case_sensitive)
+{
+    const unsigned char *cached = NULL;
+    cJSON *current_element = object;
+    size_t position = 0;
+    size_t token = 0;
+    size_t length = 0;
+
+    if ((cache == NULL) || (pointer == NULL) || (pointer[0] != '/'))
+    {
+        return get_item_from_pointer(object, pointer, case_sensitive);
+    }
+
+    length = strlen(pointer);
+    if (length >= cache->capacity)
+    {
+        size_t new_capacity = (length + 1 > cache->capacity * 2) ? (length + 1) : (cache->capacity * 2);
+        unsigned char *new_pointer = (unsigned char*)cJSON_malloc(new_capacity);
+        cJSON **new_items = (cJSON**)cJSON_malloc(new_capacity * sizeof(cJSON*));
+        if ((new_pointer == NULL) || (new_items == NULL))
+        {
+            cJSON_free(new_pointer);
+            cJSON_free(new_items);
+            return get_item_from_pointer(object, pointer, case_sensitive);
+        }
+
+        if (cache->count > 0)
+        {
+            memcpy(new_pointer, cache->pointer, strlen((const char*)cache->pointer) + sizeof(""));
+            memcpy(new_items, cache->items, cache->count * sizeof(cJSON*));
+        }
+        cJSON_free(cache->pointer);
+        cJSON_free(cache->items);
+        cache->pointer = new_pointer;
+        cache->items = new_items;
+        cache->capacity = new_capacity;
+    }
+
+    if ((cache->count == 0) || (cache->items[0] != object))
+    {
+        cache->items[0] = object;
+        cache->count = 1;
+        cache->pointer[0] = '\0';
+    }
+    cached = cache->pointer;
+
+    /* skip the tokens that are the same as in the last pointer */
+    while ((pointer[position] == '/') && ((token + 1) < cache->count) && (cached[position] == '/'))
+    {
+        size_t end = position + 1;
+        while ((pointer[end] != '\0') && (pointer[end] != '/') && (pointer[end] == cached[end]))
+        {
+            end++;
+        }
+        if (((pointer[end] != '\0') && (pointer[end] != '/')) || ((cached[end] != '\0') && (cached[end] != '/')))
+        {
+            /* the tokens differ */
+            break;
+        }
+
+        position = end;
+        token++;
+        current_element = cache->items[token];
+    }
+    cache->count = token + 1;
+
+    /* resolve the rest and remember it */
+    while ((pointer[position] == '/') && (current_element != NULL))
+    {
+        position++;
+        current_element = get_item_from_pointer_token(current_element, pointer + position, case_sensitive);
+        if (current_element != NULL)
+        {
+            cache->items[cache->count] = current_element;
+            cache->count++;
+        }
+
+        /* skip to the next path token or end of string */
+        while ((pointer[position] != '\0') && (pointer[position] != '/'))
+        {
+            position++;
+        }
+    }
+    memcpy(cache->pointer, pointer, length + sizeof(""));
+
+    return current_element;
+}
+
+/* the children of parent were modified, forget everything that was resolved below it */
+static void invalidate_cached_pointer(pointer_cache * const cache, const cJSON * const parent)
+{
+    size_t token = 0;
+
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    for (token = 0; token < cache->count; token++)
+    {
+        if (cache->items[token] == parent)
+        {
+            cache->count = token + 1;
+            return;
+        }
+    }
+}
+
+/* JSON Patch implementation. */
+static void decode_pointer_inplace(unsigned char *string)
+{
+    unsigned char *decoded_string = string;
+
+    if (string == NULL) {
+        return;
+    }
+
+    for (; *string; (void)decoded_string++, string++)
+    {
+        if (string[0] == '~')
+        {
+            if (string[1] == '0')
+            {
+                decoded_string[0] = '~';
+            }
+            else if (string[1] == '1')
+            {
+                decoded_string[0] = '/';
+            }
+            else
+            {
+                /* invalid escape sequence */
+                return;
+            }
+
+            string++;
+        }
+        else
+        {
+            decoded_string[0] = string[0];
+        }
+    }
+
+    decoded_string[0] = '\0';
+}
+
+/* non-broken cJSON_DetachItemFromArray */
+static cJSON *detach_item_from_array(cJSON *array, size_t which)
+{
+    cJSON *c = NULL;
+    if ((array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array))
+    {
+        return NULL;
+    }
+
+    c = array->child;
+    while (c && (which > 0))
+    {
+        c = c->next;
+        which--;
+    }
+    if (!c)
+    {
+        /* item doesn't exist */
+        return NULL;
+    }
+    if (c != array->child)
+    {
+        /* not the first element */
+        c->prev->next = c->next;
+    }
+    if (c->next)
+    {
+        c->next->prev = c->prev;
+    }
+    if (c == array->child)
+    {
+        array->child = c->next;
+    }
+    else if (c->next == NULL)
+    {
+        array->child->prev = c->prev;
+    }
+    /* make sure the detached item doesn't point anywhere anymore */
+    c->prev = c->next = NULL;
+
+    return c;
+}
+
+/* The undo journal of an atomic patch application: every modification of the tree is recorded
+ * so that it can be reverted if a later operation fails. */
+enum journal_action { DETACHED_ITEM, INSERTED_ITEM, OVERWRITTEN_ROOT };
+
+typedef struct
+{
+    enum journal_action action;
+    cJSON *parent;
+    cJSON *item;
+    size_t index; /* position of a detached item in parent */
+    char *string; /* key of a detached item, a move into an object gives the item a new one */
+    cJSON_bool string_is_const;
+    cJSON_bool owned; /* if the item has to be freed on commit (detached) or rollback (inserted) */
+    cJSON previous_root; /* contents of the root before it was overwritten */
+} journal_entry;
+
+typedef struct
+{
+    journal_entry *entries;
+    size_t count;
+    size_t capacity;
+} patch_journal;
+
+/* make room for the entries of one more operation, so that recording them can't fail anymore */
+static cJSON_bool reserve_journal_entries(patch_journal * const journal, const size_t count)
+{
+    journal_entry *new_entries = NULL;
+    size_t new_capacity = 0;
+
+    if ((journal == NULL) || ((journal->count + count) <= journal->capacity))
+    {
+        return true;
+    }
+
+    new_capacity = (journal->capacity == 0) ? 16 : (journal->capacity * 2);
+    if (new_capacity < (journal->count + count))
+    {
+        new_capacity = journal->count + count;
+    }
+    new_entries = (journal_entry*)cJSON_malloc(new_capacity * sizeof(journal_entry));
+    if (new_entries == NULL)
+    {
+        return false;
+    }
+
+    if (journal->entries != NULL)
+    {
+        memcpy(new_entries, journal->entries, journal->count * sizeof(journal_entry));
+        cJSON_free(journal->entries);
+    }
+    journal->entries = new_entries;
+    journal->capacity = new_capacity;
+
+    return true;
+}
+
+static journal_entry *add_journal_entry(patch_journal * const journal, const enum journal_action action, cJSON * const parent, cJSON * const item, const cJSON_bool owned)
+{
+    journal_entry *entry = &journal->entries[journal->count];
+
+    memset(entry, '\0', sizeof(journal_entry));
+    entry->action = action;
+    entry->parent = parent;
+    entry->item = item;
+    entry->owned = owned;
+    entry->string = item->string;
+    entry->string_is_const = (item->type & cJSON_StringIsConst) ? true : false;
+    journal->count++;
+
+    return entry;
+}
+
+/* position of item in the children of parent */
+static size_t get_item_index(const cJSON * const parent, const cJSON * const item)
+{
+    const cJSON *child = NULL;
+    size_t index = 0;
+
+    for (child = parent->child; (child != NULL) && (child != item); child = child->next)
+    {
+        index++;
+    }
+
+    return index;
+}
+
+/* detach item from parent and record it in the journal if there is one */
+static void detach_item(cJSON * const parent, cJSON * const item, patch_journal * const journal, const cJSON_bool owned)
+{
+    size_t index = 0;
+
+    if (journal != NULL)
+    {
+        index = get_item_index(parent, item);
+    }
+
+    cJSON_DetachItemViaPointer(parent, item);
+
+    if (journal != NULL)
+    {
+        add_journal_entry(journal, DETACHED_ITEM, parent, item, owned)->index = index;
+    }
+}
+
+/* free everything an item owns, but not the item itself */
+static void free_item_contents(cJSON * const item)
+{
+    if (item->string != NULL)
+    {
+        cJSON_free(item->string);
+    }
+    if (item->valuestring != NULL)
+    {
+        cJSON_free(item->valuestring);
+    }
+    if (item->child != NULL)
+    {
+        cJSON_Delete(item->child);
+    }
+}
+
+/* overwrite and existing item with another one and free resources on the way */
+static void overwrite_item(cJSON * const root, const cJSON replacement)
+{
+    if (root == NULL)
+    {
+        return;
+    }
+
+    free_item_contents(root);
+
+    memcpy(root, &replacement, sizeof(cJSON));
+}
+
+/* like overwrite_item, but keeps the old contents in the journal */
+static void overwrite_root(cJSON * const root, const cJSON replacement, patch_journal * const journal)
+{
+    if ((root == NULL) || (journal == NULL))
+    {
+        overwrite_item(root, replacement);
+        return;
+    }
+
+    memcpy(&add_journal_entry(journal, OVERWRITTEN_ROOT, NULL, root, true)->previous_root, root, sizeof(cJSON));
+    memcpy(root, &replacement, sizeof(cJSON));
+}
+
+static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newitem);
+
+/* revert all recorded modifications, newest first */
+static void rollback_journal(patch_journal * const journal)
+{
+    while (journal->count > 0)
+    {
+        journal_entry *entry = &journal->entries[--journal->count];
+
+        switch (entry->action)
+        {
+            case DETACHED_ITEM:
+                if (entry->item->string != entry->string)
+                {
+                    /* restore the key the item had before it was moved */
+                    if (!(entry->item->type & cJSON_StringIsConst) && (entry->item->string != NULL))
+                    {
+                        cJSON_free(entry->item->string);
+                    }
+                    entry->item->string = entry->string;
+                    entry->item->type &= ~cJSON_StringIsConst;
+                    if (entry->string_is_const)
+                    {
+                        entry->item->type |= cJSON_StringIsConst;
+                    }
+                }
+                insert_item_in_array(entry->parent, entry->index, entry->item);
+                break;
+
+            case INSERTED_ITEM:
+                cJSON_DetachItemViaPointer(entry->parent, entry->item);
+                if (entry->owned)
+                {
+                    cJSON_Delete(entry->item);
+                }
+                break;
+
+            case OVERWRITTEN_ROOT:
+                overwrite_item(entry->item, entry->previous_root);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/* free everything that was removed from the tree */
+static void commit_journal(patch_journal * const journal)
+{
+    size_t index = 0;
+
+    for (index = 0; index < journal->count; index++)
+    {
+        journal_entry *entry = &journal->entries[index];
+
+        switch (entry->action)
+        {
+            case DETACHED_ITEM:
+                if (entry->owned)
+                {
+                    cJSON_Delete(entry->item);
+                }
+                else if ((entry->item->string != entry->string) && !entry->string_is_const && (entry->string != NULL))
+                {
+                    /* the old key of an item that was moved into an object */
+                    cJSON_free(entry->string);
+                }
+                break;
+
+            case OVERWRITTEN_ROOT:
+                free_item_contents(&entry->previous_root);
+                break;
+
+            case INSERTED_ITEM:
+            default:
+                break;
+        }
+    }
+
+    journal->count = 0;
+}
+
+/* detach an item at the given path */
+static cJSON *detach_path(cJSON *object, const unsigned char *path, const cJSON_bool case_sensitive, pointer_cache * const cache, patch_journal * const journal, const cJSON_bool owned)
+{
+    unsigned char *parent_pointer = NULL;
+    unsigned char *child_pointer = NULL;
+    cJSON *parent = NULL;
+    cJSON *detached_item = NULL;
+
+    /* copy path and split it in parent and child */
+    parent_pointer = cJSONUtils_strdup(path);
+    if (parent_pointer == NULL) {
+        goto cleanup;
+    }
+
+    child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/'); /* last '/' */
+    if (child_pointer == NULL)
+    {
+        goto cleanup;
+    }
+    /* split strings */
+    child_pointer[0] = '\0';
+    child_pointer++;
+
+    parent = get_item_from_cached_pointer(cache, object, (char*)parent_pointer, case_sensitive);
+    decode_pointer_inplace(child_pointer);
+
+    if (cJSON_IsArray(parent))
+    {
+        size_t index = 0;
+        if (!decode_array_index_from_pointer(child_pointer, &index))
+        {
+            goto cleanup;
+        }
+        detached_item = detach_item_from_array(parent, index);
+        invalidate_cached_pointer(cache, parent);
+        if ((detached_item != NULL) && (journal != NULL))
+        {
+            add_journal_entry(journal, DETACHED_ITEM, parent, detached_item, owned)->index = index;
+        }
+    }
+    else if (cJSON_IsObject(parent))
+    {
+        detached_item = cJSON_GetObjectItem(parent, (char*)child_pointer);
+        if (detached_item != NULL)
+        {
+            detach_item(parent, detached_item, journal, owned);
+        }
+        invalidate_cached_pointer(cache, parent);
+    }
+    else
+    {
+        /* Couldn't find object to remove child from. */
+        goto cleanup;
+    }
+
+cleanup:
+    if (parent_pointer != NULL)
+    {
+        cJSON_free(parent_pointer);
+    }
+
+    return detached_item;
+}
+
+/* sort lists using mergesort, used if there is no memory for sorting an array of the members */
+static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
+{
+    cJSON *first = list;
+    cJSON *second = list;
+    cJSON *current_item = list;
+    cJSON *result = list;
+    cJSON *result_tail = NULL;
+
+    if ((list == NULL) || (list->next == NULL))
+    {
+        /* One entry is sorted already. */
+        return result;
+    }
+
+    while ((current_item != NULL) && (current_item->next != NULL) && (compare_strings((unsigned char*)current_item->string, (unsigned char*)current_item->next->string, case_sensitive) < 0))
+    {
+        /* Test for list sorted. */
+        current_item = current_item->next;
+    }
+    if ((current_item == NULL) || (current_item->next == NULL))
+    {
+        /* Leave sorted lists unmodified. */
         return result;
     }
 
@@ -592,16 +1533,254 @@ static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
     return result;
 }
 
+/* a member of an object that is being sorted, with the first bytes of its key
+ * (case folded if necessary) packed so that comparing them as integers orders them like the keys */
+typedef struct
+{
+    cJSON *item;
+    unsigned long key_prefix;
+    size_t index;
+} sort_entry;
+
+static unsigned long get_key_prefix(const unsigned char *key, const cJSON_bool case_sensitive)
+{
+    unsigned long prefix = 0;
+    size_t position = 0;
+
+    for (position = 0; position < sizeof(unsigned long); position++)
+    {
+        unsigned char character = 0;
+        if ((key != NULL) && (*key != '\0'))
+        {
+            character = case_sensitive ? *key : (unsigned char)tolower(*key);
+            key++;
+        }
+        prefix = (prefix << CHAR_BIT) | character;
+    }
+
+    return prefix;
+}
+
+static int compare_sort_entries(const sort_entry * const a, const sort_entry * const b, const cJSON_bool case_sensitive)
+{
+    int difference = 0;
+
+    if (a->key_prefix != b->key_prefix)
+    {
+        return (a->key_prefix < b->key_prefix) ? -1 : 1;
+    }
+
+    difference = compare_strings((unsigned char*)a->item->string, (unsigned char*)b->item->string, case_sensitive);
+    if (difference != 0)
+    {
+        return difference;
+    }
+
+    /* keep equal keys in their original order */
+    return (a->index < b->index) ? -1 : ((a->index > b->index) ? 1 : 0);
+}
+
+static int CJSON_CDECL compare_sort_entries_case_sensitive(const void *a, const void *b)
+{
+    return compare_sort_entries((const sort_entry*)a, (const sort_entry*)b, true);
+}
+
+static int CJSON_CDECL compare_sort_entries_case_insensitive(const void *a, const void *b)
+{
+    return compare_sort_entries((const sort_entry*)a, (const sort_entry*)b, false);
+}
+
 static void sort_object(cJSON * const object, const cJSON_bool case_sensitive)
 {
+    sort_entry *entries = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+    size_t index = 0;
+    cJSON_bool sorted = true;
+
+    if ((object == NULL) || (object->child == NULL))
+    {
+        return;
+    }
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if ((child->next != NULL) && (compare_strings((unsigned char*)child->string, (unsigned char*)child->next->string, case_sensitive) > 0))
+        {
+            sorted = false;
+        }
+        count++;
+    }
+    if (sorted)
+    {
+        /* Leave sorted lists unmodified. */
+        return;
+    }
+
+    entries = (sort_entry*)cJSON_malloc(count * sizeof(sort_entry));
+    if (entries == NULL)
+    {
+        /* fall back to sorting the list in place */
+        object->child = sort_list(object->child, case_sensitive);
+        child = object->child;
+        while (child->next != NULL)
+        {
+            child = child->next;
+        }
+        object->child->prev = child;
+        return;
+    }
+
+    for ((void)(child = object->child), index = 0; child != NULL; (void)(child = child->next), index++)
+    {
+        entries[index].item = child;
+        entries[index].key_prefix = get_key_prefix((unsigned char*)child->string, case_sensitive);
+        entries[index].index = index;
+    }
+
+    qsort(entries, count, sizeof(sort_entry), case_sensitive ? compare_sort_entries_case_sensitive : compare_sort_entries_case_insensitive);
+
+    /* relink the list in sorted order, the prev of the first child points to the last one */
+    for (index = 0; index < count; index++)
+    {
+        entries[index].item->prev = (index == 0) ? entries[count - 1].item : entries[index - 1].item;
+        entries[index].item->next = ((index + 1) < count) ? entries[index + 1].item : NULL;
+    }
+    object->child = entries[0].item;
+
+    cJSON_free(entries);
+}
+
+/* sort object and the objects nested in it up to depth levels below it */
+static void sort_object_recursively(cJSON * const object, const int depth, const cJSON_bool case_sensitive)
+{
+    cJSON *child = NULL;
+
     if (object == NULL)
     {
         return;
     }
-    object->child = sort_list(object->child, case_sensitive);
+
+    if (cJSON_IsObject(object))
+    {
+        sort_object(object, case_sensitive);
+    }
+
+    if (depth <= 0)
+    {
+        return;
+    }
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if (cJSON_IsObject(child) || cJSON_IsArray(child))
+        {
+            sort_object_recursively(child, depth - 1, case_sensitive);
+        }
+    }
+}
+
+static cJSON_bool compare_json(const cJSON *a, const cJSON *b, const cJSON_bool case_sensitive);
+
+/* an object member together with its position, so that sorting members is stable */
+typedef struct
+{
+    const cJSON *item;
+    size_t index;
+} object_member;
+
+static int compare_members(const object_member * const a, const object_member * const b, const cJSON_bool case_sensitive)
+{
+    int difference = compare_strings((const unsigned char*)a->item->string, (const unsigned char*)b->item->string, case_sensitive);
+    if (difference != 0)
+    {
+        return difference;
+    }
+
+    return (a->index < b->index) ? -1 : ((a->index > b->index) ? 1 : 0);
+}
+
+static int CJSON_CDECL compare_members_case_sensitive(const void *a, const void *b)
+{
+    return compare_members((const object_member*)a, (const object_member*)b, true);
+}
+
+static int CJSON_CDECL compare_members_case_insensitive(const void *a, const void *b)
+{
+    return compare_members((const object_member*)a, (const object_member*)b, false);
+}
+
+/* Compare the members of two objects with the same number of members without modifying them.
+ * Members are paired like after a stable sort by key: the n-th member with a given key in a
+ * is compared to the n-th member with that key in b. */
+static cJSON_bool compare_object_members(const cJSON * const a, const cJSON * const b, const size_t count, const cJSON_bool case_sensitive)
+{
+    object_member *members = NULL;
+    const cJSON *a_child = NULL;
+    const cJSON *b_child = NULL;
+    cJSON_bool identical = true;
+    size_t index = 0;
+
+    if (count <= (sizeof(unsigned long) * CHAR_BIT))
+    {
+        /* few members: look up every member of a in b and remember which ones have been paired */
+        unsigned long paired = 0;
+
+        for (a_child = a->child; a_child != NULL; a_child = a_child->next)
+        {
+            for ((void)(b_child = b->child), index = 0; b_child != NULL; (void)(b_child = b_child->next), index++)
+            {
+                if (((paired & (1UL << index)) == 0) && (compare_strings((const unsigned char*)a_child->string, (const unsigned char*)b_child->string, case_sensitive) == 0))
+                {
+                    break;
+                }
+            }
+
+            if ((b_child == NULL) || !compare_json(a_child, b_child, case_sensitive))
+            {
+                /* missing or different member */
+                return false;
+            }
+            paired |= 1UL << index;
+        }
+
+        return true;
+    }
+
+    /* many members: sort copies of both member lists */
+    members = (object_member*)cJSON_malloc(2 * count * sizeof(object_member));
+    if (members == NULL)
+    {
+        return false;
+    }
+
+    for ((void)(a_child = a->child), (void)(b_child = b->child), index = 0; index < count; (void)(a_child = a_child->next), (void)(b_child = b_child->next), index++)
+    {
+        members[index].item = a_child;
+        members[index].index = index;
+        members[count + index].item = b_child;
+        members[count + index].index = index;
+    }
+    qsort(members, count, sizeof(object_member), case_sensitive ? compare_members_case_sensitive : compare_members_case_insensitive);
+    qsort(members + count, count, sizeof(object_member), case_sensitive ? compare_members_case_sensitive : compare_members_case_insensitive);
+
+    for (index = 0; identical && (index < count); index++)
+    {
+        const cJSON *a_member = members[index].item;
+        const cJSON *b_member = members[count + index].item;
+
+        /* compare object keys */
+        identical = (compare_strings((const unsigned char*)a_member->string, (const unsigned char*)b_member->string, case_sensitive) == 0)
+            && compare_json(a_member, b_member, case_sensitive);
+    }
+
+    cJSON_free(members);
+
+    return identical;
 }
 
-static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensitive)
+/* compares two items without modifying them, the order of object members doesn't matter */
+static cJSON_bool compare_json(const cJSON *a, const cJSON *b, const cJSON_bool case_sensitive)
 {
     if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
     {
@@ -611,8 +1790,8 @@ static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensiti
     switch (a->type & 0xFF)
     {
         case cJSON_Number:
-            /* numeric mismatch. */
-            if ((a->valueint != b->valueint) || (!compare_double(a->valuedouble, b->valuedouble)))
+            /* numeric mismatch (cJSON_Compare also compares exact 64 bit integers). */
+            if ((a->valueint != b->valueint) || !cJSON_Compare(a, b, case_sensitive))
             {
                 return false;
             }
@@ -633,6 +1812,11 @@ static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensiti
             }
 
         case cJSON_Array:
+            if ((a->type | b->type) & cJSON_IsPacked)
+            {
+                /* packed numbers have no items to walk */
+                return cJSON_Compare(a, b, case_sensitive);
+            }
             for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
             {
                 cJSON_bool identical = compare_json(a, b, case_sensitive);
@@ -652,47 +1836,291 @@ static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensiti
                 return true;
             }
 
-        case cJSON_Object:
-            sort_object(a, case_sensitive);
-            sort_object(b, case_sensitive);
-            for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
+        case cJSON_Object:
+        {
+            const cJSON *a_child = a->child;
+            const cJSON *b_child = b->child;
+            size_t count = 0;
+
+            for (; (a_child != NULL) && (b_child != NULL); (void)(a_child = a_child->next), b_child = b_child->next)
+            {
+                count++;
+            }
+
+            /* object length mismatch (one of both children is not null) */
+            if ((a_child != NULL) || (b_child != NULL))
+            {
+                return false;
+            }
+
+            return compare_object_members(a, b, count, case_sensitive);
+        }
+
+        default:
+            break;
+    }
+
+    /* null, true or false */
+    return true;
+}
+
+/* Structural hashing: items that compare_json considers equal (almost always) have the same hash,
+ * the members of objects are combined independently of their order. */
+static unsigned long mix_hash(unsigned long hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bUL;
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bUL;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+/* FNV-1a */
+static unsigned long hash_string(const unsigned char *string, const cJSON_bool case_sensitive)
+{
+    unsigned long hash = 2166136261UL;
+
+    if (string == NULL)
+    {
+        return 0;
+    }
+
+    for (; *string != '\0'; string++)
+    {
+        hash ^= (unsigned long)(case_sensitive ? *string : (unsigned char)tolower(*string));
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+static unsigned long hash_double(const double number)
+{
+    double mantissa = 0;
+    int exponent = 0;
+
+    if ((number > -DBL_MIN) && (number < DBL_MIN))
+    {
+        /* zero and subnormal numbers */
+        return 0;
+    }
+
+    if ((number != number) || (number > DBL_MAX) || (number < -DBL_MAX))
+    {
+        /* NaN and infinity */
+        return 1;
+    }
+
+    /* numbers that compare_double considers equal only differ in the lowest bits of the mantissa, cut them off */
+    mantissa = frexp(number, &exponent);
+
+    return mix_hash((unsigned long)(long)(mantissa * 1073741824.0)) ^ (unsigned long)(long)exponent;
+}
+
+/* packed arrays store their numbers in valuestring as valueint doubles (see cJSON_PackArray) */
+static double get_packed_number(const cJSON * const array, const size_t index)
+{
+    double number = 0;
+    memcpy(&number, array->valuestring + (index * sizeof(double)), sizeof(double));
+
+    return number;
+}
+
+/* hashes of all items of a tree, in an open addressing hash table keyed by item address */
+typedef struct
+{
+    const cJSON *item;
+    unsigned long hash;
+} item_hash_entry;
+
+typedef struct
+{
+    item_hash_entry *entries;
+    size_t capacity; /* always a power of two */
+    size_t count;
+} item_hashes;
+
+static item_hash_entry *find_item_hash(const item_hashes * const hashes, const cJSON * const item)
+{
+    size_t slot = hash_item_address(item) & (hashes->capacity - 1);
+
+    while ((hashes->entries[slot].item != NULL) && (hashes->entries[slot].item != item))
+    {
+        slot = (slot + 1) & (hashes->capacity - 1);
+    }
+
+    return hashes->entries + slot;
+}
+
+static cJSON_bool add_item_hash(item_hashes * const hashes, const cJSON * const item, const unsigned long hash)
+{
+    item_hash_entry *entry = NULL;
+
+    /* keep the load factor below one half */
+    if (((hashes->count + 1) * 2) > hashes->capacity)
+    {
+        item_hashes grown;
+        size_t slot = 0;
+
+        grown.capacity = hashes->capacity * 2;
+        grown.count = hashes->count;
+        grown.entries = (item_hash_entry*)cJSON_malloc(grown.capacity * sizeof(item_hash_entry));
+        if (grown.entries == NULL)
+        {
+            return false;
+        }
+        memset(grown.entries, '\0', grown.capacity * sizeof(item_hash_entry));
+
+        for (slot = 0; slot < hashes->capacity; slot++)
+        {
+            if (hashes->entries[slot].item != NULL)
+            {
+                *find_item_hash(&grown, hashes->entries[slot].item) = hashes->entries[slot];
+            }
+        }
+
+        cJSON_free(hashes->entries);
+        *hashes = grown;
+    }
+
+    entry = find_item_hash(hashes, item);
+    if (entry->item == NULL)
+    {
+        hashes->count++;
+    }
+    entry->item = item;
+    entry->hash = hash;
+
+    return true;
+}
+
+/* calculates the hash of item, and stores the hashes of item and all of its children in hashes if it isn't NULL */
+static unsigned long hash_item(const cJSON * const item, const cJSON_bool case_sensitive, item_hashes * const hashes)
+{
+    unsigned long hash = mix_hash((unsigned long)(item->type & 0xFF));
+    const cJSON *child = NULL;
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_Number:
+            hash ^= hash_double(item->valuedouble);
+            break;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            hash ^= hash_string((const unsigned char*)item->valuestring, true);
+            break;
+
+        case cJSON_Array:
+            if (item->type & cJSON_IsPacked)
             {
-                cJSON_bool identical = false;
-                /* compare object keys */
-                if (compare_strings((unsigned char*)a->string, (unsigned char*)b->string, case_sensitive))
-                {
-                    /* missing member */
-                    return false;
-                }
-                identical = compare_json(a, b, case_sensitive);
-                if (!identical)
+                /* hash the packed numbers like number items, so that packing doesn't change the hash */
+                int index = 0;
+                for (index = 0; index < item->valueint; index++)
                 {
-                    return false;
+                    hash = (hash * 31UL) + mix_hash(mix_hash((unsigned long)cJSON_Number) ^ hash_double(get_packed_number(item, (size_t)index)));
                 }
+                break;
             }
-
-            /* object length mismatch (one of both children is not null) */
-            if ((a != NULL) || (b != NULL))
+            for (child = item->child; child != NULL; child = child->next)
             {
-                return false;
+                hash = (hash * 31UL) + hash_item(child, case_sensitive, hashes);
             }
-            else
+            break;
+
+        case cJSON_Object:
+        {
+            unsigned long members = 0;
+            for (child = item->child; child != NULL; child = child->next)
             {
-                return true;
+                /* addition is commutative, so the order of the members doesn't matter */
+                members += mix_hash(hash_string((const unsigned char*)child->string, case_sensitive) ^ hash_item(child, case_sensitive, hashes));
             }
+            hash ^= members;
+            break;
+        }
 
         default:
             break;
     }
 
-    /* null, true or false */
-    return true;
+    hash = mix_hash(hash);
+    if ((hashes != NULL) && (hashes->entries != NULL) && !add_item_hash(hashes, item, hash))
+    {
+        /* out of memory, the table is dropped and hashes are calculated when needed */
+        cJSON_free(hashes->entries);
+        hashes->entries = NULL;
+        hashes->capacity = 0;
+        hashes->count = 0;
+    }
+
+    return hash;
+}
+
+/* looks up the hash of item in hashes and calculates it if it isn't there */
+static unsigned long get_item_hash(const item_hashes * const hashes, const cJSON * const item, const cJSON_bool case_sensitive)
+{
+    if ((hashes != NULL) && (hashes->entries != NULL))
+    {
+        const item_hash_entry *entry = find_item_hash(hashes, item);
+        if (entry->item != NULL)
+        {
+            return entry->hash;
+        }
+    }
+
+    return hash_item(item, case_sensitive, NULL);
+}
+
+/* start a table with the hashes of every item in from and to */
+static void create_item_hashes(item_hashes * const hashes, const cJSON * const from, const cJSON * const to, const cJSON_bool case_sensitive)
+{
+    hashes->capacity = 64;
+    hashes->count = 0;
+    hashes->entries = (item_hash_entry*)cJSON_malloc(hashes->capacity * sizeof(item_hash_entry));
+    if (hashes->entries == NULL)
+    {
+        hashes->capacity = 0;
+        return;
+    }
+    memset(hashes->entries, '\0', hashes->capacity * sizeof(item_hash_entry));
+
+    hash_item(from, case_sensitive, hashes);
+    hash_item(to, case_sensitive, hashes);
+}
+
+CJSON_PUBLIC(unsigned long) cJSONUtils_Hash(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return 0;
+    }
+
+    return hash_item(item, false, NULL);
+}
+
+CJSON_PUBLIC(unsigned long) cJSONUtils_HashCaseSensitive(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return 0;
+    }
+
+    return hash_item(item, true, NULL);
 }
 
 /* non broken version of cJSON_InsertItemInArray */
 static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newitem)
 {
-    cJSON *child = array->child;
+    cJSON *child = NULL;
+    if ((array->type & cJSON_IsPacked) && !cJSON_UnpackArray(array))
+    {
+        return 0;
+    }
+
+    child = array->child;
     while (child && (which > 0))
     {
         child = child->next;
@@ -780,31 +2208,7 @@ static enum patch_operation decode_patch_operation(const cJSON * const patch, co
     return INVALID;
 }
 
-/* overwrite and existing item with another one and free resources on the way */
-static void overwrite_item(cJSON * const root, const cJSON replacement)
-{
-    if (root == NULL)
-    {
-        return;
-    }
-
-    if (root->string != NULL)
-    {
-        cJSON_free(root->string);
-    }
-    if (root->valuestring != NULL)
-    {
-        cJSON_free(root->valuestring);
-    }
-    if (root->child != NULL)
-    {
-        cJSON_Delete(root->child);
-    }
-
-    memcpy(root, &replacement, sizeof(cJSON));
-}
-
-static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_sensitive)
+static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_sensitive, pointer_cache * const cache, patch_journal * const journal)
 {
     cJSON *path = NULL;
     cJSON *value = NULL;
@@ -812,8 +2216,17 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     enum patch_operation opcode = INVALID;
     unsigned char *parent_pointer = NULL;
     unsigned char *child_pointer = NULL;
+    cJSON_bool value_in_journal = false;
     int status = 0;
 
+    /* an operation records at most three modifications (move into an existing object member) */
+    if (!reserve_journal_entries(journal, 3))
+    {
+        /* out of memory for the journal. */
+        status = 14;
+        goto cleanup;
+    }
+
     path = get_object_item(patch, "path", case_sensitive);
     if (!cJSON_IsString(path))
     {
@@ -831,7 +2244,7 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     else if (opcode == TEST)
     {
         /* compare value: {...} with the given path */
-        status = !compare_json(get_item_from_pointer(object, path->valuestring, case_sensitive), get_object_item(patch, "value", case_sensitive), case_sensitive);
+        status = !compare_json(get_item_from_cached_pointer(cache, object, path->valuestring, case_sensitive), get_object_item(patch, "value", case_sensitive), case_sensitive);
         goto cleanup;
     }
 
@@ -842,7 +2255,8 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         {
             static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL};
 
-            overwrite_item(object, invalid);
+            overwrite_root(object, invalid, journal);
+            invalidate_cached_pointer(cache, object);
 
             status = 0;
             goto cleanup;
@@ -866,7 +2280,8 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
                 goto cleanup;
             }
 
-            overwrite_item(object, *value);
+            overwrite_root(object, *value, journal);
+            invalidate_cached_pointer(cache, object);
 
             /* delete the duplicated value */
             cJSON_free(value);
@@ -887,13 +2302,16 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     if ((opcode == REMOVE) || (opcode == REPLACE))
     {
         /* Get rid of old. */
-        cJSON *old_item = detach_path(object, (unsigned char*)path->valuestring, case_sensitive);
+        cJSON *old_item = detach_path(object, (unsigned char*)path->valuestring, case_sensitive, cache, journal, true);
         if (old_item == NULL)
         {
             status = 13;
             goto cleanup;
         }
-        cJSON_Delete(old_item);
+        if (journal == NULL)
+        {
+            cJSON_Delete(old_item);
+        }
         if (opcode == REMOVE)
         {
             /* For Remove, this job is done. */
@@ -915,11 +2333,13 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
 
         if (opcode == MOVE)
         {
-            value = detach_path(object, (unsigned char*)from->valuestring, case_sensitive);
+            value = detach_path(object, (unsigned char*)from->valuestring, case_sensitive, cache, journal, false);
+            /* on failure, the rollback puts it back */
+            value_in_journal = (journal != NULL);
         }
         if (opcode == COPY)
         {
-            value = get_item_from_pointer(object, from->valuestring, case_sensitive);
+            value = get_item_from_cached_pointer(cache, object, from->valuestring, case_sensitive);
         }
         if (value == NULL)
         {
@@ -968,8 +2388,9 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         child_pointer[0] = '\0';
         child_pointer++;
     }
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
+    parent = get_item_from_cached_pointer(cache, object, (char*)parent_pointer, case_sensitive);
     decode_pointer_inplace(child_pointer);
+    invalidate_cached_pointer(cache, parent);
 
     /* add, remove, replace, move, copy, test. */
     if ((parent == NULL) || (child_pointer == NULL))
@@ -983,7 +2404,6 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         if (strcmp((char*)child_pointer, "-") == 0)
         {
             cJSON_AddItemToArray(parent, value);
-            value = NULL;
         }
         else
         {
@@ -999,21 +2419,30 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
                 status = 10;
                 goto cleanup;
             }
-            value = NULL;
         }
     }
     else if (cJSON_IsObject(parent))
     {
-        if (case_sensitive)
+        cJSON *old_item = get_object_item(parent, (char*)child_pointer, case_sensitive);
+        if (old_item != NULL)
         {
-            cJSON_DeleteItemFromObjectCaseSensitive(parent, (char*)child_pointer);
+            detach_item(parent, old_item, journal, true);
+            if (journal == NULL)
+            {
+                cJSON_Delete(old_item);
+            }
         }
-        else
+        if (value_in_journal)
+        {
+            /* the journal keeps the old key of a moved item for the rollback */
+            value->string = NULL;
+            value->type &= ~cJSON_StringIsConst;
+        }
+        if (!cJSON_AddItemToObject(parent, (char*)child_pointer, value))
         {
-            cJSON_DeleteItemFromObject(parent, (char*)child_pointer);
+            status = 10;
+            goto cleanup;
         }
-        cJSON_AddItemToObject(parent, (char*)child_pointer, value);
-        value = NULL;
     }
     else /* parent is not an object */
     {
@@ -1022,8 +2451,14 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         goto cleanup;
     }
 
+    if (journal != NULL)
+    {
+        add_journal_entry(journal, INSERTED_ITEM, parent, value, opcode != MOVE);
+    }
+    value = NULL;
+
 cleanup:
-    if (value != NULL)
+    if ((value != NULL) && !value_in_journal)
     {
         cJSON_Delete(value);
     }
@@ -1035,9 +2470,11 @@ cleanup:
     return status;
 }
 
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
+static int apply_patches(cJSON * const object, const cJSON * const patches, const cJSON_bool case_sensitive, const cJSON_bool atomic)
 {
     const cJSON *current_patch = NULL;
+    pointer_cache cache = { NULL, NULL, 0, 0 };
+    patch_journal journal = { NULL, 0, 0 };
     int status = 0;
 
     if (!cJSON_IsArray(patches))
@@ -1053,44 +2490,47 @@ CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * co
 
     while (current_patch != NULL)
     {
-        status = apply_patch(object, current_patch, false);
+        status = apply_patch(object, current_patch, case_sensitive, &cache, atomic ? &journal : NULL);
         if (status != 0)
         {
-            return status;
+            break;
         }
         current_patch = current_patch->next;
     }
 
-    return 0;
-}
-
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
-{
-    const cJSON *current_patch = NULL;
-    int status = 0;
-
-    if (!cJSON_IsArray(patches))
+    if (status != 0)
     {
-        /* malformed patches. */
-        return 1;
+        rollback_journal(&journal);
     }
-
-    if (patches != NULL)
+    else
     {
-        current_patch = patches->child;
+        commit_journal(&journal);
     }
+    cJSON_free(journal.entries);
+    cJSON_free(cache.pointer);
+    cJSON_free(cache.items);
 
-    while (current_patch != NULL)
-    {
-        status = apply_patch(object, current_patch, true);
-        if (status != 0)
-        {
-            return status;
-        }
-        current_patch = current_patch->next;
-    }
+    return status;
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, false, false);
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, true, false);
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomic(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, false, true);
+}
 
-    return 0;
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomicCaseSensitive(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, true, true);
 }
 
 static void compose_patch(cJSON * const patches, const unsigned char * const operation, const unsigned char * const path, const unsigned char *suffix, const cJSON * const value)
@@ -1138,13 +2578,271 @@ CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char *
     compose_patch(array, (const unsigned char*)operation, (const unsigned char*)path, NULL, value);
 }
 
-static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive)
+/* Myers' O((N+M)D) diff of two arrays of items. Marks the items that are part of the
+ * longest common subsequence in from_matched and to_matched.
+ * Returns false if more than CJSON_UTILS_ARRAY_DIFF_LIMIT insertions and deletions would be required. */
+static cJSON_bool diff_arrays(cJSON * const * const from, const unsigned long * const from_hashes, const long from_count, cJSON * const * const to, const unsigned long * const to_hashes, const long to_count, unsigned char * const from_matched, unsigned char * const to_matched, const cJSON_bool case_sensitive)
+{
+    /* trace holds the furthest x reached on every diagonal k = x - y for every number of edits d,
+     * the values for d are stored at trace[d * d + d + k] */
+    long *trace = NULL;
+    long max_edits = from_count + to_count;
+    long d = 0;
+    long k = 0;
+    long x = 0;
+    long y = 0;
+
+    if (max_edits > CJSON_UTILS_ARRAY_DIFF_LIMIT)
+    {
+        max_edits = CJSON_UTILS_ARRAY_DIFF_LIMIT;
+    }
+
+    trace = (long*)cJSON_malloc((size_t)(max_edits + 1) * (size_t)(max_edits + 1) * sizeof(long));
+    if (trace == NULL)
+    {
+        return false;
+    }
+
+    for (d = 0; d <= max_edits; d++)
+    {
+        long *current = trace + (d * d + d);
+        const long *previous = trace + ((d - 1) * (d - 1) + (d - 1));
+
+        for (k = -d; k <= d; k += 2)
+        {
+            if (d == 0)
+            {
+                x = 0;
+            }
+            else if ((k == -d) || ((k != d) && (previous[k - 1] < previous[k + 1])))
+            {
+                /* insertion */
+                x = previous[k + 1];
+            }
+            else
+            {
+                /* deletion */
+                x = previous[k - 1] + 1;
+            }
+            y = x - k;
+
+            /* follow the diagonal of equal items */
+            while ((x < from_count) && (y < to_count) && (from_hashes[x] == to_hashes[y]) && compare_json(from[x], to[y], case_sensitive))
+            {
+                x++;
+                y++;
+            }
+            current[k] = x;
+
+            if ((x >= from_count) && (y >= to_count))
+            {
+                goto found;
+            }
+        }
+    }
+
+    /* too many edits */
+    cJSON_free(trace);
+    return false;
+
+found:
+    /* walk back from the end and mark the diagonals */
+    x = from_count;
+    y = to_count;
+    for (; d >= 0; d--)
+    {
+        long previous_x = 0;
+        long previous_y = 0;
+        k = x - y;
+
+        if (d == 0)
+        {
+            previous_x = 0;
+            previous_y = 0;
+        }
+        else
+        {
+            const long *previous = trace + ((d - 1) * (d - 1) + (d - 1));
+            long previous_k = ((k == -d) || ((k != d) && (previous[k - 1] < previous[k + 1]))) ? (k + 1) : (k - 1);
+            previous_x = previous[previous_k];
+            previous_y = previous_x - previous_k;
+        }
+
+        /* the snake leading to (x, y) starts after the edit */
+        while ((x > previous_x) && (y > previous_y))
+        {
+            x--;
+            y--;
+            from_matched[x] = 1;
+            to_matched[y] = 1;
+        }
+
+        x = previous_x;
+        y = previous_y;
+    }
+
+    cJSON_free(trace);
+
+    return true;
+}
+
+/* collect the items of an array into a newly allocated vector */
+static cJSON **array_to_vector(const cJSON * const array, long * const count)
+{
+    cJSON **vector = NULL;
+    cJSON *child = NULL;
+    long index = 0;
+
+    *count = 0;
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        (*count)++;
+    }
+
+    vector = (cJSON**)cJSON_malloc((size_t)(*count + 1) * sizeof(cJSON*));
+    if (vector == NULL)
+    {
+        return NULL;
+    }
+
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        vector[index++] = child;
+    }
+
+    return vector;
+}
+
+static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool array_diff, const item_hashes * const hashes);
+
+/* generate add and remove patches for the insertions and deletions between two arrays,
+ * runs of items that were replaced are patched recursively */
+static void create_array_diff_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const item_hashes * const hashes)
+{
+    cJSON **from_items = NULL;
+    cJSON **to_items = NULL;
+    unsigned long *item_hash_values = NULL;
+    unsigned char *matched = NULL;
+    unsigned char *new_path = NULL;
+    long from_count = 0;
+    long to_count = 0;
+    long prefix = 0;
+    long suffix = 0;
+    long i = 0;
+    long j = 0;
+
+    from_items = array_to_vector(from, &from_count);
+    to_items = array_to_vector(to, &to_count);
+    matched = (unsigned char*)cJSON_malloc((size_t)(from_count + to_count + 1));
+    new_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
+    item_hash_values = (unsigned long*)cJSON_malloc((size_t)(from_count + to_count + 1) * sizeof(unsigned long));
+    if ((from_items == NULL) || (to_items == NULL) || (matched == NULL) || (new_path == NULL) || (item_hash_values == NULL))
+    {
+        goto cleanup;
+    }
+    memset(matched, '\0', (size_t)(from_count + to_count + 1));
+
+    /* items are only compared if their hashes match */
+    for (i = 0; i < from_count; i++)
+    {
+        item_hash_values[i] = get_item_hash(hashes, from_items[i], case_sensitive);
+    }
+    for (j = 0; j < to_count; j++)
+    {
+        item_hash_values[from_count + j] = get_item_hash(hashes, to_items[j], case_sensitive);
+    }
+    i = 0;
+    j = 0;
+
+    /* equal items at the start and the end don't need to go through the diff */
+    for (prefix = 0; (prefix < from_count) && (prefix < to_count) && (item_hash_values[prefix] == item_hash_values[from_count + prefix]) && compare_json(from_items[prefix], to_items[prefix], case_sensitive); prefix++)
+    {
+        matched[prefix] = 1;
+        matched[from_count + prefix] = 1;
+    }
+    for (suffix = 0; ((from_count - suffix) > prefix) && ((to_count - suffix) > prefix) 
+        && (item_hash_values[from_count - suffix - 1] == item_hash_values[from_count + to_count - suffix - 1])
+        && compare_json(from_items[from_count - suffix - 1], to_items[to_count - suffix - 1], case_sensitive); suffix++)
+    {
+        matched[from_count - suffix - 1] = 1;
+        matched[from_count + to_count - suffix - 1] = 1;
+    }
+
+    /* if the diff gives up, the remainder is patched index by index */
+    diff_arrays(from_items + prefix, item_hash_values + prefix, from_count - prefix - suffix, to_items + prefix, item_hash_values + from_count + prefix, to_count - prefix - suffix, matched + prefix, matched + from_count + prefix, case_sensitive);
+
+    /* i and j walk through from and to, after every step the patched array starts with to[0..j) */
+    while ((i < from_count) || (j < to_count))
+    {
+        long deleted = 0;
+        long inserted = 0;
+        long k = 0;
+
+        if ((i < from_count) && (j < to_count) && matched[i] && matched[from_count + j])
+        {
+            i++;
+            j++;
+            continue;
+        }
+
+        while (((i + deleted) < from_count) && !matched[i + deleted])
+        {
+            deleted++;
+        }
+        while (((j + inserted) < to_count) && !matched[from_count + j + inserted])
+        {
+            inserted++;
+        }
+        if ((deleted == 0) && (inserted == 0))
+        {
+            /* can't happen, the matched items always come in pairs */
+            break;
+        }
+
+        /* pairs of deleted and inserted items are patched in place */
+        for (k = 0; (k < deleted) && (k < inserted); k++)
+        {
+            sprintf((char*)new_path, "%s/%lu", path, (unsigned long)(j + k));
+            create_patches(patches, new_path, from_items[i + k], to_items[j + k], case_sensitive, true, hashes);
+        }
+        for (; k < deleted; k++)
+        {
+            sprintf((char*)new_path, "%lu", (unsigned long)(j + inserted));
+            compose_patch(patches, (const unsigned char*)"remove", path, new_path, NULL);
+        }
+        for (; k < inserted; k++)
+        {
+            sprintf((char*)new_path, "%lu", (unsigned long)(j + k));
+            compose_patch(patches, (const unsigned char*)"add", path, new_path, to_items[j + k]);
+        }
+
+        i += deleted;
+        j += inserted;
+    }
+
+cleanup:
+    cJSON_free(item_hash_values);
+    cJSON_free(from_items);
+    cJSON_free(to_items);
+    cJSON_free(matched);
+    cJSON_free(new_path);
+}
+
+static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool array_diff, const item_hashes * const hashes)
 {
     if ((from == NULL) || (to == NULL))
     {
         return;
     }
 
+    /* identical subtrees don't need to be walked */
+    if ((hashes != NULL) && (hashes->entries != NULL)
+        && (get_item_hash(hashes, from, case_sensitive) == get_item_hash(hashes, to, case_sensitive))
+        && compare_json(from, to, case_sensitive))
+    {
+        return;
+    }
+
     if ((from->type & 0xFF) != (to->type & 0xFF))
     {
         compose_patch(patches, (const unsigned char*)"replace", path, 0, to);
@@ -1154,7 +2852,7 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
     switch (from->type & 0xFF)
     {
         case cJSON_Number:
-            if ((from->valueint != to->valueint) || !compare_double(from->valuedouble, to->valuedouble))
+            if ((from->valueint != to->valueint) || !cJSON_Compare(from, to, true))
             {
                 compose_patch(patches, (const unsigned char*)"replace", path, NULL, to);
             }
@@ -1170,9 +2868,26 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
         case cJSON_Array:
         {
             size_t index = 0;
-            cJSON *from_child = from->child;
-            cJSON *to_child = to->child;
-            unsigned char *new_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
+            cJSON *from_child = NULL;
+            cJSON *to_child = NULL;
+            unsigned char *new_path = NULL;
+
+            /* the elements are compared as items */
+            if (!cJSON_UnpackArray(from) || !cJSON_UnpackArray(to))
+            {
+                compose_patch(patches, (const unsigned char*)"replace", path, NULL, to);
+                return;
+            }
+
+            if (array_diff)
+            {
+                create_array_diff_patches(patches, path, from, to, case_sensitive, hashes);
+                return;
+            }
+
+            from_child = from->child;
+            to_child = to->child;
+            new_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
 
             /* generate patches for all array elements that exist in both "from" and "to" */
             for (index = 0; (from_child != NULL) && (to_child != NULL); (void)(from_child = from_child->next), (void)(to_child = to_child->next), index++)
@@ -1186,7 +2901,7 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
                     return;
                 }
                 sprintf((char*)new_path, "%s/%lu", path, (unsigned long)index); /* path of the current array element */
-                create_patches(patches, new_path, from_child, to_child, case_sensitive);
+                create_patches(patches, new_path, from_child, to_child, case_sensitive, array_diff, hashes);
             }
 
             /* remove leftover elements from 'from' that are not in 'to' */
@@ -1249,7 +2964,7 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
                     encode_string_as_pointer(new_path + path_length + 1, (unsigned char*)from_child->string);
 
                     /* create a patch for the element */
-                    create_patches(patches, new_path, from_child, to_child, case_sensitive);
+                    create_patches(patches, new_path, from_child, to_child, case_sensitive, array_diff, hashes);
                     cJSON_free(new_path);
 
                     from_child = from_child->next;
@@ -1278,9 +2993,10 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
     }
 }
 
-CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to)
+static cJSON *generate_patches(cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool array_diff)
 {
     cJSON *patches = NULL;
+    item_hashes hashes;
 
     if ((from == NULL) || (to == NULL))
     {
@@ -1288,24 +3004,31 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * con
     }
 
     patches = cJSON_CreateArray();
-    create_patches(patches, (const unsigned char*)"", from, to, false);
+    create_item_hashes(&hashes, from, to, case_sensitive);
+    create_patches(patches, (const unsigned char*)"", from, to, case_sensitive, array_diff, &hashes);
+    cJSON_free(hashes.entries);
 
     return patches;
 }
 
-CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from, cJSON * const to)
+CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to)
 {
-    cJSON *patches = NULL;
+    return generate_patches(from, to, false, false);
+}
 
-    if ((from == NULL) || (to == NULL))
-    {
-        return NULL;
-    }
+CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from, cJSON * const to)
+{
+    return generate_patches(from, to, true, false);
+}
 
-    patches = cJSON_CreateArray();
-    create_patches(patches, (const unsigned char*)"", from, to, true);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateArrayDiffPatches(cJSON * const from, cJSON * const to)
+{
+    return generate_patches(from, to, false, true);
+}
 
-    return patches;
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateArrayDiffPatchesCaseSensitive(cJSON * const from, cJSON * const to)
+{
+    return generate_patches(from, to, true, true);
 }
 
 CJSON_PUBLIC(void) cJSONUtils_SortObject(cJSON * const object)
@@ -1318,63 +3041,239 @@ CJSON_PUBLIC(void) cJSONUtils_SortObjectCaseSensitive(cJSON * const object)
     sort_object(object, true);
 }
 
-static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_bool case_sensitive)
+CJSON_PUBLIC(void) cJSONUtils_SortObjectToDepth(cJSON * const object, const int depth)
 {
-    cJSON *patch_child = NULL;
+    sort_object_recursively(object, depth, false);
+}
 
-    if (!cJSON_IsObject(patch))
+CJSON_PUBLIC(void) cJSONUtils_SortObjectToDepthCaseSensitive(cJSON * const object, const int depth)
+{
+    sort_object_recursively(object, depth, true);
+}
+
+/* An index of the members of an object by key, for looking up many keys in a large object.
+ * Removed members leave a tombstone so that probing continues past them. */
+typedef struct
+{
+    cJSON *item;
+    unsigned long hash;
+    cJSON_bool removed;
+} member_index_entry;
+
+typedef struct
+{
+    member_index_entry *entries;
+    size_t capacity; /* always a power of two */
+    cJSON_bool case_sensitive;
+} member_index;
+
+static member_index_entry *find_member_index_entry(const member_index * const index, const char * const key, const unsigned long hash)
+{
+    size_t slot = (size_t)hash & (index->capacity - 1);
+
+    while ((index->entries[slot].item != NULL) || index->entries[slot].removed)
     {
-        /* scalar value, array or NULL, just duplicate */
-        cJSON_Delete(target);
-        return cJSON_Duplicate(patch, 1);
+        const member_index_entry *entry = &index->entries[slot];
+        if ((entry->item != NULL) && (entry->hash == hash) && (compare_strings((const unsigned char*)entry->item->string, (const unsigned char*)key, index->case_sensitive) == 0))
+        {
+            break;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
     }
 
-    if (!cJSON_IsObject(target))
+    return &index->entries[slot];
+}
+
+static void add_to_member_index(member_index * const index, cJSON * const item)
+{
+    unsigned long hash = hash_string((const unsigned char*)item->string, index->case_sensitive);
+    size_t slot = (size_t)hash & (index->capacity - 1);
+
+    while (index->entries[slot].item != NULL)
     {
-        cJSON_Delete(target);
-        target = cJSON_CreateObject();
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    index->entries[slot].item = item;
+    index->entries[slot].hash = hash;
+    index->entries[slot].removed = false;
+}
+
+/* Build an index of the members of object with room for additional_members more.
+ * Fails if there is no memory or the object has duplicate keys, which only a linear search handles like cJSON_GetObjectItem. */
+static cJSON_bool create_member_index(member_index * const index, const cJSON * const object, const size_t additional_members, const cJSON_bool case_sensitive)
+{
+    cJSON *child = NULL;
+    size_t count = additional_members;
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        count++;
+    }
+
+    index->case_sensitive = case_sensitive;
+    index->capacity = 16;
+    while (index->capacity < (2 * count))
+    {
+        index->capacity *= 2;
+    }
+    index->entries = (member_index_entry*)cJSON_malloc(index->capacity * sizeof(member_index_entry));
+    if (index->entries == NULL)
+    {
+        return false;
+    }
+    memset(index->entries, '\0', index->capacity * sizeof(member_index_entry));
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if ((child->string == NULL) || (find_member_index_entry(index, child->string, hash_string((const unsigned char*)child->string, case_sensitive))->item != NULL))
+        {
+            /* duplicate key */
+            cJSON_free(index->entries);
+            index->entries = NULL;
+            return false;
+        }
+        add_to_member_index(index, child);
     }
 
-    patch_child = patch->child;
-    while (patch_child != NULL)
+    return true;
+}
+
+/* look up a member by key, either in the index or by searching the object */
+static cJSON *get_indexed_member(const member_index * const index, const cJSON * const object, const char * const key, const cJSON_bool case_sensitive)
+{
+    if (index->entries == NULL)
+    {
+        return get_object_item(object, key, case_sensitive);
+    }
+
+    return find_member_index_entry(index, key, hash_string((const unsigned char*)key, case_sensitive))->item;
+}
+
+static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_bool case_sensitive);
+
+/* apply the members of the object patch to the object target in place, members that are replaced keep their position */
+static cJSON_bool merge_patch_into_object(cJSON * const target, const cJSON * const patch, const cJSON_bool case_sensitive)
+{
+    member_index index = { NULL, 0, false };
+    const cJSON *patch_child = NULL;
+    cJSON_bool success = true;
+    size_t patch_members = 0;
+
+    for (patch_child = patch->child; patch_child != NULL; patch_child = patch_child->next)
+    {
+        patch_members++;
+    }
+    if ((patch_members > 1) && (target->child != NULL) && (target->child->next != NULL))
+    {
+        /* otherwise the keys are searched linearly */
+        create_member_index(&index, target, patch_members, case_sensitive);
+    }
+
+    for (patch_child = patch->child; success && (patch_child != NULL); patch_child = patch_child->next)
     {
+        cJSON *member = get_indexed_member(&index, target, patch_child->string, case_sensitive);
+        cJSON *replacement = NULL;
+
         if (cJSON_IsNull(patch_child))
         {
             /* NULL is the indicator to remove a value, see RFC7396 */
-            if (case_sensitive)
+            if (member != NULL)
             {
-                cJSON_DeleteItemFromObjectCaseSensitive(target, patch_child->string);
+                if (index.entries != NULL)
+                {
+                    member_index_entry *entry = find_member_index_entry(&index, member->string, hash_string((const unsigned char*)member->string, case_sensitive));
+                    entry->item = NULL;
+                    entry->removed = true;
+                }
+                cJSON_Delete(cJSON_DetachItemViaPointer(target, member));
             }
-            else
+            continue;
+        }
+
+        if (cJSON_IsObject(member) && cJSON_IsObject(patch_child))
+        {
+            /* merge nested objects in place */
+            success = merge_patch_into_object(member, patch_child, case_sensitive);
+            continue;
+        }
+
+        if ((member != NULL) && compare_json(member, patch_child, case_sensitive))
+        {
+            /* the value doesn't change, don't duplicate it */
+            continue;
+        }
+
+        replacement = merge_patch(NULL, patch_child, case_sensitive);
+        if (replacement == NULL)
+        {
+            success = false;
+            continue;
+        }
+
+        if (member != NULL)
+        {
+            /* the replacement takes over the key of the member it replaces */
+            member_index_entry *entry = (index.entries != NULL) ? find_member_index_entry(&index, member->string, hash_string((const unsigned char*)member->string, case_sensitive)) : NULL;
+
+            if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+            {
+                cJSON_free(replacement->string);
+            }
+            replacement->string = member->string;
+            replacement->type = (replacement->type & ~cJSON_StringIsConst) | (member->type & cJSON_StringIsConst);
+            member->string = NULL;
+            cJSON_ReplaceItemViaPointer(target, member, replacement);
+            if (entry != NULL)
             {
-                cJSON_DeleteItemFromObject(target, patch_child->string);
+                entry->item = replacement;
             }
         }
         else
         {
-            cJSON *replace_me = NULL;
-            cJSON *replacement = NULL;
-
-            if (case_sensitive)
+            if (!cJSON_AddItemToObject(target, patch_child->string, replacement))
             {
-                replace_me = cJSON_DetachItemFromObjectCaseSensitive(target, patch_child->string);
+                cJSON_Delete(replacement);
+                success = false;
+                continue;
             }
-            else
+            if (index.entries != NULL)
             {
-                replace_me = cJSON_DetachItemFromObject(target, patch_child->string);
+                add_to_member_index(&index, replacement);
             }
+        }
+    }
 
-            replacement = merge_patch(replace_me, patch_child, case_sensitive);
-            if (replacement == NULL)
-            {
-                cJSON_Delete(target);
-                return NULL;
-            }
+    cJSON_free(index.entries);
+
+    return success;
+}
+
+static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_bool case_sensitive)
+{
+    if (!cJSON_IsObject(patch))
+    {
+        /* scalar value, array or NULL, just duplicate */
+        cJSON_Delete(target);
+        return cJSON_Duplicate(patch, 1);
+    }
 
-            cJSON_AddItemToObject(target, patch_child->string, replacement);
+    if (!cJSON_IsObject(target))
+    {
+        cJSON_Delete(target);
+        target = cJSON_CreateObject();
+        if (target == NULL)
+        {
+            return NULL;
         }
-        patch_child = patch_child->next;
     }
+
+    if (!merge_patch_into_object(target, patch, case_sensitive))
+    {
+        cJSON_Delete(target);
+        return NULL;
+    }
+
     return target;
 }
 
@@ -1388,79 +3287,187 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchCaseSensitive(cJSON *target, const cJ
     return merge_patch(target, patch, true);
 }
 
-static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive)
+/* where generate_merge_patch puts its output, either a cJSON tree or a writer */
+typedef struct
 {
-    cJSON *from_child = NULL;
-    cJSON *to_child = NULL;
-    cJSON *patch = NULL;
-    if (to == NULL)
+    cJSON_Writer *writer; /* NULL when building a tree */
+    const item_hashes *hashes;
+    cJSON_bool case_sensitive;
+} merge_patch_output;
+
+static cJSON_bool add_merge_patch_members(cJSON * const patch, const cJSON * const from, const cJSON * const to, const merge_patch_output * const output, size_t * const emitted);
+
+static cJSON_bool write_text(const merge_patch_output * const output, const char * const text)
+{
+    return cJSON_WriteText(output->writer, text, strlen(text));
+}
+
+/* write a string with the escaping of the printer, without copying it */
+static cJSON_bool write_string(const merge_patch_output * const output, char * const string)
+{
+    cJSON string_item;
+
+    memset(&string_item, '\0', sizeof(string_item));
+    string_item.type = cJSON_String;
+    string_item.valuestring = string;
+
+    return cJSON_WriteItem(output->writer, &string_item);
+}
+
+static cJSON_bool values_are_identical(const cJSON * const from, const cJSON * const to, const merge_patch_output * const output)
+{
+    if (from == to)
     {
-        /* patch to delete everything */
-        return cJSON_CreateNull();
+        return true;
     }
-    if (!cJSON_IsObject(to) || !cJSON_IsObject(from))
+
+    if ((output->hashes != NULL) && (output->hashes->entries != NULL)
+        && (get_item_hash(output->hashes, from, output->case_sensitive) != get_item_hash(output->hashes, to, output->case_sensitive)))
     {
-        return cJSON_Duplicate(to, 1);
+        return false;
     }
 
-    sort_object(from, case_sensitive);
-    sort_object(to, case_sensitive);
+    return compare_json(from, to, output->case_sensitive);
+}
 
-    from_child = from->child;
-    to_child = to->child;
-    patch = cJSON_CreateObject();
-    if (patch == NULL)
-    {
-        return NULL;
-    }
-    while (from_child || to_child)
+/* add one member to the patch: null if to is NULL, the merge patch of from and to if both are objects, otherwise to */
+static cJSON_bool add_merge_patch_member(cJSON * const patch, char * const key, const cJSON * const from, const cJSON * const to, const merge_patch_output * const output, size_t * const emitted)
+{
+    cJSON_bool nested = (from != NULL) && cJSON_IsObject(from) && cJSON_IsObject(to);
+    cJSON *value = NULL;
+
+    if (output->writer != NULL)
     {
-        int diff;
-        if (from_child != NULL)
+        size_t nested_members = 0;
+
+        if (((*emitted > 0) && !write_text(output, ",")) || !write_string(output, key) || !write_text(output, ":"))
+        {
+            return false;
+        }
+
+        if (to == NULL)
         {
-            if (to_child != NULL)
+            if (!write_text(output, "null"))
             {
-                diff = strcmp(from_child->string, to_child->string);
+                return false;
             }
-            else
+        }
+        else if (nested)
+        {
+            if (!write_text(output, "{") || !add_merge_patch_members(NULL, from, to, output, &nested_members) || !write_text(output, "}"))
             {
-                diff = -1;
+                return false;
             }
         }
-        else
+        else if (!cJSON_WriteItem(output->writer, to))
         {
-            diff = 1;
+            return false;
         }
 
-        if (diff < 0)
-        {
-            /* from has a value that to doesn't have -> remove */
-            cJSON_AddItemToObject(patch, from_child->string, cJSON_CreateNull());
+        (*emitted)++;
+        return true;
+    }
 
-            from_child = from_child->next;
-        }
-        else if (diff > 0)
-        {
-            /* to has a value that from doesn't have -> add to patch */
-            cJSON_AddItemToObject(patch, to_child->string, cJSON_Duplicate(to_child, 1));
+    if (to == NULL)
+    {
+        value = cJSON_CreateNull();
+    }
+    else if (nested)
+    {
+        size_t nested_members = 0;
 
-            to_child = to_child->next;
+        value = cJSON_CreateObject();
+        if ((value != NULL) && !add_merge_patch_members(value, from, to, output, &nested_members))
+        {
+            cJSON_Delete(value);
+            value = NULL;
         }
-        else
+    }
+    else
+    {
+        value = cJSON_Duplicate(to, 1);
+    }
+
+    if ((value == NULL) || !cJSON_AddItemToObject(patch, key, value))
+    {
+        cJSON_Delete(value);
+        return false;
+    }
+
+    (*emitted)++;
+    return true;
+}
+
+/* add the members that turn the object from into the object to, members are matched by key through an index for large objects */
+static cJSON_bool add_merge_patch_members(cJSON * const patch, const cJSON * const from, const cJSON * const to, const merge_patch_output * const output, size_t * const emitted)
+{
+    member_index from_index = { NULL, 0, false };
+    member_index to_index = { NULL, 0, false };
+    const cJSON *child = NULL;
+    cJSON_bool success = true;
+
+    if ((from->child != NULL) && (from->child->next != NULL) && (to->child != NULL) && (to->child->next != NULL))
+    {
+        /* otherwise the keys are searched linearly */
+        create_member_index(&from_index, from, 0, output->case_sensitive);
+        create_member_index(&to_index, to, 0, output->case_sensitive);
+    }
+
+    /* from has a value that to doesn't have -> remove */
+    for (child = from->child; success && (child != NULL); child = child->next)
+    {
+        if (get_indexed_member(&to_index, to, child->string, output->case_sensitive) == NULL)
         {
-            /* object key exists in both objects */
-            if (!compare_json(from_child, to_child, case_sensitive))
-            {
-                /* not identical --> generate a patch */
-                cJSON_AddItemToObject(patch, to_child->string, cJSONUtils_GenerateMergePatch(from_child, to_child));
-            }
+            success = add_merge_patch_member(patch, child->string, NULL, NULL, output, emitted);
+        }
+    }
 
-            /* next key in the object */
-            from_child = from_child->next;
-            to_child = to_child->next;
+    for (child = to->child; success && (child != NULL); child = child->next)
+    {
+        const cJSON *from_child = get_indexed_member(&from_index, from, child->string, output->case_sensitive);
+        if ((from_child == NULL) || !values_are_identical(from_child, child, output))
+        {
+            success = add_merge_patch_member(patch, child->string, from_child, child, output, emitted);
         }
     }
-    if (patch->child == NULL)
+
+    cJSON_free(from_index.entries);
+    cJSON_free(to_index.entries);
+
+    return success;
+}
+
+static cJSON *generate_merge_patch(const cJSON * const from, const cJSON * const to, const cJSON_bool case_sensitive)
+{
+    merge_patch_output output = { NULL, NULL, false };
+    item_hashes hashes;
+    cJSON *patch = NULL;
+    size_t emitted = 0;
+    cJSON_bool success = false;
+
+    if (to == NULL)
+    {
+        /* patch to delete everything */
+        return cJSON_CreateNull();
+    }
+    if (!cJSON_IsObject(to) || !cJSON_IsObject(from))
+    {
+        return cJSON_Duplicate(to, 1);
+    }
+
+    patch = cJSON_CreateObject();
+    if (patch == NULL)
+    {
+        return NULL;
+    }
+
+    create_item_hashes(&hashes, from, to, case_sensitive);
+    output.hashes = &hashes;
+    output.case_sensitive = case_sensitive;
+    success = add_merge_patch_members(patch, from, to, &output, &emitted);
+    cJSON_free(hashes.entries);
+
+    if (!success || (emitted == 0))
     {
         /* no patch generated */
         cJSON_Delete(patch);
@@ -1479,3 +3486,52 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchCaseSensitive(cJSON * const f
 {
     return generate_merge_patch(from, to, true);
 }
+
+static cJSON_bool print_merge_patch(const cJSON * const from, const cJSON * const to, const cJSON_bool case_sensitive, cJSON_WriteCallback write_fn, void *user_data)
+{
+    merge_patch_output output = { NULL, NULL, false };
+    item_hashes hashes;
+    size_t emitted = 0;
+    cJSON_bool success = false;
+
+    if (write_fn == NULL)
+    {
+        return false;
+    }
+
+    /* keys, values and separators all go through the buffer of one writer */
+    output.writer = cJSON_CreateWriter(false, write_fn, user_data);
+    if (output.writer == NULL)
+    {
+        return false;
+    }
+    output.case_sensitive = case_sensitive;
+
+    if (to == NULL)
+    {
+        success = write_text(&output, "null");
+    }
+    else if (!cJSON_IsObject(to) || !cJSON_IsObject(from))
+    {
+        success = cJSON_WriteItem(output.writer, to);
+    }
+    else
+    {
+        create_item_hashes(&hashes, from, to, case_sensitive);
+        output.hashes = &hashes;
+        success = write_text(&output, "{") && add_merge_patch_members(NULL, from, to, &output, &emitted) && write_text(&output, "}");
+        cJSON_free(hashes.entries);
+    }
+
+    return cJSON_CloseWriter(output.writer) && success;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_PrintMergePatch(const cJSON * const from, const cJSON * const to, cJSON_WriteCallback write_fn, void *user_data)
+{
+    return print_merge_patch(from, to, false, write_fn, user_data);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_PrintMergePatchCaseSensitive(const cJSON * const from, const cJSON * const to, cJSON_WriteCallback write_fn, void *user_data)
+{
+    return print_merge_patch(from, to, true, write_fn, user_data);
+}
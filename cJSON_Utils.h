@@ -31,55 +31,85 @@ extern "C"
 #include "cJSON.h"
 
 /* Implement RFC6901 (https://tools.ietf.org/html/rfc6901) JSON Pointer spec. */
+/* NOTE: Packed arrays (see cJSON_PackArray) that a pointer, a patch or a diff has to look into are unpacked in place,
+ * because their numbers have no items. The functions that take a const tree hash and compare them without unpacking. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointer(cJSON * const object, const char *pointer);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, const char *pointer);
 
+/* Compiled JSON pointers decode their path once, so that the same pointer can be evaluated against many documents.
+ * They resolve exactly like cJSONUtils_GetPointer. Free them with cJSONUtils_DeletePointer. */
+typedef struct cJSONUtils_Pointer cJSONUtils_Pointer;
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointer(const char * const pointer);
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointerCaseSensitive(const char * const pointer);
+CJSON_PUBLIC(void) cJSONUtils_DeletePointer(cJSONUtils_Pointer * const pointer);
+CJSON_PUBLIC(cJSON *) cJSONUtils_EvalPointer(cJSON * const object, const cJSONUtils_Pointer * const pointer);
+/* Evaluates count pointers and stores the found items (or NULL) in results.
+ * Path prefixes shared by consecutive pointers are only walked once, so pass them sorted for the best effect.
+ * Returns false on invalid arguments or allocation failure. */
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_EvalPointers(cJSON * const object, const cJSONUtils_Pointer * const * const pointers, const size_t count, cJSON ** const results);
+
 /* Implement RFC6902 (https://tools.ietf.org/html/rfc6902) JSON Patch spec. */
 /* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from, cJSON * const to);
+/* Like cJSONUtils_GeneratePatches, but arrays are diffed (Myers' algorithm) so that insertions and deletions
+ * result in "add" and "remove" operations instead of replacing every item after them.
+ * If more than CJSON_UTILS_ARRAY_DIFF_LIMIT insertions and deletions are needed, the rest of the array is patched index by index. */
+#ifndef CJSON_UTILS_ARRAY_DIFF_LIMIT
+#define CJSON_UTILS_ARRAY_DIFF_LIMIT 256
+#endif
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateArrayDiffPatches(cJSON * const from, cJSON * const to);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateArrayDiffPatchesCaseSensitive(cJSON * const from, cJSON * const to);
 /* Utility for generating patch array entries. */
 CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char * const operation, const char * const path, const cJSON * const value);
 /* Returns 0 for success. */
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches);
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches);
 
-/*
-// Note that ApplyPatches is NOT atomic on failure. To implement an atomic ApplyPatches, use:
-//int cJSONUtils_AtomicApplyPatches(cJSON **object, cJSON *patches)
-//{
-//    cJSON *modme = cJSON_Duplicate(*object, 1);
-//    int error = cJSONUtils_ApplyPatches(modme, patches);
-//    if (!error)
-//    {
-//        cJSON_Delete(*object);
-//        *object = modme;
-//    }
-//    else
-//    {
-//        cJSON_Delete(modme);
-//    }
-//
-//    return error;
-//}
-// Code not added to library since this strategy is a LOT slower.
-*/
+/* Note that ApplyPatches is NOT atomic on failure, the operations before the failing one stay applied.
+ * The Atomic variants record every modification and revert them if an operation fails,
+ * so that object is either fully patched or left unchanged. */
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomic(cJSON * const object, const cJSON * const patches);
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomicCaseSensitive(cJSON * const object, const cJSON * const patches);
 
 /* Implement RFC7386 (https://tools.ietf.org/html/rfc7396) JSON Merge Patch spec. */
 /* target will be modified by patch. return value is new ptr for target. */
+/* Members of target that are replaced keep their position, new members are appended. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatch(cJSON *target, const cJSON * const patch);
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchCaseSensitive(cJSON *target, const cJSON * const patch);
-/* generates a patch to move from -> to */
-/* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
+/* generates a patch to move from -> to, returns NULL if they are equal */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatch(cJSON * const from, cJSON * const to);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchCaseSensitive(cJSON * const from, cJSON * const to);
+/* Print the merge patch from -> to unformatted to write_fn, without building it as a cJSON tree.
+ * Prints {} if from and to are equal. Returns 1 on success. */
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_PrintMergePatch(const cJSON * const from, const cJSON * const to, cJSON_WriteCallback write_fn, void *user_data);
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_PrintMergePatchCaseSensitive(const cJSON * const from, const cJSON * const to, cJSON_WriteCallback write_fn, void *user_data);
 
 /* Given a root object and a target object, construct a pointer from one to the other. */
 CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const object, const cJSON * const target);
+/* An index of the parent of every item in a tree, which constructs the pointer to any item in O(depth).
+ * The index is only valid as long as the tree isn't modified. Free it with cJSONUtils_DeletePointerIndex. */
+typedef struct cJSONUtils_PointerIndex cJSONUtils_PointerIndex;
+CJSON_PUBLIC(cJSONUtils_PointerIndex *) cJSONUtils_CreatePointerIndex(const cJSON * const object);
+CJSON_PUBLIC(void) cJSONUtils_DeletePointerIndex(cJSONUtils_PointerIndex * const index);
+CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromIndex(const cJSONUtils_PointerIndex * const index, const cJSON * const target);
+/* Construct the pointers to count targets with a single traversal of object.
+ * pointers[i] is NULL if targets[i] wasn't found, the others have to be freed with cJSON_free. */
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_FindPointersFromObjectTo(const cJSON * const object, const cJSON * const * const targets, const size_t count, char ** const pointers);
+
+/* Structural hash of an item and its children, the order of object members doesn't matter.
+ * Items that cJSON_Compare considers equal have the same hash, except for numbers that differ only in the
+ * lowest bits and happen to round differently to 30 bits of mantissa. Use it to find candidates for duplicates. */
+CJSON_PUBLIC(unsigned long) cJSONUtils_Hash(const cJSON * const item);
+CJSON_PUBLIC(unsigned long) cJSONUtils_HashCaseSensitive(const cJSON * const item);
 
 /* Sorts the members of the object into alphabetical order. */
 CJSON_PUBLIC(void) cJSONUtils_SortObject(cJSON * const object);
 CJSON_PUBLIC(void) cJSONUtils_SortObjectCaseSensitive(cJSON * const object);
+/* Also sorts the objects nested in object (including inside of arrays) up to depth levels below it.
+ * A depth of 0 only sorts object itself, like cJSONUtils_SortObject. */
+CJSON_PUBLIC(void) cJSONUtils_SortObjectToDepth(cJSON * const object, const int depth);
+CJSON_PUBLIC(void) cJSONUtils_SortObjectToDepthCaseSensitive(cJSON * const object, const int depth);
 
 #ifdef __cplusplus
 }
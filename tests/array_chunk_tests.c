@@ -0,0 +1,214 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+#define MAX_CHUNKS 16
+
+/* parses the chunks back to front to show that they don't depend on each other, then joins them in order */
+static cJSON *parse_in_chunks(const char *json, size_t length, int max_chunks, const char **parse_end)
+{
+    size_t chunk_starts[MAX_CHUNKS];
+    cJSON *chunks[MAX_CHUNKS];
+    const char *chunk_ends[MAX_CHUNKS];
+    cJSON *array = NULL;
+    int chunk_count = cJSON_SplitArray(json, length, chunk_starts, max_chunks);
+    int i = 0;
+
+    TEST_ASSERT_TRUE((chunk_count >= 1) && (chunk_count <= max_chunks));
+    for (i = chunk_count - 1; i >= 0; i--)
+    {
+        chunk_ends[i] = NULL;
+        chunks[i] = cJSON_ParseArrayChunk(json, length, chunk_starts, chunk_count, i, &chunk_ends[i]);
+    }
+
+    for (i = 0; i < chunk_count; i++)
+    {
+        if (chunks[i] == NULL)
+        {
+            /* the first chunk that failed has the error */
+            *parse_end = chunk_ends[i];
+            cJSON_Delete(array);
+            array = NULL;
+            break;
+        }
+        if (array == NULL)
+        {
+            array = chunks[i];
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(cJSON_AppendArrayChunk(array, chunks[i]));
+        }
+        chunks[i] = NULL;
+        *parse_end = chunk_ends[i];
+    }
+
+    for (i = 0; i < chunk_count; i++)
+    {
+        cJSON_Delete(chunks[i]);
+    }
+
+    return array;
+}
+
+static void assert_parsed_with_length_like_serial_parser(const char *json, size_t length)
+{
+    const char *serial_end = NULL;
+    cJSON *serial = cJSON_ParseWithLengthOpts(json, length, &serial_end, false);
+    int max_chunks = 0;
+
+    for (max_chunks = 1; max_chunks <= MAX_CHUNKS; max_chunks++)
+    {
+        const char *parse_end = NULL;
+        cJSON *parsed = parse_in_chunks(json, length, max_chunks, &parse_end);
+
+        TEST_ASSERT_TRUE(serial_end == parse_end);
+        if (serial == NULL)
+        {
+            TEST_ASSERT_NULL(parsed);
+        }
+        else
+        {
+            char *printed = cJSON_PrintUnformatted(parsed);
+            char *serial_printed = cJSON_PrintUnformatted(serial);
+
+            TEST_ASSERT_EQUAL_STRING(serial_printed, printed);
+            TEST_ASSERT_TRUE(cJSON_GetArraySize(parsed) == 0 || (cJSON_GetArrayItem(parsed, 0)->prev == cJSON_GetArrayItem(parsed, cJSON_GetArraySize(parsed) - 1)));
+
+            cJSON_free(printed);
+            cJSON_free(serial_printed);
+        }
+        cJSON_Delete(parsed);
+    }
+
+    cJSON_Delete(serial);
+}
+
+static void assert_parsed_like_serial_parser(const char *json)
+{
+    assert_parsed_with_length_like_serial_parser(json, strlen(json) + sizeof(""));
+}
+
+static void chunks_should_parse_like_the_serial_parser(void)
+{
+    assert_parsed_like_serial_parser("[]");
+    assert_parsed_like_serial_parser(" \t[ ] ");
+    assert_parsed_like_serial_parser("[1]");
+    assert_parsed_like_serial_parser("[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20]");
+    assert_parsed_like_serial_parser("\xEF\xBB\xBF[ 1 , 2 , 3 ]trailing");
+    assert_parsed_like_serial_parser("[\"a,b\",\"c\\\",d\",{\"e\":[1,2],\"f,\":{}},[[3,4],[]],\"]\",null,true,false,-1.5e3]");
+}
+
+static void chunks_should_report_errors_like_the_serial_parser(void)
+{
+    assert_parsed_like_serial_parser("");
+    assert_parsed_like_serial_parser("[");
+    assert_parsed_like_serial_parser("[1,2,x,4,5,6]");
+    assert_parsed_like_serial_parser("[1,2,3,4,5,6,]");
+    assert_parsed_like_serial_parser("[1,2 3,4,5,6]");
+    assert_parsed_like_serial_parser("[1,[2,3},4,5,6]");
+    assert_parsed_like_serial_parser("[1,2,3,4,5,6");
+    assert_parsed_like_serial_parser("[1,\"2,3,4,5,6]");
+    assert_parsed_like_serial_parser("[1,2,3,{\"a\" 4},5,6]");
+    /* not arrays */
+    assert_parsed_like_serial_parser(" {\"a\":[1,2]");
+    assert_parsed_like_serial_parser("\"[1,2]");
+    assert_parsed_like_serial_parser("x[1,2]");
+    /* a trailing comma at the end of the buffer */
+    assert_parsed_with_length_like_serial_parser("[1,2,3,", 7);
+    assert_parsed_with_length_like_serial_parser("[1,2,3, ", 8);
+    assert_parsed_with_length_like_serial_parser("[1,2,3,4,5,6", 12);
+}
+
+static void chunks_should_parse_big_arrays(void)
+{
+    char json[20000];
+    size_t offset = 0;
+    int i = 0;
+
+    json[offset++] = '[';
+    for (i = 0; i < 300; i++)
+    {
+        offset += (size_t)sprintf(json + offset, "%s{\"id\":%d,\"name\":\"n,\\\"%d]\",\"v\":[%d.5,{}]}", (i > 0) ? ", " : "", i, i, i);
+    }
+    json[offset++] = ']';
+    json[offset] = '\0';
+    TEST_ASSERT_TRUE(offset < sizeof(json));
+
+    assert_parsed_like_serial_parser(json);
+}
+
+static void split_array_should_limit_the_number_of_chunks(void)
+{
+    const char json[] = "[1,2,3,4,5,6,7,8]";
+    size_t chunk_starts[4];
+    const char *parse_end = NULL;
+
+    TEST_ASSERT_EQUAL_INT(4, cJSON_SplitArray(json, sizeof(json), chunk_starts, 4));
+    TEST_ASSERT_EQUAL_UINT(0, chunk_starts[0]);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_SplitArray(json, sizeof(json), chunk_starts, 1));
+    TEST_ASSERT_EQUAL_INT(1, cJSON_SplitArray("\"[1,2]\"", 8, chunk_starts, 4));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_SplitArray(json, sizeof(json), chunk_starts, 0));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_SplitArray(NULL, 1, chunk_starts, 4));
+    TEST_ASSERT_NULL(cJSON_ParseArrayChunk(json, sizeof(json), chunk_starts, 1, 1, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseArrayChunk(" {}", 4, chunk_starts, 1, 0, &parse_end));
+    TEST_ASSERT_TRUE(*parse_end == '{');
+    TEST_ASSERT_EQUAL_INT(3, cJSON_SplitArray("[1,2,3,", 7, chunk_starts, 8));
+    TEST_ASSERT_EQUAL_UINT(5, chunk_starts[2]);
+}
+
+static void append_array_chunk_should_join_arrays(void)
+{
+    cJSON *array = cJSON_Parse("[1]");
+    cJSON *printed_array = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_AppendArrayChunk(array, cJSON_Parse("[2,3]")));
+    TEST_ASSERT_TRUE(cJSON_AppendArrayChunk(array, cJSON_Parse("[]")));
+    TEST_ASSERT_TRUE(cJSON_AppendArrayChunk(array, cJSON_Parse("[4]")));
+    TEST_ASSERT_FALSE(cJSON_AppendArrayChunk(array, array));
+    TEST_ASSERT_FALSE(cJSON_AppendArrayChunk(NULL, NULL));
+
+    printed_array = cJSON_CreateArray();
+    TEST_ASSERT_TRUE(cJSON_AppendArrayChunk(printed_array, array));
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(printed_array, cJSON_CreateNumber(5)));
+    printed = cJSON_PrintUnformatted(printed_array);
+    TEST_ASSERT_EQUAL_STRING("[1,2,3,4,5]", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(printed_array);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(chunks_should_parse_like_the_serial_parser);
+    RUN_TEST(chunks_should_report_errors_like_the_serial_parser);
+    RUN_TEST(chunks_should_parse_big_arrays);
+    RUN_TEST(split_array_should_limit_the_number_of_chunks);
+    RUN_TEST(append_array_chunk_should_join_arrays);
+
+    return UNITY_END();
+}
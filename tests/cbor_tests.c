@@ -0,0 +1,288 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_encodes_to(const cJSON * const item, const unsigned char * const expected, const size_t expected_length)
+{
+    size_t length = 0;
+    unsigned char *encoded = cJSON_PrintCBOR(item, &length);
+
+    TEST_ASSERT_NOT_NULL(encoded);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, encoded, expected_length);
+
+    cJSON_free(encoded);
+}
+
+static void assert_json_encodes_to(const char * const json, const unsigned char * const expected, const size_t expected_length)
+{
+    cJSON *item = cJSON_Parse(json);
+
+    TEST_ASSERT_NOT_NULL(item);
+    assert_encodes_to(item, expected, expected_length);
+
+    cJSON_Delete(item);
+}
+
+static void assert_decodes_to(const unsigned char * const encoded, const size_t length, const char * const expected)
+{
+    cJSON *item = cJSON_ParseCBOR(encoded, length, NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void assert_round_trip(const cJSON * const item)
+{
+    size_t length = 0;
+    unsigned char *encoded = cJSON_PrintCBOR(item, &length);
+    cJSON *decoded = NULL;
+
+    TEST_ASSERT_NOT_NULL(encoded);
+    decoded = cJSON_ParseCBOR(encoded, length, NULL);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_Compare(item, decoded, true));
+
+    cJSON_Delete(decoded);
+    cJSON_free(encoded);
+}
+
+static void cbor_should_encode_rfc_examples(void)
+{
+    static const unsigned char zero[] = { 0x00 };
+    static const unsigned char twenty_three[] = { 0x17 };
+    static const unsigned char twenty_four[] = { 0x18, 0x18 };
+    static const unsigned char thousand[] = { 0x19, 0x03, 0xe8 };
+    static const unsigned char million[] = { 0x1a, 0x00, 0x0f, 0x42, 0x40 };
+    static const unsigned char trillion[] = { 0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00 };
+    static const unsigned char minus_one[] = { 0x20 };
+    static const unsigned char minus_thousand[] = { 0x39, 0x03, 0xe7 };
+    static const unsigned char one_and_a_half[] = { 0xfa, 0x3f, 0xc0, 0x00, 0x00 };
+    static const unsigned char one_point_one[] = { 0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a };
+    static const unsigned char literals[] = { 0x83, 0xf4, 0xf5, 0xf6 };
+    static const unsigned char string[] = { 0x64, 0x49, 0x45, 0x54, 0x46 };
+    static const unsigned char object[] = { 0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x03 };
+
+    assert_json_encodes_to("0", zero, sizeof(zero));
+    assert_json_encodes_to("23", twenty_three, sizeof(twenty_three));
+    assert_json_encodes_to("24", twenty_four, sizeof(twenty_four));
+    assert_json_encodes_to("1000", thousand, sizeof(thousand));
+    assert_json_encodes_to("1000000", million, sizeof(million));
+    assert_json_encodes_to("1000000000000", trillion, sizeof(trillion));
+    assert_json_encodes_to("-1", minus_one, sizeof(minus_one));
+    assert_json_encodes_to("-1000", minus_thousand, sizeof(minus_thousand));
+    assert_json_encodes_to("1.5", one_and_a_half, sizeof(one_and_a_half));
+    assert_json_encodes_to("1.1", one_point_one, sizeof(one_point_one));
+    assert_json_encodes_to("[false,true,null]", literals, sizeof(literals));
+    assert_json_encodes_to("\"IETF\"", string, sizeof(string));
+    assert_json_encodes_to("{\"a\":1,\"b\":[2,3]}", object, sizeof(object));
+}
+
+static void cbor_should_decode_rfc_examples(void)
+{
+    static const unsigned char half_one[] = { 0xf9, 0x3c, 0x00 };
+    static const unsigned char half_max[] = { 0xf9, 0x7b, 0xff };
+    static const unsigned char half_negative[] = { 0xf9, 0xc4, 0x00 };
+    static const unsigned char big_negative[] = { 0x3b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x0f, 0xff };
+    static const unsigned char indefinite_array[] = { 0x9f, 0x01, 0x82, 0x02, 0x03, 0x9f, 0x04, 0x05, 0xff, 0xff };
+    static const unsigned char indefinite_map[] = { 0xbf, 0x61, 0x61, 0x01, 0x61, 0x62, 0x9f, 0x02, 0x03, 0xff, 0xff };
+    static const unsigned char indefinite_string[] = { 0x7f, 0x65, 0x73, 0x74, 0x72, 0x65, 0x61, 0x64, 0x6d, 0x69, 0x6e, 0x67, 0xff };
+    static const unsigned char tagged[] = { 0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0 };
+    static const unsigned char undefined[] = { 0xf7 };
+
+    assert_decodes_to(half_one, sizeof(half_one), "1");
+    assert_decodes_to(half_max, sizeof(half_max), "65504");
+    assert_decodes_to(half_negative, sizeof(half_negative), "-4");
+    assert_decodes_to(big_negative, sizeof(big_negative), "-1000000000000");
+    assert_decodes_to(indefinite_array, sizeof(indefinite_array), "[1,[2,3],[4,5]]");
+    assert_decodes_to(indefinite_map, sizeof(indefinite_map), "{\"a\":1,\"b\":[2,3]}");
+    assert_decodes_to(indefinite_string, sizeof(indefinite_string), "\"streaming\"");
+    assert_decodes_to(tagged, sizeof(tagged), "1363896240");
+    assert_decodes_to(undefined, sizeof(undefined), "null");
+}
+
+static void cbor_should_round_trip_raw_items(void)
+{
+    static const unsigned char encoded[] = { 0xd9, 0x01, 0x06, 0x47, 0x5b, 0x31, 0x2c, 0x20, 0x32, 0x2c, 0x5d };
+    cJSON *raw = cJSON_CreateRaw("[1, 2,]");
+    cJSON *decoded = NULL;
+
+    TEST_ASSERT_NOT_NULL(raw);
+    assert_encodes_to(raw, encoded, sizeof(encoded));
+
+    decoded = cJSON_ParseCBOR(encoded, sizeof(encoded), NULL);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(decoded));
+    TEST_ASSERT_EQUAL_STRING("[1, 2,]", decoded->valuestring);
+
+    cJSON_Delete(decoded);
+    cJSON_Delete(raw);
+}
+
+static void cbor_should_round_trip_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(inputs) / sizeof(inputs[0])); i++)
+    {
+        char *json = read_file(inputs[i]);
+        cJSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(json, inputs[i]);
+        item = cJSON_Parse(json);
+        if (item != NULL)
+        {
+            assert_round_trip(item);
+            cJSON_Delete(item);
+        }
+        free(json);
+    }
+}
+
+static void cbor_should_round_trip_numbers(void)
+{
+    static const double numbers[] = { 0.0, 1.0, -1.0, 255.0, 256.0, 65535.0, 65536.0, 4294967295.0, 4294967296.0, -4294967297.0,
+        9007199254740992.0, -9007199254740992.0, 1e300, -1e-300, 0.1, 3.25, 123456.789 };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(numbers) / sizeof(numbers[0])); i++)
+    {
+        cJSON *number = cJSON_CreateNumber(numbers[i]);
+        size_t length = 0;
+        unsigned char *encoded = NULL;
+        cJSON *decoded = NULL;
+
+        TEST_ASSERT_NOT_NULL(number);
+        encoded = cJSON_PrintCBOR(number, &length);
+        TEST_ASSERT_NOT_NULL(encoded);
+        decoded = cJSON_ParseCBOR(encoded, length, NULL);
+        TEST_ASSERT_NOT_NULL(decoded);
+        TEST_ASSERT_TRUE(decoded->valuedouble == numbers[i]);
+        TEST_ASSERT_EQUAL_INT(number->valueint, decoded->valueint);
+
+        cJSON_Delete(decoded);
+        cJSON_free(encoded);
+        cJSON_Delete(number);
+    }
+}
+
+static void cbor_should_reject_invalid_input(void)
+{
+    static const unsigned char truncated_argument[] = { 0x19, 0x01 };
+    static const unsigned char truncated_string[] = { 0x63, 0x61, 0x62 };
+    static const unsigned char truncated_array[] = { 0x83, 0x01, 0x02 };
+    static const unsigned char huge_array[] = { 0x9b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+    static const unsigned char integer_key[] = { 0xa1, 0x01, 0x02 };
+    static const unsigned char byte_string[] = { 0x41, 0x00 };
+    static const unsigned char lone_break[] = { 0xff };
+    static const unsigned char missing_break[] = { 0x9f, 0x01 };
+    static const unsigned char mixed_chunks[] = { 0x7f, 0x41, 0x61, 0xff };
+    static const unsigned char reserved[] = { 0x1c };
+    static const unsigned char simple_value[] = { 0xf0 };
+    static const unsigned char trailing[] = { 0x01, 0x02 };
+    static const unsigned char nested_byte_string[] = { 0x82, 0x01, 0x41, 0x00 };
+    unsigned char *nested = NULL;
+    const unsigned char *end = NULL;
+    cJSON *item = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_argument, sizeof(truncated_argument), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_string, sizeof(truncated_string), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_array, sizeof(truncated_array), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(huge_array, sizeof(huge_array), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(integer_key, sizeof(integer_key), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(byte_string, sizeof(byte_string), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(lone_break, sizeof(lone_break), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(missing_break, sizeof(missing_break), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(mixed_chunks, sizeof(mixed_chunks), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(reserved, sizeof(reserved), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(simple_value, sizeof(simple_value), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(trailing, sizeof(trailing), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(NULL, 1, NULL));
+
+    /* trailing data is left to the caller when it asks for the end */
+    item = cJSON_ParseCBOR(trailing, sizeof(trailing), &end);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_PTR(trailing + 1, end);
+    cJSON_Delete(item);
+
+    /* the error position is the offending byte string */
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(nested_byte_string, sizeof(nested_byte_string), &end));
+    TEST_ASSERT_EQUAL_PTR(nested_byte_string + 2, end);
+
+    /* nesting limit */
+    nested = (unsigned char*)malloc(CJSON_NESTING_LIMIT + 2);
+    TEST_ASSERT_NOT_NULL(nested);
+    for (i = 0; i <= CJSON_NESTING_LIMIT; i++)
+    {
+        nested[i] = 0x81;
+    }
+    nested[CJSON_NESTING_LIMIT + 1] = 0x00;
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(nested, CJSON_NESTING_LIMIT + 2, NULL));
+    item = cJSON_ParseCBOR(nested + 1, CJSON_NESTING_LIMIT + 1, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    cJSON_Delete(item);
+    free(nested);
+}
+
+static void cbor_should_reject_invalid_items(void)
+{
+    cJSON invalid;
+    size_t length = 0;
+
+    memset(&invalid, 0, sizeof(invalid));
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(&invalid, &length));
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(NULL, &length));
+
+    invalid.type = cJSON_Raw;
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(&invalid, &length));
+
+    invalid.type = cJSON_Number;
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(&invalid, NULL));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(cbor_should_encode_rfc_examples);
+    RUN_TEST(cbor_should_decode_rfc_examples);
+    RUN_TEST(cbor_should_round_trip_raw_items);
+    RUN_TEST(cbor_should_round_trip_test_inputs);
+    RUN_TEST(cbor_should_round_trip_numbers);
+    RUN_TEST(cbor_should_reject_invalid_input);
+    RUN_TEST(cbor_should_reject_invalid_items);
+
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const char records_json[] =
+    "[{\"id\":1,\"name\":\"a\",\"ok\":true,\"extra\":{\"x\":[1,2]}},"
+    "{\"name\":\"b\\u00e4\",\"id\":2.5,\"ok\":false},"
+    "{\"id\":\"3\",\"ok\":null,\"name\":\"c\",\"name\":\"ignored\"},"
+    "42,"
+    "{\"id\":[4],\"n\\u0061me\":\"d\"}]";
+
+static void initialize_columns(cJSON_Column * const columns)
+{
+    memset(columns, '\0', 3 * sizeof(cJSON_Column));
+    columns[0].name = "id";
+    columns[0].type = cJSON_Number;
+    columns[1].name = "name";
+    columns[1].type = cJSON_String;
+    columns[2].name = "ok";
+    columns[2].type = cJSON_True;
+}
+
+static void assert_columns(const cJSON_Column * const columns, const size_t record_count)
+{
+    TEST_ASSERT_EQUAL_UINT(5, record_count);
+
+    TEST_ASSERT_EQUAL_DOUBLE(1, columns[0].numbers[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(2.5, columns[0].numbers[1]);
+    TEST_ASSERT_EQUAL_DOUBLE(0, columns[0].numbers[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x1C, columns[0].nulls[0]);
+
+    TEST_ASSERT_EQUAL_STRING("a", columns[1].strings + columns[1].string_offsets[0]);
+    TEST_ASSERT_EQUAL_STRING("b\xC3\xA4", columns[1].strings + columns[1].string_offsets[1]);
+    TEST_ASSERT_EQUAL_STRING("c", columns[1].strings + columns[1].string_offsets[2]);
+    TEST_ASSERT_EQUAL_STRING("", columns[1].strings + columns[1].string_offsets[3]);
+    TEST_ASSERT_EQUAL_STRING("d", columns[1].strings + columns[1].string_offsets[4]);
+    TEST_ASSERT_EQUAL_UINT(11, columns[1].string_offsets[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x08, columns[1].nulls[0]);
+
+    TEST_ASSERT_EQUAL_DOUBLE(1, columns[2].numbers[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(0, columns[2].numbers[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x1C, columns[2].nulls[0]);
+}
+
+static void extract_columns_should_extract_records(void)
+{
+    cJSON_Column columns[3];
+    cJSON *records = cJSON_Parse(records_json);
+    size_t record_count = 0;
+
+    TEST_ASSERT_NOT_NULL(records);
+    initialize_columns(columns);
+    TEST_ASSERT_TRUE(cJSON_ExtractColumns(records, columns, 3, &record_count));
+    assert_columns(columns, record_count);
+
+    cJSON_FreeColumns(columns, 3);
+    TEST_ASSERT_NULL(columns[0].numbers);
+    TEST_ASSERT_NULL(columns[1].strings);
+    cJSON_Delete(records);
+}
+
+static void extract_columns_from_text_should_match_tree(void)
+{
+    cJSON_Column columns[3];
+    size_t record_count = 0;
+
+    initialize_columns(columns);
+    TEST_ASSERT_TRUE(cJSON_ExtractColumnsFromText(records_json, sizeof(records_json), columns, 3, &record_count));
+    assert_columns(columns, record_count);
+    cJSON_FreeColumns(columns, 3);
+}
+
+static void extract_columns_should_grow(void)
+{
+    cJSON_Column columns[3];
+    cJSON *records = cJSON_CreateArray();
+    char *printed = NULL;
+    size_t record_count = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 1000; i++)
+    {
+        cJSON *record = cJSON_CreateObject();
+        cJSON_AddNumberToObject(record, "id", (double)i);
+        cJSON_AddStringToObject(record, "name", (i % 2) ? "odd" : "even");
+        cJSON_AddItemToArray(records, record);
+    }
+    printed = cJSON_PrintUnformatted(records);
+    TEST_ASSERT_NOT_NULL(printed);
+
+    initialize_columns(columns);
+    TEST_ASSERT_TRUE(cJSON_ExtractColumnsFromText(printed, strlen(printed), columns, 3, &record_count));
+    TEST_ASSERT_EQUAL_UINT(1000, record_count);
+    for (i = 0; i < record_count; i++)
+    {
+        TEST_ASSERT_EQUAL_DOUBLE((double)i, columns[0].numbers[i]);
+        TEST_ASSERT_EQUAL_STRING((i % 2) ? "odd" : "even", columns[1].strings + columns[1].string_offsets[i]);
+        TEST_ASSERT_TRUE(((columns[2].nulls[i / 8] >> (i % 8)) & 1) != 0);
+    }
+    TEST_ASSERT_EQUAL_UINT(500 * 4 + 500 * 5, columns[1].string_offsets[record_count]);
+    cJSON_FreeColumns(columns, 3);
+
+    cJSON_free(printed);
+    cJSON_Delete(records);
+}
+
+static void extract_columns_should_handle_empty_arrays(void)
+{
+    cJSON_Column columns[3];
+    cJSON *array = cJSON_CreateArray();
+    size_t record_count = 1;
+
+    initialize_columns(columns);
+    TEST_ASSERT_TRUE(cJSON_ExtractColumns(array, columns, 3, &record_count));
+    TEST_ASSERT_EQUAL_UINT(0, record_count);
+    TEST_ASSERT_EQUAL_UINT(0, columns[1].string_offsets[0]);
+    cJSON_FreeColumns(columns, 3);
+
+    record_count = 1;
+    TEST_ASSERT_TRUE(cJSON_ExtractColumnsFromText(" [ ] ", 5, columns, 3, &record_count));
+    TEST_ASSERT_EQUAL_UINT(0, record_count);
+    cJSON_FreeColumns(columns, 3);
+
+    cJSON_Delete(array);
+}
+
+static void extract_columns_should_fail_on_invalid_input(void)
+{
+    cJSON_Column columns[3];
+    cJSON *object = cJSON_CreateObject();
+    size_t record_count = 0;
+
+    initialize_columns(columns);
+    TEST_ASSERT_FALSE(cJSON_ExtractColumns(object, columns, 3, &record_count));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumns(NULL, columns, 3, &record_count));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumns(object, columns, 3, NULL));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumnsFromText("{}", 2, columns, 3, &record_count));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumnsFromText("[{\"id\":1},{\"id\":]", 17, columns, 3, &record_count));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumnsFromText("[{\"id\":1}", 9, columns, 3, &record_count));
+    TEST_ASSERT_FALSE(cJSON_ExtractColumnsFromText("[{\"name\":\"a\",\"x\":[}]", 20, columns, 3, &record_count));
+    /* nothing is left allocated after a failure */
+    TEST_ASSERT_NULL(columns[0].numbers);
+    TEST_ASSERT_NULL(columns[1].strings);
+    TEST_ASSERT_NULL(columns[1].string_offsets);
+    TEST_ASSERT_NULL(columns[2].nulls);
+
+    columns[2].type = cJSON_Object;
+    TEST_ASSERT_FALSE(cJSON_ExtractColumnsFromText("[]", 2, columns, 3, &record_count));
+
+    cJSON_Delete(object);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(extract_columns_should_extract_records);
+    RUN_TEST(extract_columns_from_text_should_match_tree);
+    RUN_TEST(extract_columns_should_grow);
+    RUN_TEST(extract_columns_should_handle_empty_arrays);
+    RUN_TEST(extract_columns_should_fail_on_invalid_input);
+
+    return UNITY_END();
+}
@@ -0,0 +1,302 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_round_trip(const char * const json)
+{
+    cJSON *item = cJSON_Parse(json);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void large_integers_should_round_trip_exactly(void)
+{
+    assert_round_trip("9007199254740993");
+    assert_round_trip("-9007199254740993");
+    assert_round_trip("9223372036854775807");
+    assert_round_trip("-9223372036854775808");
+    assert_round_trip("18446744073709551615");
+    assert_round_trip("[12345678901234567,-1,0,2147483648,123456789012345]");
+    /* numbers that aren't 64 bit integers are printed like before */
+    assert_round_trip("1e+15");
+    assert_round_trip("1.8446744073709552e+19");
+}
+
+static void parse_number_should_keep_digits_only_when_needed(void)
+{
+    cJSON *item = cJSON_Parse("[9007199254740992, 9007199254740993, -00042, 18446744073709551616, -9223372036854775809]");
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 0)->valuestring);
+    TEST_ASSERT_EQUAL_STRING("9007199254740993", cJSON_GetArrayItem(item, 1)->valuestring);
+    TEST_ASSERT_EQUAL_DOUBLE(9007199254740992.0, cJSON_GetArrayItem(item, 1)->valuedouble);
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 2)->valuestring);
+    TEST_ASSERT_EQUAL_INT(-42, cJSON_GetArrayItem(item, 2)->valueint);
+    /* too large for 64 bits */
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 3)->valuestring);
+    TEST_ASSERT_EQUAL_DOUBLE(18446744073709551616.0, cJSON_GetArrayItem(item, 3)->valuedouble);
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 4)->valuestring);
+
+    cJSON_Delete(item);
+}
+
+static void int64_accessors_should_be_exact(void)
+{
+    const cJSON_int64 large = ((cJSON_int64)1 << 53) + 1;
+    const cJSON_int64 maximum = (((cJSON_int64)1 << 62) - 1) * 2 + 1;
+    cJSON *item = NULL;
+    char *printed = NULL;
+
+    item = cJSON_CreateInt64(large);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == large);
+    TEST_ASSERT_TRUE(cJSON_GetUInt64Value(item) == (cJSON_uint64)large);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateInt64(-maximum - 1);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("-9223372036854775808", printed);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == (-maximum - 1));
+    TEST_ASSERT_TRUE(cJSON_GetUInt64Value(item) == 0);
+    cJSON_free(printed);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateUInt64((cJSON_uint64)-1);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("18446744073709551615", printed);
+    TEST_ASSERT_TRUE(cJSON_GetUInt64Value(item) == (cJSON_uint64)-1);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == maximum);
+    cJSON_free(printed);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateInt64(-5);
+    TEST_ASSERT_NULL(item->valuestring);
+    TEST_ASSERT_EQUAL_INT(-5, item->valueint);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == -5);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateNumber(-1e30);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == (-maximum - 1));
+    TEST_ASSERT_TRUE(cJSON_GetUInt64Value(item) == 0);
+    cJSON_SetNumberValue(item, 2.75);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == 2);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateString("1");
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == 0);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(NULL) == 0);
+    cJSON_Delete(item);
+}
+
+static void changing_the_value_should_drop_the_digits(void)
+{
+    cJSON *item = cJSON_Parse("9007199254740993");
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item->valuestring);
+    cJSON_SetNumberValue(item, 5);
+    TEST_ASSERT_NULL(item->valuestring);
+    cJSON_Delete(item);
+
+    item = cJSON_Parse("9007199254740993");
+    cJSON_SetIntValue(item, 7);
+    TEST_ASSERT_NULL(item->valuestring);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("7", printed);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == 7);
+    cJSON_free(printed);
+    cJSON_Delete(item);
+
+    /* a value that rounds to the same double still replaces the digits */
+    item = cJSON_Parse("9007199254740993");
+    cJSON_SetNumberValue(item, 9007199254740992.0);
+    TEST_ASSERT_NULL(item->valuestring);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(item) == ((cJSON_int64)1 << 53));
+    cJSON_Delete(item);
+}
+
+static void exact_integers_should_be_compared_exactly(void)
+{
+    cJSON *a = cJSON_Parse("{\"id\":9007199254740993}");
+    cJSON *b = cJSON_Parse("{\"id\":9007199254740995}");
+    cJSON *copy = cJSON_Duplicate(a, true);
+    cJSON *plain = NULL;
+    cJSON *exact = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_Compare(a, copy, true));
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+    TEST_ASSERT_EQUAL_STRING("9007199254740993", cJSON_GetObjectItem(copy, "id")->valuestring);
+
+    /* a plain double is compared with the exact value, not with its rounded double */
+    plain = cJSON_CreateNumber(9007199254740992.0);
+    TEST_ASSERT_FALSE(cJSON_Compare(cJSON_GetObjectItem(a, "id"), plain, true));
+    TEST_ASSERT_FALSE(cJSON_Compare(plain, cJSON_GetObjectItem(a, "id"), true));
+    cJSON_SetNumberValue(plain, 9007199254740996.0);
+    TEST_ASSERT_FALSE(cJSON_Compare(plain, cJSON_GetObjectItem(b, "id"), true));
+    cJSON_Delete(plain);
+    plain = cJSON_CreateNumber(9007199254740994.0);
+    exact = cJSON_CreateInt64(((cJSON_int64)1 << 53) + 2);
+    TEST_ASSERT_TRUE(cJSON_Compare(plain, exact, true));
+    cJSON_Delete(exact);
+    exact = cJSON_CreateInt64(-(((cJSON_int64)1 << 53) + 2));
+    TEST_ASSERT_FALSE(cJSON_Compare(plain, exact, true));
+    cJSON_Delete(exact);
+    cJSON_Delete(plain);
+
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+    cJSON_Delete(copy);
+}
+
+static void skipped_large_integers_should_not_be_allocated(void)
+{
+    const char json[] = "{\"a\":9007199254740993,\"b\":[-18446744073709551615],\"c\":1}";
+    const char records[] = "[{\"a\":9007199254740993,\"c\":1}]";
+    const char * const members[] = { "c" };
+    const char * const raw_members[] = { "b" };
+    cJSON_Column column;
+    size_t record_count = 0;
+    cJSON *item = NULL;
+
+    item = cJSON_ParseMembers(json, sizeof(json), members, 1, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(item, "a"));
+    cJSON_Delete(item);
+
+    item = cJSON_ParseWithRawMembers(json, sizeof(json), raw_members, 1, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("[-18446744073709551615]", cJSON_GetObjectItem(item, "b")->valuestring);
+    cJSON_Delete(item);
+
+    memset(&column, '\0', sizeof(column));
+    column.name = "c";
+    column.type = cJSON_Number;
+    TEST_ASSERT_TRUE(cJSON_ExtractColumnsFromText(records, sizeof(records), &column, 1, &record_count));
+    TEST_ASSERT_EQUAL_UINT(1, record_count);
+    cJSON_FreeColumns(&column, 1);
+}
+
+static void skip_number_should_stop_where_parse_number_stops(void)
+{
+    const char * const numbers[] = {
+        "0", "-0", "123", "-9007199254740993", "18446744073709551616", "1.5", "-.5", "5.", "1e5", "1E+5", "1e-5",
+        "1e", "1e+", "1.e3", "1-2", "1..2", "1e5e5", "+1", "-", ".", "-e1", "1.5x", "0123"
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(numbers) / sizeof(numbers[0])); i++)
+    {
+        parse_buffer parsed = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+        parse_buffer skipped = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
+        cJSON number[1];
+        cJSON_bool parse_success = false;
+
+        parsed.content = (const unsigned char*)numbers[i];
+        parsed.length = strlen(numbers[i]) + sizeof("");
+        parsed.hooks = global_hooks;
+        skipped = parsed;
+        memset(number, '\0', sizeof(number));
+
+        parse_success = parse_number(number, &parsed);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(parse_success, skip_number(&skipped), numbers[i]);
+        if (parse_success)
+        {
+            TEST_ASSERT_EQUAL_UINT_MESSAGE(parsed.offset, skipped.offset, numbers[i]);
+        }
+        if (number->valuestring != NULL)
+        {
+            global_hooks.deallocate(number->valuestring);
+        }
+    }
+}
+
+static void binary_formats_should_keep_exact_integers(void)
+{
+    const char json[] = "[9007199254740993,-9223372036854775808,18446744073709551615,-9007199254740993]";
+    cJSON *item = cJSON_Parse(json);
+    cJSON *decoded = NULL;
+    unsigned char *encoded = NULL;
+    char *printed = NULL;
+    size_t length = 0;
+
+    encoded = cJSON_PrintCBOR(item, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    decoded = cJSON_ParseCBOR(encoded, length, NULL);
+    printed = cJSON_PrintUnformatted(decoded);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+    cJSON_free(printed);
+    cJSON_Delete(decoded);
+    cJSON_free(encoded);
+
+    encoded = cJSON_PrintMessagePack(item, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    decoded = cJSON_ParseMessagePack(encoded, length, NULL);
+    printed = cJSON_PrintUnformatted(decoded);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+    cJSON_free(printed);
+    cJSON_Delete(decoded);
+    cJSON_free(encoded);
+
+    cJSON_Delete(item);
+}
+
+static void get_int64_array_should_be_exact(void)
+{
+    cJSON *item = cJSON_Parse("[9007199254740993, -3]");
+    cJSON_int64 numbers[2];
+
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetInt64Array(item, numbers, 2));
+    TEST_ASSERT_TRUE(numbers[0] == ((cJSON_int64)1 << 53) + 1);
+    TEST_ASSERT_TRUE(numbers[1] == -3);
+
+    /* packed arrays only hold doubles, so they aren't used for these */
+    cJSON_Delete(item);
+    item = cJSON_ParseWithPackedArrays("[9007199254740993, -3]", 22, NULL);
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, item->type);
+    TEST_ASSERT_EQUAL_STRING("9007199254740993", item->child->valuestring);
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(large_integers_should_round_trip_exactly);
+    RUN_TEST(parse_number_should_keep_digits_only_when_needed);
+    RUN_TEST(int64_accessors_should_be_exact);
+    RUN_TEST(changing_the_value_should_drop_the_digits);
+    RUN_TEST(exact_integers_should_be_compared_exactly);
+    RUN_TEST(skipped_large_integers_should_not_be_allocated);
+    RUN_TEST(skip_number_should_stop_where_parse_number_stops);
+    RUN_TEST(binary_formats_should_keep_exact_integers);
+    RUN_TEST(get_int64_array_should_be_exact);
+
+    return UNITY_END();
+}
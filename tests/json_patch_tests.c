@@ -91,6 +91,13 @@ static cJSON_bool test_apply_patch(const cJSON * const test)
         /* excepting an error */
         TEST_ASSERT_TRUE_MESSAGE(0 != cJSONUtils_ApplyPatchesCaseSensitive(object, patch), "Test didn't fail as it's supposed to.");
 
+        /* the atomic variant has to leave the document unchanged */
+        cJSON_Delete(object);
+        object = cJSON_Duplicate(doc, true);
+        TEST_ASSERT_NOT_NULL(object);
+        TEST_ASSERT_TRUE_MESSAGE(0 != cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patch), "Test didn't fail atomically as it's supposed to.");
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(object, doc, true), "Failed patch modified the document.");
+
         successful = true;
     }
     else
@@ -103,6 +110,15 @@ static cJSON_bool test_apply_patch(const cJSON * const test)
         {
             successful = cJSON_Compare(object, expected, true);
         }
+
+        cJSON_Delete(object);
+        object = cJSON_Duplicate(doc, true);
+        TEST_ASSERT_NOT_NULL(object);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patch), "Failed to apply patches atomically.");
+        if (expected != NULL)
+        {
+            successful = successful && cJSON_Compare(object, expected, true);
+        }
     }
 
     cJSON_Delete(object);
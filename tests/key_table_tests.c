@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocation_count = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocation_count++;
+    return malloc(size);
+}
+
+static void key_table_should_share_keys_between_objects(void)
+{
+    const char json[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"n\\u0061me\":\"c\",\"id\":3}]";
+    cJSON_KeyTable *keys = cJSON_CreateKeyTable();
+    cJSON *records = NULL;
+    cJSON *first = NULL;
+    cJSON *record = NULL;
+
+    TEST_ASSERT_NOT_NULL(keys);
+    records = cJSON_ParseWithKeyTable(json, sizeof(json), keys, NULL);
+    TEST_ASSERT_NOT_NULL(records);
+
+    first = cJSON_GetArrayItem(records, 0);
+    cJSON_ArrayForEach(record, records)
+    {
+        cJSON *id = cJSON_GetObjectItemCaseSensitive(record, "id");
+        cJSON *name = cJSON_GetObjectItemCaseSensitive(record, "name");
+
+        TEST_ASSERT_NOT_NULL(id);
+        TEST_ASSERT_NOT_NULL(name);
+        TEST_ASSERT_BITS(cJSON_StringIsConst, cJSON_StringIsConst, id->type);
+        TEST_ASSERT_BITS(cJSON_StringIsConst, cJSON_StringIsConst, name->type);
+        TEST_ASSERT_TRUE(cJSON_IsNumber(id));
+        TEST_ASSERT_TRUE(cJSON_IsString(name));
+        TEST_ASSERT_EQUAL_PTR(first->child->string, id->string);
+        TEST_ASSERT_EQUAL_PTR(first->child->next->string, name->string);
+    }
+
+    TEST_ASSERT_EQUAL_PTR(first->child->next->string, cJSON_InternKey(keys, "name"));
+    TEST_ASSERT_EQUAL_STRING("c", cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(cJSON_GetArrayItem(records, 2), cJSON_InternKey(keys, "name"))));
+
+    cJSON_Delete(records);
+    cJSON_DeleteKeyTable(keys);
+}
+
+static void key_table_should_not_allocate_known_keys(void)
+{
+    const char json[] = "[{\"key\":true,\"other\":null},{\"key\":false,\"other\":null},{\"key\":true,\"other\":null}]";
+    cJSON_Hooks hooks = { counting_malloc, free };
+    cJSON_KeyTable *keys = NULL;
+    cJSON *records = NULL;
+
+    cJSON_InitHooks(&hooks);
+    keys = cJSON_CreateKeyTable();
+    TEST_ASSERT_NOT_NULL(keys);
+    /* the table, its entries and the first block of keys */
+    TEST_ASSERT_NOT_NULL(cJSON_InternKey(keys, "key"));
+    TEST_ASSERT_EQUAL_UINT(3, allocation_count);
+
+    allocation_count = 0;
+    records = cJSON_ParseWithKeyTable(json, sizeof(json), keys, NULL);
+    cJSON_InitHooks(NULL);
+
+    TEST_ASSERT_NOT_NULL(records);
+    /* one item per value and object and the array, no keys */
+    TEST_ASSERT_EQUAL_UINT(10, allocation_count);
+
+    cJSON_Delete(records);
+    cJSON_DeleteKeyTable(keys);
+    allocation_count = 0;
+}
+
+static void key_table_should_grow(void)
+{
+    cJSON_KeyTable *keys = cJSON_CreateKeyTable();
+    const char *interned[500];
+    char key[16];
+    char long_key[KEY_TABLE_BLOCK_SIZE + 10];
+    int i = 0;
+
+    TEST_ASSERT_NOT_NULL(keys);
+    for (i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        interned[i] = cJSON_InternKey(keys, key);
+        TEST_ASSERT_NOT_NULL(interned[i]);
+        TEST_ASSERT_EQUAL_STRING(key, interned[i]);
+    }
+    for (i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        TEST_ASSERT_EQUAL_PTR(interned[i], cJSON_InternKey(keys, key));
+    }
+
+    memset(long_key, 'k', sizeof(long_key) - 1);
+    long_key[sizeof(long_key) - 1] = '\0';
+    TEST_ASSERT_EQUAL_STRING(long_key, cJSON_InternKey(keys, long_key));
+    TEST_ASSERT_EQUAL_PTR(cJSON_InternKey(keys, long_key), cJSON_InternKey(keys, long_key));
+
+    TEST_ASSERT_NULL(cJSON_InternKey(NULL, "key"));
+    TEST_ASSERT_NULL(cJSON_InternKey(keys, NULL));
+
+    cJSON_DeleteKeyTable(keys);
+    cJSON_DeleteKeyTable(NULL);
+}
+
+static void key_table_should_handle_parse_errors(void)
+{
+    static const char * const invalid[] = {
+        "{\"a\":1,\"a\":}",
+        "{\"a\":1,\"b",
+        "[{\"a\":1},{\"a\\x\":2}]",
+        "{\"a\":[1,2}"
+    };
+    cJSON_KeyTable *keys = cJSON_CreateKeyTable();
+    cJSON *item = NULL;
+    const char *end = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(keys);
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        TEST_ASSERT_NULL(cJSON_ParseWithKeyTable(invalid[i], strlen(invalid[i]), keys, NULL));
+    }
+
+    /* the same error position as without a table */
+    TEST_ASSERT_NULL(cJSON_ParseWithKeyTable(invalid[2], strlen(invalid[2]), keys, &end));
+    TEST_ASSERT_EQUAL_PTR(cJSON_GetErrorPtr(), end);
+    TEST_ASSERT_NULL(cJSON_ParseWithLengthOpts(invalid[2], strlen(invalid[2]), NULL, false));
+    TEST_ASSERT_EQUAL_PTR(end, cJSON_GetErrorPtr());
+
+    /* duplicates keep pointing into the table */
+    item = cJSON_ParseWithKeyTable("{\"a\":{\"b\":1}}", 14, keys, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    {
+        cJSON *copy = cJSON_Duplicate(item, true);
+        TEST_ASSERT_NOT_NULL(copy);
+        TEST_ASSERT_EQUAL_PTR(item->child->string, copy->child->string);
+        TEST_ASSERT_TRUE(cJSON_Compare(item, copy, true));
+        cJSON_Delete(copy);
+    }
+    cJSON_Delete(item);
+
+    /* without a table it is a normal parse */
+    item = cJSON_ParseWithKeyTable("{\"a\":1}", 7, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_BITS(cJSON_StringIsConst, 0, item->child->type);
+    cJSON_Delete(item);
+
+    cJSON_DeleteKeyTable(keys);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(key_table_should_share_keys_between_objects);
+    RUN_TEST(key_table_should_not_allocate_known_keys);
+    RUN_TEST(key_table_should_grow);
+    RUN_TEST(key_table_should_handle_parse_errors);
+
+    return UNITY_END();
+}
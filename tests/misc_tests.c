@@ -515,7 +515,7 @@ static void *CJSON_CDECL failing_realloc(void *pointer, size_t size)
 
 static void ensure_should_fail_on_failed_realloc(void)
 {
-    printbuffer buffer = {NULL, 10, 0, 0, false, false, {&malloc, &free, &failing_realloc}};
+    printbuffer buffer = {NULL, 10, 0, 0, false, false, {&malloc, &free, &failing_realloc}, 0, 0, NULL};
     buffer.buffer = (unsigned char *)malloc(100);
     TEST_ASSERT_NOT_NULL(buffer.buffer);
 
@@ -525,7 +525,7 @@ static void ensure_should_fail_on_failed_realloc(void)
 static void skip_utf8_bom_should_skip_bom(void)
 {
     const unsigned char string[] = "\xEF\xBB\xBF{}";
-    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}, NULL};
     buffer.content = string;
     buffer.length = sizeof(string);
     buffer.hooks = global_hooks;
@@ -537,7 +537,7 @@ static void skip_utf8_bom_should_skip_bom(void)
 static void skip_utf8_bom_should_not_skip_bom_if_not_at_beginning(void)
 {
     const unsigned char string[] = " \xEF\xBB\xBF{}";
-    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}, NULL};
     buffer.content = string;
     buffer.length = sizeof(string);
     buffer.hooks = global_hooks;
@@ -798,6 +798,318 @@ static void cjson_parse_big_numbers_should_not_report_error(void)
     cJSON_Delete(valid_big_number_json_object2);
 }
 
+static void cjson_print_pretty_should_indent_array_elements(void)
+{
+    cJSON *root = cJSON_Parse("{\"a\":[1,[2,3]],\"b\":{\"c\":true}}");
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(root);
+    printed = cJSON_PrintPretty(root, 2, ' ');
+    TEST_ASSERT_EQUAL_STRING("{\n  \"a\": [    1,     [      2,       3    ]  ],\n  \"b\": {\n    \"c\": true\n  }\n}", printed);
+    cJSON_free(printed);
+
+    /* packed arrays are laid out the same way */
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetArrayItem(cJSON_GetObjectItem(root, "a"), 1)));
+    printed = cJSON_PrintPretty(root, 2, ' ');
+    TEST_ASSERT_EQUAL_STRING("{\n  \"a\": [    1,     [      2,       3    ]  ],\n  \"b\": {\n    \"c\": true\n  }\n}", printed);
+    cJSON_free(printed);
+
+    /* cJSON_Print keeps arrays on one line */
+    printed = cJSON_Print(root);
+    TEST_ASSERT_EQUAL_STRING("{\n\t\"a\":\t[1, [2, 3]],\n\t\"b\":\t{\n\t\t\"c\":\ttrue\n\t}\n}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(root);
+}
+
+static size_t count_nodes(const cJSON * const item)
+{
+    size_t count = 0;
+    const cJSON *child = NULL;
+
+    cJSON_ArrayForEach(child, item)
+    {
+        count += count_nodes(child);
+    }
+
+    return count + 1;
+}
+
+static void copy_nodes(const cJSON * const item, cJSON **copy)
+{
+    const cJSON *child = NULL;
+
+    memcpy(*copy, item, sizeof(cJSON));
+    (*copy)++;
+    cJSON_ArrayForEach(child, item)
+    {
+        copy_nodes(child, copy);
+    }
+}
+
+static void cjson_lookups_should_not_modify_the_tree(void)
+{
+    cJSON *tree = cJSON_Parse("{\"one\":1,\"Two\":[1,2,{\"three\":\"3\"}],\"four\":{\"five\":null}}");
+    cJSON *before = NULL;
+    cJSON *after = NULL;
+    cJSON *copy_pointer = NULL;
+    size_t node_count = 0;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+    node_count = count_nodes(tree);
+    before = (cJSON*)malloc(node_count * sizeof(cJSON));
+    after = (cJSON*)malloc(node_count * sizeof(cJSON));
+    TEST_ASSERT_NOT_NULL(before);
+    TEST_ASSERT_NOT_NULL(after);
+    copy_pointer = before;
+    copy_nodes(tree, &copy_pointer);
+
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(tree));
+    TEST_ASSERT_NOT_NULL(cJSON_GetObjectItem(tree, "two"));
+    TEST_ASSERT_NOT_NULL(cJSON_GetObjectItemCaseSensitive(tree, "Two"));
+    TEST_ASSERT_NULL(cJSON_GetObjectItemCaseSensitive(tree, "two"));
+    TEST_ASSERT_TRUE(cJSON_HasObjectItem(tree, "FOUR"));
+    TEST_ASSERT_NOT_NULL(cJSON_GetArrayItem(cJSON_GetObjectItem(tree, "Two"), 2));
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(cJSON_GetObjectItem(tree, "Two"), 3));
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetNumberValue(cJSON_GetObjectItem(tree, "one")));
+    TEST_ASSERT_TRUE(cJSON_Compare(tree, tree, true));
+    printed = cJSON_Print(tree);
+    TEST_ASSERT_NOT_NULL(printed);
+    cJSON_free(printed);
+    printed = cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_NOT_NULL(printed);
+    cJSON_free(printed);
+
+    copy_pointer = after;
+    copy_nodes(tree, &copy_pointer);
+    TEST_ASSERT_EQUAL_MEMORY(before, after, node_count * sizeof(cJSON));
+
+    free(before);
+    free(after);
+    cJSON_Delete(tree);
+}
+
+static void cjson_delete_incremental_should_delete_in_steps(void)
+{
+    cJSON *tree = cJSON_Parse("{\"a\":[1,2,[3,{\"b\":\"c\"}]],\"d\":{\"e\":{\"f\":null}},\"g\":\"h\"}");
+    cJSON *reference = NULL;
+    size_t node_count = 0;
+    size_t steps = 0;
+
+    TEST_ASSERT_NOT_NULL(tree);
+    node_count = count_nodes(tree);
+
+    /* references must not free what they point to */
+    reference = cJSON_CreateObject();
+    TEST_ASSERT_NOT_NULL(reference);
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToObject(reference, "ref", cJSON_GetObjectItem(tree, "d")));
+
+    TEST_ASSERT_TRUE(cJSON_DeleteIncremental(tree, 0) == tree);
+    TEST_ASSERT_NULL(cJSON_DeleteIncremental(NULL, 10));
+    TEST_ASSERT_NULL(cJSON_DeleteIncremental(reference, 3));
+
+    while (tree != NULL)
+    {
+        tree = cJSON_DeleteIncremental(tree, 2);
+        steps++;
+    }
+    TEST_ASSERT_EQUAL_UINT((node_count + 1) / 2, steps);
+}
+
+static void cjson_delete_should_not_recurse_into_deep_trees(void)
+{
+    cJSON *root = cJSON_CreateArray();
+    cJSON *current = root;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(root);
+    for (i = 0; i < 100000; i++)
+    {
+        cJSON *child = cJSON_CreateArray();
+        TEST_ASSERT_NOT_NULL(child);
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(current, child));
+        current = child;
+    }
+
+    cJSON_Delete(root);
+}
+
+typedef struct
+{
+    char *buffer;
+    size_t length;
+    size_t offset;
+    size_t calls;
+    size_t fail_after;
+} test_writer;
+
+static cJSON_bool CJSON_CDECL write_to_test_writer(const char *data, size_t length, void *user_data)
+{
+    test_writer *writer = (test_writer*)user_data;
+
+    writer->calls++;
+    if ((writer->fail_after != 0) && (writer->calls >= writer->fail_after))
+    {
+        return false;
+    }
+    if ((writer->offset + length) > writer->length)
+    {
+        return false;
+    }
+    memcpy(writer->buffer + writer->offset, data, length);
+    writer->offset += length;
+
+    return true;
+}
+
+static void assert_print_to_writer_matches(const cJSON * const item, const cJSON_bool format)
+{
+    char *expected = format ? cJSON_Print(item) : cJSON_PrintUnformatted(item);
+    test_writer writer;
+
+    TEST_ASSERT_NOT_NULL(expected);
+    memset(&writer, 0, sizeof(writer));
+    writer.length = strlen(expected) + 1;
+    writer.buffer = (char*)malloc(writer.length);
+    TEST_ASSERT_NOT_NULL(writer.buffer);
+
+    TEST_ASSERT_TRUE(cJSON_PrintToWriter(item, format, write_to_test_writer, &writer));
+    TEST_ASSERT_EQUAL_UINT(strlen(expected), writer.offset);
+    TEST_ASSERT_EQUAL_MEMORY(expected, writer.buffer, writer.offset);
+    TEST_ASSERT_TRUE(writer.calls > 1);
+
+    free(writer.buffer);
+    cJSON_free(expected);
+}
+
+static void cjson_print_to_writer_should_print_in_chunks(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *array = NULL;
+    cJSON *object = NULL;
+    char long_string[10000];
+    test_writer writer;
+    int i = 0;
+
+    TEST_ASSERT_NOT_NULL(root);
+    array = cJSON_AddArrayToObject(root, "array");
+    TEST_ASSERT_NOT_NULL(array);
+    for (i = 0; i < 5000; i++)
+    {
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(array, cJSON_CreateNumber(i * 1.5)));
+        object = cJSON_CreateObject();
+        TEST_ASSERT_NOT_NULL(cJSON_AddStringToObject(object, "name", "\"quoted\"\n"));
+        TEST_ASSERT_NOT_NULL(cJSON_AddArrayToObject(object, "empty"));
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(array, object));
+    }
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    TEST_ASSERT_NOT_NULL(cJSON_AddStringToObject(root, "long", long_string));
+    TEST_ASSERT_NOT_NULL(cJSON_AddRawToObject(root, "raw", "[1, 2, 3]"));
+
+    assert_print_to_writer_matches(root, true);
+    assert_print_to_writer_matches(root, false);
+
+    /* aborting the writer aborts printing */
+    memset(&writer, 0, sizeof(writer));
+    writer.length = 1000000;
+    writer.buffer = (char*)malloc(writer.length);
+    TEST_ASSERT_NOT_NULL(writer.buffer);
+    writer.fail_after = 2;
+    TEST_ASSERT_FALSE(cJSON_PrintToWriter(root, true, write_to_test_writer, &writer));
+    TEST_ASSERT_EQUAL_UINT(2, writer.calls);
+    free(writer.buffer);
+
+    TEST_ASSERT_FALSE(cJSON_PrintToWriter(NULL, true, write_to_test_writer, &writer));
+    TEST_ASSERT_FALSE(cJSON_PrintToWriter(root, true, NULL, &writer));
+
+    cJSON_Delete(root);
+}
+
+static void cjson_writer_should_combine_items_and_text(void)
+{
+    cJSON *number = cJSON_CreateNumber(42);
+    cJSON *string = cJSON_CreateString("a\"b");
+    cJSON_Writer *cjson_writer = NULL;
+    test_writer writer;
+    char buffer[64];
+
+    memset(&writer, 0, sizeof(writer));
+    writer.length = sizeof(buffer);
+    writer.buffer = buffer;
+
+    cjson_writer = cJSON_CreateWriter(false, write_to_test_writer, &writer);
+    TEST_ASSERT_NOT_NULL(cjson_writer);
+    TEST_ASSERT_TRUE(cJSON_WriteText(cjson_writer, "{", 1));
+    TEST_ASSERT_TRUE(cJSON_WriteItem(cjson_writer, string));
+    TEST_ASSERT_TRUE(cJSON_WriteText(cjson_writer, ":", 1));
+    TEST_ASSERT_TRUE(cJSON_WriteItem(cjson_writer, number));
+    TEST_ASSERT_TRUE(cJSON_WriteText(cjson_writer, "}", 1));
+    /* nothing is written before the buffer runs full or the writer is closed */
+    TEST_ASSERT_EQUAL_UINT(0, writer.calls);
+    TEST_ASSERT_TRUE(cJSON_CloseWriter(cjson_writer));
+    TEST_ASSERT_EQUAL_UINT(1, writer.calls);
+    TEST_ASSERT_EQUAL_MEMORY("{\"a\\\"b\":42}", buffer, writer.offset);
+
+    /* a failed flush fails the writer */
+    memset(&writer, 0, sizeof(writer));
+    writer.length = sizeof(buffer);
+    writer.buffer = buffer;
+    writer.fail_after = 1;
+    cjson_writer = cJSON_CreateWriter(false, write_to_test_writer, &writer);
+    TEST_ASSERT_NOT_NULL(cjson_writer);
+    TEST_ASSERT_TRUE(cJSON_WriteItem(cjson_writer, number));
+    TEST_ASSERT_FALSE(cJSON_CloseWriter(cjson_writer));
+
+    TEST_ASSERT_NULL(cJSON_CreateWriter(false, NULL, NULL));
+    TEST_ASSERT_FALSE(cJSON_WriteItem(NULL, number));
+    TEST_ASSERT_FALSE(cJSON_WriteText(NULL, "x", 1));
+    TEST_ASSERT_FALSE(cJSON_CloseWriter(NULL));
+
+    cJSON_Delete(number);
+    cJSON_Delete(string);
+}
+
+static void cjson_get_arrays_should_copy_elements(void)
+{
+    const double doubles[] = { 1.5, -2.5, 3e20, -3e20 };
+    const char *const strings[] = { "a", "b", "c" };
+    double double_buffer[4];
+    cJSON_int64 int64_buffer[4];
+    const char *string_buffer[3];
+    cJSON *numbers = cJSON_CreateDoubleArray(doubles, 4);
+    cJSON *texts = cJSON_CreateStringArray(strings, 3);
+
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetDoubleArray(numbers, double_buffer, 4));
+    TEST_ASSERT_EQUAL_DOUBLE(1.5, double_buffer[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(-3e20, double_buffer[3]);
+
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetInt64Array(numbers, int64_buffer, 4));
+    TEST_ASSERT_TRUE(int64_buffer[0] == 1);
+    TEST_ASSERT_TRUE(int64_buffer[1] == -2);
+    TEST_ASSERT_TRUE(int64_buffer[2] > 0);
+    TEST_ASSERT_TRUE(int64_buffer[2] == int64_buffer[3] * -1 - 1);
+
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetStringArray(texts, string_buffer, 2));
+    TEST_ASSERT_EQUAL_STRING("b", string_buffer[1]);
+    TEST_ASSERT_TRUE(string_buffer[0] == cJSON_GetArrayItem(texts, 0)->valuestring);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetStringArray(texts, string_buffer, 3));
+
+    /* shorter arrays, wrong types and invalid arguments */
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetDoubleArray(numbers, double_buffer, 3));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetDoubleArray(numbers, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetDoubleArray(texts, double_buffer, 3));
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetStringArray(numbers, string_buffer, 3));
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetInt64Array(NULL, int64_buffer, 3));
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetInt64Array(numbers, int64_buffer, -1));
+    cJSON_AddItemToArray(texts, cJSON_CreateNull());
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetStringArray(texts, string_buffer, 4));
+
+    cJSON_Delete(numbers);
+    cJSON_Delete(texts);
+}
+
 int CJSON_CDECL main(void)
 {
     UNITY_BEGIN();
@@ -832,6 +1144,13 @@ int CJSON_CDECL main(void)
     RUN_TEST(cjson_set_valuestring_to_object_should_not_leak_memory);
     RUN_TEST(cjson_set_bool_value_must_not_break_objects);
     RUN_TEST(cjson_parse_big_numbers_should_not_report_error);
+    RUN_TEST(cjson_print_pretty_should_indent_array_elements);
+    RUN_TEST(cjson_lookups_should_not_modify_the_tree);
+    RUN_TEST(cjson_delete_incremental_should_delete_in_steps);
+    RUN_TEST(cjson_delete_should_not_recurse_into_deep_trees);
+    RUN_TEST(cjson_print_to_writer_should_print_in_chunks);
+    RUN_TEST(cjson_writer_should_combine_items_and_text);
+    RUN_TEST(cjson_get_arrays_should_copy_elements);
 
     return UNITY_END();
 }
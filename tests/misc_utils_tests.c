@@ -70,11 +70,875 @@ static void cjson_utils_functions_shouldnt_crash_with_null_pointers(void)
     cJSON_Delete(item);
 }
 
+static void cjson_utils_compiled_pointers_should_resolve_like_get_pointer(void)
+{
+    const char *pointers[] =
+    {
+        "", "/", "/foo", "/foo/0", "/foo/1", "/foo/2", "/foo/01", "/foo/x", "/FOO/1",
+        "/a~1b", "/m~0n", "/m~2n", "/ ", "/i\\j", "/k\"l", "/nested/array/3/key", "/nested/missing"
+    };
+    const char *json =
+        "{"
+        "\"foo\": [\"bar\", \"baz\"],"
+        "\"\": 0,"
+        "\"a/b\": 1,"
+        "\"i\\\\j\": 5,"
+        "\"k\\\"l\": 6,"
+        "\" \": 7,"
+        "\"m~n\": 8,"
+        "\"nested\": {\"array\": [0, 1, 2, {\"key\": true}]}"
+        "}";
+    cJSON *root = cJSON_Parse(json);
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(root);
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        cJSONUtils_Pointer *compiled = cJSONUtils_CompilePointer(pointers[i]);
+        cJSONUtils_Pointer *compiled_case_sensitive = cJSONUtils_CompilePointerCaseSensitive(pointers[i]);
+        TEST_ASSERT_NOT_NULL(compiled);
+        TEST_ASSERT_NOT_NULL(compiled_case_sensitive);
+
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(cJSONUtils_GetPointer(root, pointers[i]), cJSONUtils_EvalPointer(root, compiled), pointers[i]);
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(cJSONUtils_GetPointerCaseSensitive(root, pointers[i]), cJSONUtils_EvalPointer(root, compiled_case_sensitive), pointers[i]);
+
+        cJSONUtils_DeletePointer(compiled);
+        cJSONUtils_DeletePointer(compiled_case_sensitive);
+    }
+
+    TEST_ASSERT_NULL(cJSONUtils_CompilePointer(NULL));
+    TEST_ASSERT_NULL(cJSONUtils_EvalPointer(root, NULL));
+
+    cJSON_Delete(root);
+}
+
+static void cjson_utils_eval_pointers_should_resolve_many_pointers(void)
+{
+    const char *pointers[] =
+    {
+        "/a/b/0", "/a/b/2", "/a/b/1", "/a/b/5", "/a/b/3/c", "/a/b/3/d", "/a/b", "/a", "/x/y", "/a/b/4", "", "/A/B/0"
+    };
+    cJSONUtils_Pointer *compiled[sizeof(pointers) / sizeof(pointers[0])];
+    cJSON *results[sizeof(pointers) / sizeof(pointers[0])];
+    cJSON *root = cJSON_Parse("{\"a\":{\"b\":[10,11,12,{\"c\":13,\"d\":14},15]}}");
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(root);
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        compiled[i] = cJSONUtils_CompilePointer(pointers[i]);
+        TEST_ASSERT_NOT_NULL(compiled[i]);
+    }
+
+    TEST_ASSERT_TRUE(cJSONUtils_EvalPointers(root, (const cJSONUtils_Pointer * const *)compiled, sizeof(pointers) / sizeof(pointers[0]), results));
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(cJSONUtils_GetPointer(root, pointers[i]), results[i], pointers[i]);
+    }
+
+    TEST_ASSERT_FALSE(cJSONUtils_EvalPointers(NULL, (const cJSONUtils_Pointer * const *)compiled, 1, results));
+    TEST_ASSERT_FALSE(cJSONUtils_EvalPointers(root, NULL, 1, results));
+    TEST_ASSERT_FALSE(cJSONUtils_EvalPointers(root, (const cJSONUtils_Pointer * const *)compiled, 1, NULL));
+
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        cJSONUtils_DeletePointer(compiled[i]);
+    }
+    cJSON_Delete(root);
+}
+
+static void cjson_utils_pointer_index_should_find_pointers(void)
+{
+    const char *pointers[] = { "", "/a", "/a/0", "/a/10", "/a/11/m~0n/x~1y/0", "/", "//", "/b", "/numbers/99" };
+    int numbers[100];
+    const cJSON *targets[sizeof(pointers) / sizeof(pointers[0]) + 1];
+    char *found[sizeof(pointers) / sizeof(pointers[0]) + 1];
+    cJSON *root = cJSON_Parse("{\"a\":[0,1,2,3,4,5,6,7,8,9,10,{\"m~n\":{\"x/y\":[null]}}],\"\":{\"\":true},\"b\":{}}");
+    cJSON *other = cJSON_CreateNull();
+    cJSONUtils_PointerIndex *index = NULL;
+    char *pointer = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(root);
+    memset(numbers, '\0', sizeof(numbers));
+    cJSON_AddItemToObject(root, "numbers", cJSON_CreateIntArray(numbers, 100));
+
+    index = cJSONUtils_CreatePointerIndex(root);
+    TEST_ASSERT_NOT_NULL(index);
+
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        targets[i] = cJSONUtils_GetPointerCaseSensitive(root, pointers[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(targets[i], pointers[i]);
+
+        pointer = cJSONUtils_FindPointerFromIndex(index, targets[i]);
+        TEST_ASSERT_EQUAL_STRING(pointers[i], pointer);
+        cJSON_free(pointer);
+
+        pointer = cJSONUtils_FindPointerFromObjectTo(root, targets[i]);
+        TEST_ASSERT_EQUAL_STRING(pointers[i], pointer);
+        cJSON_free(pointer);
+    }
+    targets[i] = other;
+
+    TEST_ASSERT_NULL(cJSONUtils_FindPointerFromIndex(index, other));
+    TEST_ASSERT_NULL(cJSONUtils_FindPointerFromIndex(index, NULL));
+    TEST_ASSERT_NULL(cJSONUtils_FindPointerFromIndex(NULL, root));
+    TEST_ASSERT_NULL(cJSONUtils_CreatePointerIndex(NULL));
+    cJSONUtils_DeletePointerIndex(index);
+
+    TEST_ASSERT_TRUE(cJSONUtils_FindPointersFromObjectTo(root, targets, sizeof(targets) / sizeof(targets[0]), found));
+    for (i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++)
+    {
+        TEST_ASSERT_EQUAL_STRING(pointers[i], found[i]);
+        cJSON_free(found[i]);
+    }
+    TEST_ASSERT_NULL(found[i]);
+    TEST_ASSERT_FALSE(cJSONUtils_FindPointersFromObjectTo(NULL, targets, 1, found));
+
+    cJSON_Delete(other);
+    cJSON_Delete(root);
+}
+
+static void cjson_utils_array_diff_patches_should_transform_from_into_to(void)
+{
+    const char *cases[][2] =
+    {
+        {"[]", "[]"},
+        {"[]", "[1,2,3]"},
+        {"[1,2,3]", "[]"},
+        {"[1,2,3]", "[0,1,2,3]"},
+        {"[1,2,3]", "[1,2,3,4]"},
+        {"[1,2,3,4,5]", "[1,3,5]"},
+        {"[1,2,3,4,5]", "[5,4,3,2,1]"},
+        {"[\"a\",\"b\",\"c\",\"a\",\"b\",\"b\",\"a\"]", "[\"c\",\"b\",\"a\",\"b\",\"a\",\"c\"]"},
+        {"[{\"a\":1},{\"b\":2},{\"c\":3}]", "[{\"b\":2},{\"c\":4},{\"d\":5}]"},
+        {"{\"x\":[1,[2,3],4]}", "{\"x\":[[2,3,5],4,6]}"},
+        {"[1,\"1\",true,null]", "[null,true,\"1\",1]"}
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        cJSON *from = cJSON_Parse(cases[i][0]);
+        cJSON *to = cJSON_Parse(cases[i][1]);
+        cJSON *patched = cJSON_Duplicate(from, true);
+        cJSON *patches = cJSONUtils_GenerateArrayDiffPatchesCaseSensitive(from, to);
+
+        TEST_ASSERT_NOT_NULL(patches);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, cJSONUtils_ApplyPatchesCaseSensitive(patched, patches), cases[i][1]);
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(patched, to, true), cases[i][1]);
+
+        cJSON_Delete(from);
+        cJSON_Delete(to);
+        cJSON_Delete(patched);
+        cJSON_Delete(patches);
+    }
+}
+
+static void cjson_utils_array_diff_patches_should_be_small_for_insertions(void)
+{
+    int numbers[1000];
+    cJSON *from = NULL;
+    cJSON *to = NULL;
+    cJSON *patches = NULL;
+    cJSON *patched = NULL;
+    int i = 0;
+
+    for (i = 0; i < 1000; i++)
+    {
+        numbers[i] = i;
+    }
+    from = cJSON_CreateIntArray(numbers, 1000);
+    to = cJSON_CreateIntArray(numbers, 1000);
+    cJSON_InsertItemInArray(to, 0, cJSON_CreateNumber(-1));
+    cJSON_InsertItemInArray(to, 500, cJSON_CreateString("middle"));
+    cJSON_DeleteItemFromArray(to, 900);
+
+    patches = cJSONUtils_GenerateArrayDiffPatches(from, to);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(patches));
+
+    patched = cJSON_Duplicate(from, true);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(patched, patches));
+    TEST_ASSERT_TRUE(cJSON_Compare(patched, to, true));
+    cJSON_Delete(patches);
+    cJSON_Delete(patched);
+
+    /* completely different arrays exceed the diff limit and fall back to patching by index */
+    cJSON_Delete(to);
+    for (i = 0; i < 1000; i++)
+    {
+        numbers[i] = -i - 1;
+    }
+    to = cJSON_CreateIntArray(numbers, 1000);
+    patches = cJSONUtils_GenerateArrayDiffPatches(from, to);
+    TEST_ASSERT_EQUAL_INT(1000, cJSON_GetArraySize(patches));
+    patched = cJSON_Duplicate(from, true);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(patched, patches));
+    TEST_ASSERT_TRUE(cJSON_Compare(patched, to, true));
+
+    cJSON_Delete(patches);
+    cJSON_Delete(patched);
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void cjson_utils_hash_should_not_depend_on_member_order(void)
+{
+    cJSON *a = cJSON_Parse("{\"a\":1,\"b\":[1,2,{\"c\":null,\"d\":\"e\"}],\"f\":true}");
+    cJSON *b = cJSON_Parse("{\"f\":true,\"b\":[1,2,{\"d\":\"e\",\"c\":null}],\"a\":1.0}");
+    cJSON *c = cJSON_Parse("{\"F\":true,\"b\":[1,2,{\"d\":\"e\",\"c\":null}],\"a\":1}");
+    cJSON *d = cJSON_Parse("{\"a\":1,\"b\":[2,1,{\"c\":null,\"d\":\"e\"}],\"f\":true}");
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_NOT_NULL(d);
+
+    TEST_ASSERT_TRUE(cJSONUtils_HashCaseSensitive(a) == cJSONUtils_HashCaseSensitive(b));
+    TEST_ASSERT_TRUE(cJSONUtils_Hash(a) == cJSONUtils_Hash(b));
+    TEST_ASSERT_TRUE(cJSONUtils_Hash(a) == cJSONUtils_Hash(c));
+    TEST_ASSERT_FALSE(cJSONUtils_HashCaseSensitive(a) == cJSONUtils_HashCaseSensitive(c));
+    /* arrays are ordered */
+    TEST_ASSERT_FALSE(cJSONUtils_HashCaseSensitive(a) == cJSONUtils_HashCaseSensitive(d));
+    TEST_ASSERT_FALSE(cJSONUtils_Hash(cJSON_GetObjectItem(a, "a")) == cJSONUtils_Hash(cJSON_GetObjectItem(a, "f")));
+    TEST_ASSERT_TRUE(cJSONUtils_Hash(NULL) == 0);
+
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+    cJSON_Delete(c);
+    cJSON_Delete(d);
+}
+
+static void cjson_utils_generate_patches_should_skip_identical_subtrees(void)
+{
+    cJSON *from = cJSON_Parse("{\"same\":{\"x\":[1,2,3],\"y\":{\"z\":\"w\"}},\"changed\":{\"x\":[1,2,3],\"y\":1}}");
+    cJSON *to = cJSON_Parse("{\"changed\":{\"y\":2,\"x\":[1,2,3]},\"same\":{\"y\":{\"z\":\"w\"},\"x\":[1,2,3]}}");
+    cJSON *patches = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(from);
+    TEST_ASSERT_NOT_NULL(to);
+
+    patches = cJSONUtils_GeneratePatchesCaseSensitive(from, to);
+    printed = cJSON_PrintUnformatted(patches);
+    TEST_ASSERT_EQUAL_STRING("[{\"op\":\"replace\",\"path\":\"/changed/y\",\"value\":2}]", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void cjson_utils_apply_patches_should_apply_operations_sequentially(void)
+{
+    /* consecutive operations on the same paths, the earlier ones change what the later ones point to */
+    const char *operations[] =
+    {
+        "{\"op\":\"add\",\"path\":\"/a/b/0\",\"value\":{\"c\":[1,2,3]}}",
+        "{\"op\":\"remove\",\"path\":\"/a/b/0/c/0\"}",
+        "{\"op\":\"add\",\"path\":\"/a/b/0/c/-\",\"value\":4}",
+        "{\"op\":\"test\",\"path\":\"/a/b/0/c\",\"value\":[2,3,4]}",
+        "{\"op\":\"move\",\"from\":\"/a/b/0\",\"path\":\"/a/b/1\"}",
+        "{\"op\":\"test\",\"path\":\"/a/b/1/c/2\",\"value\":4}",
+        "{\"op\":\"replace\",\"path\":\"/a/b\",\"value\":[{\"d\":5}]}",
+        "{\"op\":\"copy\",\"from\":\"/a/b/0\",\"path\":\"/a/b/-\"}",
+        "{\"op\":\"replace\",\"path\":\"/a/b/1/d\",\"value\":6}",
+        "{\"op\":\"test\",\"path\":\"/a/b/0/d\",\"value\":5}",
+        "{\"op\":\"remove\",\"path\":\"/a/b/0\"}",
+        "{\"op\":\"test\",\"path\":\"/a/b/0/d\",\"value\":6}",
+        "{\"op\":\"add\",\"path\":\"/a~1b\",\"value\":{\"e~f\":7}}",
+        "{\"op\":\"test\",\"path\":\"/a~1b/e~0f\",\"value\":7}"
+    };
+    cJSON *patches = cJSON_CreateArray();
+    cJSON *expected = cJSON_Parse("{\"a\":{\"b\":[{\"x\":0}]}}");
+    cJSON *object = cJSON_Duplicate(expected, true);
+    cJSON *patch = NULL;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(operations) / sizeof(operations[0])); i++)
+    {
+        patch = cJSON_Parse(operations[i]);
+        TEST_ASSERT_NOT_NULL(patch);
+        cJSON_AddItemToArray(patches, patch);
+    }
+    TEST_ASSERT_NOT_NULL(patches);
+    TEST_ASSERT_NOT_NULL(object);
+
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(object, patches));
+
+    /* applying the operations one by one has to give the same result */
+    cJSON_ArrayForEach(patch, patches)
+    {
+        cJSON *single = cJSON_CreateArray();
+        cJSON_AddItemReferenceToArray(single, patch);
+        TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(expected, single));
+        cJSON_Delete(single);
+    }
+    TEST_ASSERT_TRUE(cJSON_Compare(expected, object, true));
+
+    cJSON_Delete(patches);
+    cJSON_Delete(expected);
+    cJSON_Delete(object);
+}
+
+static void cjson_utils_apply_patches_atomic_should_roll_back_on_failure(void)
+{
+    const char *operations[] =
+    {
+        "{\"op\":\"add\",\"path\":\"/a/0\",\"value\":0}",
+        "{\"op\":\"remove\",\"path\":\"/a/2\"}",
+        "{\"op\":\"replace\",\"path\":\"/b/c\",\"value\":[]}",
+        "{\"op\":\"move\",\"from\":\"/a/1\",\"path\":\"/b/c/-\"}",
+        "{\"op\":\"copy\",\"from\":\"/b\",\"path\":\"/d\"}",
+        "{\"op\":\"add\",\"path\":\"/b/e\",\"value\":\"overwritten\"}",
+        "{\"op\":\"move\",\"from\":\"/d\",\"path\":\"/b\"}",
+        "{\"op\":\"replace\",\"path\":\"\",\"value\":{\"f\":[1]}}",
+        "{\"op\":\"add\",\"path\":\"/f/0\",\"value\":2}",
+        "{\"op\":\"test\",\"path\":\"/f\",\"value\":[2,1]}"
+    };
+    cJSON *original = cJSON_Parse("{\"a\":[1,2,3],\"b\":{\"c\":true,\"e\":null}}");
+    cJSON *patches = cJSON_CreateArray();
+    cJSON *object = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(original);
+    for (i = 0; i < (sizeof(operations) / sizeof(operations[0])); i++)
+    {
+        cJSON *patch = cJSON_Parse(operations[i]);
+        TEST_ASSERT_NOT_NULL(patch);
+        cJSON_AddItemToArray(patches, patch);
+    }
+
+    /* all operations succeed */
+    object = cJSON_Duplicate(original, true);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patches));
+    cJSON_Delete(object);
+
+    /* a failing operation at every position reverts everything before it */
+    for (i = 0; i <= (sizeof(operations) / sizeof(operations[0])); i++)
+    {
+        cJSON *failing = cJSON_Duplicate(patches, true);
+        char *printed = NULL;
+        char *expected = cJSON_PrintUnformatted(original);
+
+        cJSON_InsertItemInArray(failing, (int)i, cJSON_Parse("{\"op\":\"test\",\"path\":\"/missing\",\"value\":1}"));
+        object = cJSON_Duplicate(original, true);
+        TEST_ASSERT_TRUE(cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, failing) != 0);
+
+        /* even the order of members has to be restored */
+        printed = cJSON_PrintUnformatted(object);
+        TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+        cJSON_free(printed);
+        cJSON_free(expected);
+        cJSON_Delete(object);
+        cJSON_Delete(failing);
+    }
+
+    cJSON_Delete(patches);
+    cJSON_Delete(original);
+}
+
+static void assert_atomic_patches_roll_back(const char * const json, const char * const patches_json)
+{
+    cJSON *object = cJSON_Parse(json);
+    cJSON *patches = cJSON_Parse(patches_json);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(patches);
+    TEST_ASSERT_TRUE(cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patches) != 0);
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+
+    /* without the failing test, the moved keys are committed */
+    cJSON_DeleteItemFromArray(patches, cJSON_GetArraySize(patches) - 1);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patches));
+
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+    cJSON_Delete(object);
+}
+
+static void cjson_utils_apply_patches_atomic_should_restore_moved_keys(void)
+{
+    assert_atomic_patches_roll_back("{\"a\":1}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/b\"},{\"op\":\"test\",\"path\":\"/x\",\"value\":0}]");
+    assert_atomic_patches_roll_back("{\"a\":1,\"o\":{}}",
+        "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/b\"},{\"op\":\"move\",\"from\":\"/b\",\"path\":\"/o/c\"},{\"op\":\"test\",\"path\":\"/x\",\"value\":0}]");
+    assert_atomic_patches_roll_back("{\"a\":1,\"l\":[2]}",
+        "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/l/0\"},{\"op\":\"move\",\"from\":\"/l/1\",\"path\":\"/b\"},{\"op\":\"test\",\"path\":\"/x\",\"value\":0}]");
+    assert_atomic_patches_roll_back("{\"a\":1,\"b\":2}",
+        "[{\"op\":\"copy\",\"from\":\"/a\",\"path\":\"/b\"},{\"op\":\"move\",\"from\":\"/b\",\"path\":\"/a\"},{\"op\":\"test\",\"path\":\"/x\",\"value\":0}]");
+}
+
+static void cjson_utils_test_operation_should_not_modify_the_document(void)
+{
+    cJSON *object = cJSON_Parse("{\"c\":1,\"b\":{\"z\":true,\"y\":false},\"a\":[{\"q\":1,\"p\":2}]}");
+    cJSON *patches = cJSON_Parse("[{\"op\":\"test\",\"path\":\"\",\"value\":{\"a\":[{\"p\":2,\"q\":1}],\"b\":{\"y\":false,\"z\":true},\"c\":1}}]");
+    char *before = NULL;
+    char *after = NULL;
+    char *patches_before = NULL;
+    char *patches_after = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(patches);
+    before = cJSON_PrintUnformatted(object);
+    patches_before = cJSON_PrintUnformatted(patches);
+
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(object, patches));
+
+    after = cJSON_PrintUnformatted(object);
+    patches_after = cJSON_PrintUnformatted(patches);
+    TEST_ASSERT_EQUAL_STRING(before, after);
+    TEST_ASSERT_EQUAL_STRING(patches_before, patches_after);
+
+    cJSON_free(before);
+    cJSON_free(after);
+    cJSON_free(patches_before);
+    cJSON_free(patches_after);
+    cJSON_Delete(object);
+    cJSON_Delete(patches);
+}
+
+static void cjson_utils_test_operation_should_compare_large_objects(void)
+{
+    cJSON *object = cJSON_CreateObject();
+    cJSON *value = cJSON_CreateObject();
+    cJSON *patches = cJSON_CreateArray();
+    char key[16];
+    int i = 0;
+
+    /* more members than fit into the bitmask of the small object comparison */
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        cJSON_AddNumberToObject(object, key, i);
+        sprintf(key, "key%d", 199 - i);
+        cJSON_AddNumberToObject(value, key, 199 - i);
+    }
+    /* a duplicate key is paired with the duplicate in the same position */
+    cJSON_AddNumberToObject(object, "key7", 1);
+    cJSON_AddNumberToObject(value, "KEY7", 1);
+
+    cJSONUtils_AddPatchToArray(patches, "test", "", value);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(object, patches));
+    TEST_ASSERT_TRUE(cJSONUtils_ApplyPatchesCaseSensitive(object, patches) != 0);
+
+    cJSON_Delete(patches);
+    patches = cJSON_CreateArray();
+    cJSON_SetNumberValue(cJSON_GetObjectItem(value, "key100"), -1);
+    cJSONUtils_AddPatchToArray(patches, "test", "", value);
+    TEST_ASSERT_TRUE(cJSONUtils_ApplyPatches(object, patches) != 0);
+
+    cJSON_Delete(patches);
+    cJSON_Delete(value);
+    cJSON_Delete(object);
+}
+
+static void cjson_utils_sort_object_should_sort_many_members(void)
+{
+    cJSON *object = cJSON_CreateObject();
+    cJSON *child = NULL;
+    char key[32];
+    unsigned long random = 1;
+    int i = 0;
+
+    for (i = 0; i < 1000; i++)
+    {
+        /* linear congruential generator, keys share long prefixes in different case */
+        random = (random * 1103515245UL + 12345UL) & 0x7fffffffUL;
+        sprintf(key, "%s%lu", ((random & 1) != 0) ? "Common_Prefix_" : "common_prefix_", random % 500);
+        cJSON_AddNumberToObject(object, key, i);
+    }
+
+    cJSONUtils_SortObject(object);
+    for (child = object->child; child->next != NULL; child = child->next)
+    {
+        TEST_ASSERT_TRUE(case_insensitive_strcmp((unsigned char*)child->string, (unsigned char*)child->next->string) <= 0);
+        if (case_insensitive_strcmp((unsigned char*)child->string, (unsigned char*)child->next->string) == 0)
+        {
+            /* equal keys keep their order */
+            TEST_ASSERT_TRUE(child->valueint < child->next->valueint);
+        }
+        TEST_ASSERT_TRUE(child->next->prev == child);
+    }
+    /* the list is still well formed */
+    TEST_ASSERT_TRUE(object->child->prev == child);
+    cJSON_AddNullToObject(object, "last");
+    TEST_ASSERT_TRUE(child->next == cJSON_GetObjectItem(object, "last"));
+
+    cJSONUtils_SortObjectCaseSensitive(object);
+    for (child = object->child; child->next != NULL; child = child->next)
+    {
+        TEST_ASSERT_TRUE(strcmp(child->string, child->next->string) <= 0);
+    }
+    TEST_ASSERT_TRUE(object->child->prev == child);
+
+    cJSON_Delete(object);
+}
+
+static void cjson_utils_sort_object_to_depth_should_limit_recursion(void)
+{
+    cJSON *object = cJSON_Parse("{\"b\":{\"d\":{\"f\":1,\"e\":2},\"c\":[{\"h\":1,\"g\":2}]},\"a\":1}");
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+
+    cJSONUtils_SortObjectToDepth(object, 0);
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":{\"d\":{\"f\":1,\"e\":2},\"c\":[{\"h\":1,\"g\":2}]}}", printed);
+    cJSON_free(printed);
+
+    cJSONUtils_SortObjectToDepthCaseSensitive(object, 1);
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":{\"c\":[{\"h\":1,\"g\":2}],\"d\":{\"f\":1,\"e\":2}}}", printed);
+    cJSON_free(printed);
+
+    cJSONUtils_SortObjectToDepth(object, CJSON_NESTING_LIMIT);
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":{\"c\":[{\"g\":2,\"h\":1}],\"d\":{\"e\":2,\"f\":1}}}", printed);
+    cJSON_free(printed);
+
+    cJSONUtils_SortObjectToDepth(NULL, 1);
+    cJSON_Delete(object);
+}
+
+static void cjson_utils_merge_patch_should_keep_member_order(void)
+{
+    cJSON *target = cJSON_Parse("{\"a\":1,\"b\":{\"c\":2,\"d\":3},\"e\":[1],\"f\":4}");
+    cJSON *patch = cJSON_Parse("{\"a\":\"x\",\"b\":{\"c\":null,\"g\":5},\"f\":null,\"h\":6}");
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(target);
+    TEST_ASSERT_NOT_NULL(patch);
+
+    target = cJSONUtils_MergePatch(target, patch);
+    printed = cJSON_PrintUnformatted(target);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":\"x\",\"b\":{\"d\":3,\"g\":5},\"e\":[1],\"h\":6}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(target);
+    cJSON_Delete(patch);
+}
+
+static void cjson_utils_merge_patch_should_hand_over_member_keys(void)
+{
+    cJSON_KeyTable *keys = cJSON_CreateKeyTable();
+    const char json[] = "{\"a\":1,\"b\":2,\"c\":3}";
+    cJSON *target = cJSON_ParseWithKeyTable(json, sizeof(json), keys, NULL);
+    cJSON *patch = cJSON_Parse("{\"a\":\"x\",\"b\":[2]}");
+    cJSON *member = NULL;
+
+    TEST_ASSERT_NOT_NULL(target);
+    TEST_ASSERT_NOT_NULL(patch);
+
+    /* the replacements take over the interned keys */
+    target = cJSONUtils_MergePatchCaseSensitive(target, patch);
+    member = cJSON_GetObjectItemCaseSensitive(target, "a");
+    TEST_ASSERT_TRUE(cJSON_IsString(member));
+    TEST_ASSERT_TRUE(member->type & cJSON_StringIsConst);
+    TEST_ASSERT_EQUAL_PTR(cJSON_InternKey(keys, "a"), member->string);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItemCaseSensitive(target, "b")->type & cJSON_StringIsConst);
+    cJSON_Delete(target);
+    cJSON_Delete(patch);
+
+    /* a constant key in the patch doesn't make the allocated key of the target constant */
+    target = cJSON_Parse(json);
+    patch = cJSON_CreateObject();
+    TEST_ASSERT_NOT_NULL(target);
+    TEST_ASSERT_NOT_NULL(patch);
+    TEST_ASSERT_TRUE(cJSON_AddItemToObjectCS(patch, "a", cJSON_CreateFalse()));
+    target = cJSONUtils_MergePatchCaseSensitive(target, patch);
+    member = cJSON_GetObjectItemCaseSensitive(target, "a");
+    TEST_ASSERT_TRUE(cJSON_IsFalse(member));
+    TEST_ASSERT_FALSE(member->type & cJSON_StringIsConst);
+    cJSON_Delete(target);
+    cJSON_Delete(patch);
+
+    cJSON_DeleteKeyTable(keys);
+}
+
+static void cjson_utils_merge_patch_should_handle_large_objects(void)
+{
+    cJSON *target = cJSON_CreateObject();
+    cJSON *patch = cJSON_CreateObject();
+    char key[16];
+    int i = 0;
+
+    TEST_ASSERT_NOT_NULL(target);
+    TEST_ASSERT_NOT_NULL(patch);
+
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(target, key, i));
+        if ((i % 3) == 0)
+        {
+            TEST_ASSERT_NOT_NULL(cJSON_AddNullToObject(patch, key));
+        }
+        else if ((i % 3) == 1)
+        {
+            TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(patch, key, -i));
+        }
+    }
+    /* removed and re-added in the same patch, only the last one counts */
+    TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(patch, "key0", 1000));
+    TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(patch, "new", 1));
+
+    target = cJSONUtils_MergePatch(target, patch);
+    TEST_ASSERT_NOT_NULL(target);
+    TEST_ASSERT_EQUAL_INT(200 - 67 + 1 + 1, cJSON_GetArraySize(target));
+    TEST_ASSERT_EQUAL_INT(-1, cJSON_GetObjectItem(target, "key1")->valueint);
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetObjectItem(target, "key2")->valueint);
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(target, "key3"));
+    TEST_ASSERT_EQUAL_INT(1000, cJSON_GetObjectItem(target, "key0")->valueint);
+    TEST_ASSERT_EQUAL_STRING("key1", target->child->string);
+    TEST_ASSERT_EQUAL_STRING("new", target->child->prev->string);
+
+    cJSON_Delete(target);
+    cJSON_Delete(patch);
+}
+
+static void cjson_utils_generate_merge_patch_should_not_modify_inputs(void)
+{
+    cJSON *from = cJSON_Parse("{\"c\":1,\"b\":{\"y\":1,\"x\":[1,2]},\"a\":\"keep\",\"d\":true}");
+    cJSON *to = cJSON_Parse("{\"e\":null,\"a\":\"keep\",\"b\":{\"x\":[1,2],\"y\":2},\"c\":1}");
+    cJSON *patch = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(from);
+    TEST_ASSERT_NOT_NULL(to);
+
+    patch = cJSONUtils_GenerateMergePatchCaseSensitive(from, to);
+    printed = cJSON_PrintUnformatted(patch);
+    TEST_ASSERT_EQUAL_STRING("{\"d\":null,\"e\":null,\"b\":{\"y\":2}}", printed);
+    cJSON_free(printed);
+
+    printed = cJSON_PrintUnformatted(from);
+    TEST_ASSERT_EQUAL_STRING("{\"c\":1,\"b\":{\"y\":1,\"x\":[1,2]},\"a\":\"keep\",\"d\":true}", printed);
+    cJSON_free(printed);
+    printed = cJSON_PrintUnformatted(to);
+    TEST_ASSERT_EQUAL_STRING("{\"e\":null,\"a\":\"keep\",\"b\":{\"x\":[1,2],\"y\":2},\"c\":1}", printed);
+    cJSON_free(printed);
+
+    TEST_ASSERT_NULL(cJSONUtils_GenerateMergePatch(from, from));
+
+    cJSON_Delete(patch);
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+typedef struct
+{
+    char buffer[256];
+    size_t offset;
+} merge_patch_writer;
+
+static cJSON_bool CJSON_CDECL write_to_merge_patch_writer(const char *data, size_t length, void *user_data)
+{
+    merge_patch_writer *writer = (merge_patch_writer*)user_data;
+
+    if ((writer->offset + length) >= sizeof(writer->buffer))
+    {
+        return false;
+    }
+    memcpy(writer->buffer + writer->offset, data, length);
+    writer->offset += length;
+    writer->buffer[writer->offset] = '\0';
+
+    return true;
+}
+
+static void cjson_utils_print_merge_patch_should_match_generated_patch(void)
+{
+    cJSON *from = cJSON_Parse("{\"a\":1,\"q\\\"uote\":2,\"n\":{\"x\":{\"y\":1},\"z\":[1]},\"s\":\"t\"}");
+    cJSON *to = cJSON_Parse("{\"a\":1,\"n\":{\"x\":{\"y\":2},\"z\":[1]},\"s\":{\"t\":true},\"new\":[null]}");
+    cJSON *patch = NULL;
+    char *printed = NULL;
+    merge_patch_writer writer;
+
+    TEST_ASSERT_NOT_NULL(from);
+    TEST_ASSERT_NOT_NULL(to);
+
+    patch = cJSONUtils_GenerateMergePatch(from, to);
+    printed = cJSON_PrintUnformatted(patch);
+
+    writer.offset = 0;
+    writer.buffer[0] = '\0';
+    TEST_ASSERT_TRUE(cJSONUtils_PrintMergePatch(from, to, write_to_merge_patch_writer, &writer));
+    TEST_ASSERT_EQUAL_STRING(printed, writer.buffer);
+    TEST_ASSERT_EQUAL_STRING("{\"q\\\"uote\":null,\"n\":{\"x\":{\"y\":2}},\"s\":{\"t\":true},\"new\":[null]}", writer.buffer);
+
+    writer.offset = 0;
+    TEST_ASSERT_TRUE(cJSONUtils_PrintMergePatchCaseSensitive(from, from, write_to_merge_patch_writer, &writer));
+    TEST_ASSERT_EQUAL_STRING("{}", writer.buffer);
+
+    writer.offset = 0;
+    TEST_ASSERT_TRUE(cJSONUtils_PrintMergePatch(from, NULL, write_to_merge_patch_writer, &writer));
+    TEST_ASSERT_EQUAL_STRING("null", writer.buffer);
+
+    TEST_ASSERT_FALSE(cJSONUtils_PrintMergePatch(from, to, NULL, NULL));
+
+    cJSON_free(printed);
+    cJSON_Delete(patch);
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static size_t allocation_count = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocation_count++;
+    return malloc(size);
+}
+
+static cJSON_bool CJSON_CDECL discard_output(const char *data, size_t length, void *user_data)
+{
+    (void)data;
+    *(size_t*)user_data += length;
+
+    return true;
+}
+
+static void cjson_utils_print_merge_patch_should_reuse_one_buffer(void)
+{
+    cJSON *from = cJSON_CreateObject();
+    cJSON *to = cJSON_CreateObject();
+    cJSON_Hooks hooks = { counting_malloc, free };
+    char key[16];
+    size_t written = 0;
+    int i = 0;
+
+    for (i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(from, key, i));
+        TEST_ASSERT_NOT_NULL(cJSON_AddStringToObject(to, key, "changed"));
+    }
+
+    cJSON_InitHooks(&hooks);
+    allocation_count = 0;
+    TEST_ASSERT_TRUE(cJSONUtils_PrintMergePatch(from, to, discard_output, &written));
+    cJSON_InitHooks(NULL);
+
+    /* the writer, its buffer and the hash tables, but nothing per member */
+    TEST_ASSERT_TRUE(allocation_count < 20);
+    TEST_ASSERT_TRUE(written > (500 * sizeof("\"key0\":\"changed\"")));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void cjson_utils_generate_patches_should_compare_exact_integers(void)
+{
+    cJSON *from = cJSON_Parse("{\"id\":9007199254740993}");
+    cJSON *to = cJSON_Parse("{\"id\":9007199254740995}");
+    cJSON *patch = cJSONUtils_GeneratePatches(from, to);
+    char *printed = cJSON_PrintUnformatted(patch);
+
+    TEST_ASSERT_EQUAL_STRING("[{\"op\":\"replace\",\"path\":\"/id\",\"value\":9007199254740995}]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patch);
+
+    patch = cJSONUtils_GenerateMergePatch(from, to);
+    printed = cJSON_PrintUnformatted(patch);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":9007199254740995}", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patch);
+
+    /* a plain double next to the exact value isn't the same number */
+    cJSON_ReplaceItemInObject(to, "id", cJSON_CreateNumber(9007199254740992.0));
+    patch = cJSONUtils_GeneratePatches(from, to);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(patch));
+    cJSON_Delete(patch);
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void cjson_utils_should_see_the_elements_of_packed_arrays(void)
+{
+    cJSON *from = cJSON_Parse("{\"x\":[1,2,3]}");
+    cJSON *to = cJSON_Parse("{\"x\":[1,2,3]}");
+    cJSON *patch = NULL;
+    cJSON *expected = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(from, "x")));
+    TEST_ASSERT_EQUAL_UINT32(cJSONUtils_Hash(to), cJSONUtils_Hash(from));
+
+    /* equal arrays don't need patches, no matter how they are stored */
+    patch = cJSONUtils_GeneratePatches(from, to);
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetArraySize(patch));
+    cJSON_Delete(patch);
+    TEST_ASSERT_NULL(cJSONUtils_GenerateMergePatch(from, to));
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(from, "x")));
+    cJSON_ReplaceItemInArray(cJSON_GetObjectItem(to, "x"), 2, cJSON_CreateNumber(4));
+    patch = cJSONUtils_GenerateArrayDiffPatches(from, to);
+    printed = cJSON_PrintUnformatted(patch);
+    TEST_ASSERT_EQUAL_STRING("[{\"op\":\"replace\",\"path\":\"/x/2\",\"value\":4}]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patch);
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(from, "x")));
+    TEST_ASSERT_EQUAL_DOUBLE(2, cJSONUtils_GetPointer(from, "/x/1")->valuedouble);
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(from, "x")));
+    patch = cJSON_Parse("[{\"op\":\"replace\",\"path\":\"/x/1\",\"value\":5},{\"op\":\"add\",\"path\":\"/y\",\"value\":[6,7]}]");
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(cJSON_GetArrayItem(patch, 1), "value")));
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(from, patch));
+    cJSON_Delete(patch);
+    patch = cJSON_Parse("[{\"op\":\"remove\",\"path\":\"/y/0\"}]");
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(from, patch));
+    expected = cJSON_Parse("{\"x\":[1,5,3],\"y\":[7]}");
+    TEST_ASSERT_TRUE(cJSON_Compare(expected, from, true));
+
+    cJSON_Delete(expected);
+    cJSON_Delete(patch);
+
+    /* a reference can't be unpacked, the numbers belong to the referenced array */
+    TEST_ASSERT_TRUE(cJSON_PackArray(cJSON_GetObjectItem(from, "x")));
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToObject(to, "z", cJSON_GetObjectItem(from, "x")));
+    TEST_ASSERT_NULL(cJSONUtils_GetPointer(to, "/z/1"));
+    patch = cJSON_Parse("[{\"op\":\"remove\",\"path\":\"/z/0\"}]");
+    TEST_ASSERT_TRUE(cJSONUtils_ApplyPatches(to, patch) != 0);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(cJSON_GetObjectItem(from, "x")));
+
+    cJSON_Delete(patch);
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(cjson_utils_functions_shouldnt_crash_with_null_pointers);
+    RUN_TEST(cjson_utils_compiled_pointers_should_resolve_like_get_pointer);
+    RUN_TEST(cjson_utils_eval_pointers_should_resolve_many_pointers);
+    RUN_TEST(cjson_utils_pointer_index_should_find_pointers);
+    RUN_TEST(cjson_utils_array_diff_patches_should_transform_from_into_to);
+    RUN_TEST(cjson_utils_array_diff_patches_should_be_small_for_insertions);
+    RUN_TEST(cjson_utils_hash_should_not_depend_on_member_order);
+    RUN_TEST(cjson_utils_generate_patches_should_skip_identical_subtrees);
+    RUN_TEST(cjson_utils_apply_patches_should_apply_operations_sequentially);
+    RUN_TEST(cjson_utils_apply_patches_atomic_should_roll_back_on_failure);
+    RUN_TEST(cjson_utils_apply_patches_atomic_should_restore_moved_keys);
+    RUN_TEST(cjson_utils_test_operation_should_not_modify_the_document);
+    RUN_TEST(cjson_utils_test_operation_should_compare_large_objects);
+    RUN_TEST(cjson_utils_sort_object_should_sort_many_members);
+    RUN_TEST(cjson_utils_sort_object_to_depth_should_limit_recursion);
+    RUN_TEST(cjson_utils_merge_patch_should_keep_member_order);
+    RUN_TEST(cjson_utils_merge_patch_should_hand_over_member_keys);
+    RUN_TEST(cjson_utils_merge_patch_should_handle_large_objects);
+    RUN_TEST(cjson_utils_generate_merge_patch_should_not_modify_inputs);
+    RUN_TEST(cjson_utils_print_merge_patch_should_match_generated_patch);
+    RUN_TEST(cjson_utils_print_merge_patch_should_reuse_one_buffer);
+    RUN_TEST(cjson_utils_generate_patches_should_compare_exact_integers);
+    RUN_TEST(cjson_utils_should_see_the_elements_of_packed_arrays);
 
     return UNITY_END();
 }
@@ -0,0 +1,310 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_encodes_to(const char * const json, const unsigned char * const expected, const size_t expected_length)
+{
+    cJSON *item = cJSON_Parse(json);
+    size_t length = 0;
+    unsigned char *encoded = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    encoded = cJSON_PrintMessagePack(item, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, encoded, expected_length);
+
+    cJSON_free(encoded);
+    cJSON_Delete(item);
+}
+
+static void assert_decodes_to(const unsigned char * const encoded, const size_t length, const char * const expected)
+{
+    cJSON *item = cJSON_ParseMessagePack(encoded, length, NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+} test_writer;
+
+static cJSON_bool CJSON_CDECL write_to_test_writer(const char *data, size_t length, void *user_data)
+{
+    test_writer *writer = (test_writer*)user_data;
+
+    if ((writer->offset + length) > writer->length)
+    {
+        return false;
+    }
+    memcpy(writer->buffer + writer->offset, data, length);
+    writer->offset += length;
+
+    return true;
+}
+
+static void msgpack_should_encode_integers_in_the_smallest_format(void)
+{
+    static const unsigned char zero[] = { 0x00 };
+    static const unsigned char fixint_max[] = { 0x7f };
+    static const unsigned char uint8[] = { 0xcc, 0x80 };
+    static const unsigned char uint16[] = { 0xcd, 0x01, 0x00 };
+    static const unsigned char uint32[] = { 0xce, 0x00, 0x01, 0x00, 0x00 };
+    static const unsigned char uint64[] = { 0xcf, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 };
+    static const unsigned char minus_one[] = { 0xff };
+    static const unsigned char minus_thirty_two[] = { 0xe0 };
+    static const unsigned char int8[] = { 0xd0, 0x80 };
+    static const unsigned char int16[] = { 0xd1, 0x80, 0x00 };
+    static const unsigned char int32[] = { 0xd2, 0x80, 0x00, 0x00, 0x00 };
+    static const unsigned char int64[] = { 0xd3, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00 };
+    static const unsigned char float32[] = { 0xca, 0x3f, 0xc0, 0x00, 0x00 };
+    static const unsigned char float64[] = { 0xcb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a };
+
+    assert_encodes_to("0", zero, sizeof(zero));
+    assert_encodes_to("127", fixint_max, sizeof(fixint_max));
+    assert_encodes_to("128", uint8, sizeof(uint8));
+    assert_encodes_to("256", uint16, sizeof(uint16));
+    assert_encodes_to("65536", uint32, sizeof(uint32));
+    assert_encodes_to("4294967296", uint64, sizeof(uint64));
+    assert_encodes_to("-1", minus_one, sizeof(minus_one));
+    assert_encodes_to("-32", minus_thirty_two, sizeof(minus_thirty_two));
+    assert_encodes_to("-128", int8, sizeof(int8));
+    assert_encodes_to("-32768", int16, sizeof(int16));
+    assert_encodes_to("-2147483648", int32, sizeof(int32));
+    assert_encodes_to("-4294967296", int64, sizeof(int64));
+    assert_encodes_to("1.5", float32, sizeof(float32));
+    assert_encodes_to("1.1", float64, sizeof(float64));
+}
+
+static void msgpack_should_encode_containers_and_strings(void)
+{
+    static const unsigned char literals[] = { 0x93, 0xc2, 0xc3, 0xc0 };
+    static const unsigned char object[] = { 0x82, 0xa1, 0x61, 0x01, 0xa1, 0x62, 0x92, 0x02, 0x03 };
+    static const unsigned char empty[] = { 0x82, 0xa0, 0x90, 0xa1, 0x62, 0x80 };
+    cJSON *array = cJSON_CreateArray();
+    cJSON *string = NULL;
+    char long_string[300];
+    size_t length = 0;
+    unsigned char *encoded = NULL;
+    int i = 0;
+
+    assert_encodes_to("[false,true,null]", literals, sizeof(literals));
+    assert_encodes_to("{\"a\":1,\"b\":[2,3]}", object, sizeof(object));
+    assert_encodes_to("{\"\":[],\"b\":{}}", empty, sizeof(empty));
+
+    /* array16 and str16 */
+    TEST_ASSERT_NOT_NULL(array);
+    for (i = 0; i < 16; i++)
+    {
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(array, cJSON_CreateNull()));
+    }
+    encoded = cJSON_PrintMessagePack(array, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    TEST_ASSERT_EQUAL_UINT(19, length);
+    TEST_ASSERT_EQUAL_HEX8(0xdc, encoded[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, encoded[2]);
+    cJSON_free(encoded);
+    cJSON_Delete(array);
+
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    string = cJSON_CreateString(long_string);
+    TEST_ASSERT_NOT_NULL(string);
+    encoded = cJSON_PrintMessagePack(string, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    TEST_ASSERT_EQUAL_UINT(3 + sizeof(long_string) - 1, length);
+    TEST_ASSERT_EQUAL_HEX8(0xda, encoded[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, encoded[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x2b, encoded[2]);
+    cJSON_free(encoded);
+    cJSON_Delete(string);
+}
+
+static void msgpack_should_decode_all_formats(void)
+{
+    static const unsigned char integers[] = {
+        0x9e, 0x05, 0xfb, 0xcc, 0xff, 0xcd, 0xff, 0xff, 0xce, 0xff, 0xff, 0xff, 0xff,
+        0xcf, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00, 0xd0, 0x9c, 0xd1, 0xfc, 0x18,
+        0xd2, 0xff, 0xfe, 0x79, 0x60, 0xd3, 0xff, 0xff, 0xff, 0x17, 0x2b, 0x5a, 0xf0, 0x00,
+        0xca, 0xc0, 0x20, 0x00, 0x00, 0xcb, 0x40, 0x09, 0x21, 0xfb, 0x54, 0x44, 0x2d, 0x18, 0xc3, 0xc2
+    };
+    static const unsigned char strings[] = {
+        0x84, 0xa1, 0x61, 0xd9, 0x02, 0x68, 0x69, 0xc4, 0x01, 0x62, 0xda, 0x00, 0x01, 0x63,
+        0xdb, 0x00, 0x00, 0x00, 0x01, 0x63, 0xc5, 0x00, 0x00, 0xc6, 0x00, 0x00, 0x00, 0x01, 0x64, 0xc0
+    };
+    static const unsigned char large_containers[] = { 0xde, 0x00, 0x01, 0xa1, 0x61, 0xdd, 0x00, 0x00, 0x00, 0x02, 0xdc, 0x00, 0x00, 0xdf, 0x00, 0x00, 0x00, 0x00 };
+
+    assert_decodes_to(integers, sizeof(integers), "[5,-5,255,65535,4294967295,1000000000000,-100,-1000,-100000,-1000000000000,-2.5,3.1415926535897931,true,false]");
+    assert_decodes_to(strings, sizeof(strings), "{\"a\":\"hi\",\"b\":\"c\",\"c\":\"\",\"d\":null}");
+    assert_decodes_to(large_containers, sizeof(large_containers), "{\"a\":[[],{}]}");
+}
+
+static void msgpack_should_round_trip_raw_items(void)
+{
+    static const unsigned char encoded[] = { 0xc7, 0x03, CJSON_MSGPACK_RAW_EXTENSION, 0x5b, 0x31, 0x5d };
+    static const unsigned char fixext[] = { 0xd5, CJSON_MSGPACK_RAW_EXTENSION, 0x7b, 0x7d };
+    cJSON *raw = cJSON_CreateRaw("[1]");
+    size_t length = 0;
+    unsigned char *printed = NULL;
+    cJSON *decoded = NULL;
+
+    TEST_ASSERT_NOT_NULL(raw);
+    printed = cJSON_PrintMessagePack(raw, &length);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_UINT(sizeof(encoded), length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(encoded, printed, sizeof(encoded));
+
+    decoded = cJSON_ParseMessagePack(printed, length, NULL);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(decoded));
+    TEST_ASSERT_EQUAL_STRING("[1]", decoded->valuestring);
+    cJSON_Delete(decoded);
+
+    decoded = cJSON_ParseMessagePack(fixext, sizeof(fixext), NULL);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(decoded));
+    TEST_ASSERT_EQUAL_STRING("{}", decoded->valuestring);
+    cJSON_Delete(decoded);
+
+    cJSON_free(printed);
+    cJSON_Delete(raw);
+}
+
+static void msgpack_should_round_trip_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(inputs) / sizeof(inputs[0])); i++)
+    {
+        char *json = read_file(inputs[i]);
+        cJSON *item = NULL;
+        cJSON *decoded = NULL;
+        unsigned char *encoded = NULL;
+        size_t length = 0;
+        unsigned char written[4096];
+        test_writer writer;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(json, inputs[i]);
+        item = cJSON_Parse(json);
+        free(json);
+        if (item == NULL)
+        {
+            continue;
+        }
+
+        encoded = cJSON_PrintMessagePack(item, &length);
+        TEST_ASSERT_NOT_NULL(encoded);
+        decoded = cJSON_ParseMessagePack(encoded, length, NULL);
+        TEST_ASSERT_NOT_NULL(decoded);
+        TEST_ASSERT_TRUE(cJSON_Compare(item, decoded, true));
+
+        /* the writer produces the same bytes */
+        writer.buffer = written;
+        writer.length = sizeof(written);
+        writer.offset = 0;
+        TEST_ASSERT_TRUE(cJSON_PrintMessagePackToWriter(item, write_to_test_writer, &writer));
+        TEST_ASSERT_EQUAL_UINT(length, writer.offset);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(encoded, written, length);
+
+        cJSON_Delete(decoded);
+        cJSON_free(encoded);
+        cJSON_Delete(item);
+    }
+}
+
+static void msgpack_should_reject_invalid_input(void)
+{
+    static const unsigned char never_used[] = { 0xc1 };
+    static const unsigned char truncated_integer[] = { 0xcd, 0x01 };
+    static const unsigned char truncated_string[] = { 0xa3, 0x61, 0x62 };
+    static const unsigned char truncated_array[] = { 0x93, 0x01, 0x02 };
+    static const unsigned char huge_map[] = { 0xdf, 0xff, 0xff, 0xff, 0xff, 0x00 };
+    static const unsigned char integer_key[] = { 0x81, 0x01, 0x02 };
+    static const unsigned char other_extension[] = { 0xd4, 0x01, 0x00 };
+    static const unsigned char trailing[] = { 0x01, 0x02 };
+    unsigned char *nested = NULL;
+    const unsigned char *end = NULL;
+    cJSON *item = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(never_used, sizeof(never_used), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(truncated_integer, sizeof(truncated_integer), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(truncated_string, sizeof(truncated_string), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(truncated_array, sizeof(truncated_array), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(huge_map, sizeof(huge_map), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(integer_key, sizeof(integer_key), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(other_extension, sizeof(other_extension), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(trailing, sizeof(trailing), NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(NULL, 1, NULL));
+
+    item = cJSON_ParseMessagePack(trailing, sizeof(trailing), &end);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_PTR(trailing + 1, end);
+    cJSON_Delete(item);
+
+    /* nesting limit */
+    nested = (unsigned char*)malloc(CJSON_NESTING_LIMIT + 2);
+    TEST_ASSERT_NOT_NULL(nested);
+    for (i = 0; i <= CJSON_NESTING_LIMIT; i++)
+    {
+        nested[i] = 0x91;
+    }
+    nested[CJSON_NESTING_LIMIT + 1] = 0x00;
+    TEST_ASSERT_NULL(cJSON_ParseMessagePack(nested, CJSON_NESTING_LIMIT + 2, NULL));
+    item = cJSON_ParseMessagePack(nested + 1, CJSON_NESTING_LIMIT + 1, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    cJSON_Delete(item);
+    free(nested);
+
+    TEST_ASSERT_NULL(cJSON_PrintMessagePack(NULL, &i));
+    TEST_ASSERT_FALSE(cJSON_PrintMessagePackToWriter(NULL, write_to_test_writer, NULL));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(msgpack_should_encode_integers_in_the_smallest_format);
+    RUN_TEST(msgpack_should_encode_containers_and_strings);
+    RUN_TEST(msgpack_should_decode_all_formats);
+    RUN_TEST(msgpack_should_round_trip_raw_items);
+    RUN_TEST(msgpack_should_round_trip_test_inputs);
+    RUN_TEST(msgpack_should_reject_invalid_input);
+
+    return UNITY_END();
+}
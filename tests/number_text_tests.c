@@ -0,0 +1,134 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_printed_verbatim(const char * const json)
+{
+    cJSON *item = cJSON_ParseWithNumberText(json, strlen(json), NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void parse_with_number_text_should_print_numbers_verbatim(void)
+{
+    assert_printed_verbatim("[1.50,-0,1E3,0.1000000000000000055511151231257827,12345678901234567890123,-9007199254740993]");
+    assert_printed_verbatim("{\"price\":19.990,\"nested\":[[2.0e-3]]}");
+    assert_printed_verbatim("1e400");
+}
+
+static void parse_with_number_text_should_still_set_values(void)
+{
+    const char json[] = "[1.50, 2E3, 9007199254740993]";
+    cJSON *item = cJSON_ParseWithNumberText(json, sizeof(json), NULL);
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_DOUBLE(1.5, cJSON_GetNumberValue(cJSON_GetArrayItem(item, 0)));
+    TEST_ASSERT_EQUAL_STRING("1.50", cJSON_GetArrayItem(item, 0)->valuestring);
+    TEST_ASSERT_EQUAL_INT(2000, cJSON_GetArrayItem(item, 1)->valueint);
+    TEST_ASSERT_TRUE(cJSON_GetInt64Value(cJSON_GetArrayItem(item, 2)) == ((cJSON_int64)1 << 53) + 1);
+
+    cJSON_Delete(item);
+}
+
+static void changed_numbers_should_not_use_their_text(void)
+{
+    const char json[] = "[1.50,2.50,3.50]";
+    cJSON *item = cJSON_ParseWithNumberText(json, sizeof(json), NULL);
+    cJSON *copy = NULL;
+    char *printed = NULL;
+
+    cJSON_SetNumberValue(cJSON_GetArrayItem(item, 0), 4);
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 0)->valuestring);
+    cJSON_SetIntValue(cJSON_GetArrayItem(item, 1), 2);
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(item, 1)->valuestring);
+
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("[4,2,3.50]", printed);
+    cJSON_free(printed);
+
+    copy = cJSON_Duplicate(item, true);
+    printed = cJSON_PrintUnformatted(copy);
+    TEST_ASSERT_EQUAL_STRING("[4,2,3.50]", printed);
+    TEST_ASSERT_TRUE(cJSON_Compare(item, copy, true));
+    cJSON_free(printed);
+
+    cJSON_Delete(copy);
+    cJSON_Delete(item);
+}
+
+static void numbers_with_text_should_encode_like_numbers(void)
+{
+    const char json[] = "[-0, 42, 3.50, -200]";
+    cJSON *with_text = cJSON_ParseWithNumberText(json, sizeof(json), NULL);
+    cJSON *without_text = cJSON_Parse(json);
+    unsigned char *expected = NULL;
+    unsigned char *encoded = NULL;
+    size_t expected_length = 0;
+    size_t length = 0;
+
+    expected = cJSON_PrintCBOR(without_text, &expected_length);
+    encoded = cJSON_PrintCBOR(with_text, &length);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, encoded, length);
+    cJSON_free(expected);
+    cJSON_free(encoded);
+
+    expected = cJSON_PrintMessagePack(without_text, &expected_length);
+    encoded = cJSON_PrintMessagePack(with_text, &length);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, encoded, length);
+    cJSON_free(expected);
+    cJSON_free(encoded);
+
+    cJSON_Delete(with_text);
+    cJSON_Delete(without_text);
+}
+
+static void parse_with_number_text_should_fail_on_invalid_numbers(void)
+{
+    const char *end = NULL;
+
+    TEST_ASSERT_NULL(cJSON_ParseWithNumberText("[1.5e]", 6, &end));
+    TEST_ASSERT_NULL(cJSON_ParseWithNumberText("-", 1, NULL));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_with_number_text_should_print_numbers_verbatim);
+    RUN_TEST(parse_with_number_text_should_still_set_values);
+    RUN_TEST(changed_numbers_should_not_use_their_text);
+    RUN_TEST(numbers_with_text_should_encode_like_numbers);
+    RUN_TEST(parse_with_number_text_should_fail_on_invalid_numbers);
+
+    return UNITY_END();
+}
@@ -0,0 +1,267 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void parse_with_packed_arrays_should_pack_number_arrays(void)
+{
+    const char json[] = "{\"numbers\":[1, -2.5, 3e2 ,4],\"mixed\":[1,\"a\"],\"empty\":[],\"nested\":[[1],[2,3]]}";
+    cJSON *item = cJSON_ParseWithPackedArrays(json, sizeof(json), NULL);
+    cJSON *numbers = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    numbers = cJSON_GetObjectItem(item, "numbers");
+    TEST_ASSERT_TRUE(cJSON_IsArray(numbers));
+    TEST_ASSERT_BITS(cJSON_IsPacked, cJSON_IsPacked, numbers->type);
+    TEST_ASSERT_NULL(numbers->child);
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetArraySize(numbers));
+    TEST_ASSERT_NULL(cJSON_GetArrayItem(numbers, 0));
+
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, cJSON_GetObjectItem(item, "mixed")->type);
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(cJSON_GetObjectItem(item, "mixed")));
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, cJSON_GetObjectItem(item, "empty")->type);
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, cJSON_GetObjectItem(item, "nested")->type);
+    TEST_ASSERT_BITS(cJSON_IsPacked, cJSON_IsPacked, cJSON_GetObjectItem(item, "nested")->child->next->type);
+
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("{\"numbers\":[1,-2.5,300,4],\"mixed\":[1,\"a\"],\"empty\":[],\"nested\":[[1],[2,3]]}", printed);
+    cJSON_free(printed);
+
+    printed = cJSON_Print(numbers);
+    TEST_ASSERT_EQUAL_STRING("[1, -2.5, 300, 4]", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(item);
+}
+
+static void parse_with_packed_arrays_should_report_errors(void)
+{
+    const char *end = NULL;
+    const char json[] = "[1, 2, -]";
+
+    TEST_ASSERT_NULL(cJSON_ParseWithPackedArrays(json, sizeof(json), &end));
+    TEST_ASSERT_EQUAL_PTR(json + 7, end);
+    TEST_ASSERT_NULL(cJSON_ParseWithPackedArrays("[1, 2", 5, NULL));
+}
+
+static void packed_arrays_should_behave_like_arrays(void)
+{
+    const double values[] = { 0.5, 1, -7, 1e300 };
+    double copied[4];
+    cJSON_int64 integers[4];
+    cJSON *expected = cJSON_CreateDoubleArray(values, 4);
+    cJSON *packed = cJSON_CreateDoubleArray(values, 4);
+    cJSON *copy = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(packed));
+    TEST_ASSERT_TRUE(cJSON_PackArray(packed));
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetArraySize(packed));
+
+    TEST_ASSERT_TRUE(cJSON_Compare(packed, expected, true));
+    TEST_ASSERT_TRUE(cJSON_Compare(expected, packed, true));
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetDoubleArray(packed, copied, 3));
+    TEST_ASSERT_EQUAL_DOUBLE(-7, copied[2]);
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetInt64Array(packed, integers, 4));
+    TEST_ASSERT_TRUE(integers[2] == -7);
+
+    copy = cJSON_Duplicate(packed, true);
+    TEST_ASSERT_BITS(cJSON_IsPacked, cJSON_IsPacked, copy->type);
+    TEST_ASSERT_TRUE(cJSON_Compare(packed, copy, true));
+    cJSON_Delete(copy);
+
+    copy = cJSON_Duplicate(packed, false);
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetArraySize(copy));
+    TEST_ASSERT_FALSE(cJSON_Compare(packed, copy, true));
+    cJSON_Delete(copy);
+
+    /* adding an item unpacks the array */
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(packed, cJSON_CreateString("x")));
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, packed->type);
+    TEST_ASSERT_EQUAL_INT(5, cJSON_GetArraySize(packed));
+    TEST_ASSERT_EQUAL_DOUBLE(1e300, cJSON_GetArrayItem(packed, 3)->valuedouble);
+    TEST_ASSERT_FALSE(cJSON_Compare(packed, expected, true));
+    TEST_ASSERT_FALSE(cJSON_PackArray(packed));
+
+    cJSON_DeleteItemFromArray(packed, 4);
+    TEST_ASSERT_TRUE(cJSON_PackArray(packed));
+    cJSON_DeleteItemFromArray(packed, 0);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(packed));
+    TEST_ASSERT_EQUAL_DOUBLE(1, cJSON_GetArrayItem(packed, 0)->valuedouble);
+
+    TEST_ASSERT_TRUE(cJSON_UnpackArray(packed));
+    TEST_ASSERT_TRUE(cJSON_UnpackArray(packed));
+    TEST_ASSERT_FALSE(cJSON_PackArray(NULL));
+    TEST_ASSERT_FALSE(cJSON_UnpackArray(NULL));
+
+    cJSON_Delete(packed);
+    cJSON_Delete(expected);
+}
+
+static void pack_array_should_not_pack_exact_integers(void)
+{
+    const char json[] = "[1,9007199254740993]";
+    cJSON *parsed = cJSON_ParseWithPackedArrays(json, sizeof(json), NULL);
+    cJSON *array = cJSON_CreateArray();
+    char *printed = NULL;
+
+    /* the parser leaves this array unpacked, so cJSON_PackArray has to as well */
+    TEST_ASSERT_NOT_NULL(parsed);
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, parsed->type);
+    TEST_ASSERT_FALSE(cJSON_PackArray(parsed));
+    TEST_ASSERT_BITS(cJSON_IsPacked, 0, parsed->type);
+    printed = cJSON_PrintUnformatted(parsed);
+    TEST_ASSERT_EQUAL_STRING("[1,9007199254740993]", printed);
+    cJSON_free(printed);
+
+    cJSON_AddItemToArray(array, cJSON_CreateInt64(-7));
+    cJSON_AddItemToArray(array, cJSON_CreateUInt64((cJSON_uint64)-1));
+    TEST_ASSERT_FALSE(cJSON_PackArray(array));
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(array));
+
+    /* once the value has been changed, the digits are out of date and it can be packed */
+    cJSON_SetNumberValue(cJSON_GetArrayItem(array, 1), 2.5);
+    TEST_ASSERT_TRUE(cJSON_PackArray(array));
+    printed = cJSON_PrintUnformatted(array);
+    TEST_ASSERT_EQUAL_STRING("[-7,2.5]", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(parsed);
+    cJSON_Delete(array);
+}
+
+static void packed_arrays_should_encode_like_arrays(void)
+{
+    const int values[] = { 1, -2, 300000, 7 };
+    cJSON *expected = cJSON_CreateIntArray(values, 4);
+    cJSON *packed = cJSON_CreateIntArray(values, 4);
+    unsigned char *expected_encoding = NULL;
+    unsigned char *packed_encoding = NULL;
+    size_t expected_length = 0;
+    size_t packed_length = 0;
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(packed));
+
+    expected_encoding = cJSON_PrintCBOR(expected, &expected_length);
+    packed_encoding = cJSON_PrintCBOR(packed, &packed_length);
+    TEST_ASSERT_EQUAL_UINT(expected_length, packed_length);
+    TEST_ASSERT_EQUAL_MEMORY(expected_encoding, packed_encoding, expected_length);
+    cJSON_free(expected_encoding);
+    cJSON_free(packed_encoding);
+
+    expected_encoding = cJSON_PrintMessagePack(expected, &expected_length);
+    packed_encoding = cJSON_PrintMessagePack(packed, &packed_length);
+    TEST_ASSERT_EQUAL_UINT(expected_length, packed_length);
+    TEST_ASSERT_EQUAL_MEMORY(expected_encoding, packed_encoding, expected_length);
+    cJSON_free(expected_encoding);
+    cJSON_free(packed_encoding);
+
+    TEST_ASSERT_NULL(cJSON_CreateSnapshot(packed, &packed_length));
+
+    cJSON_Delete(packed);
+    cJSON_Delete(expected);
+}
+
+static void duplicated_packed_members_should_keep_their_names(void)
+{
+    const char json[] = "{\"a\":[1,2,3],\"b\":{\"c\":[4.5]}}";
+    cJSON *item = cJSON_ParseWithPackedArrays(json, sizeof(json), NULL);
+    cJSON *copy = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    copy = cJSON_Duplicate(item, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(cJSON_Compare(item, copy, true));
+    printed = cJSON_PrintUnformatted(copy);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1,2,3],\"b\":{\"c\":[4.5]}}", printed);
+    cJSON_free(printed);
+    cJSON_Delete(copy);
+
+    /* constant keys are shared, not copied */
+    TEST_ASSERT_TRUE(cJSON_AddItemToObjectCS(item, "d", cJSON_DetachItemFromObject(item, "a")));
+    copy = cJSON_Duplicate(cJSON_GetObjectItem(item, "d"), true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_BITS(cJSON_IsPacked | cJSON_StringIsConst, cJSON_IsPacked | cJSON_StringIsConst, copy->type);
+    TEST_ASSERT_EQUAL_PTR(cJSON_GetObjectItem(item, "d")->string, copy->string);
+    cJSON_Delete(copy);
+
+    cJSON_Delete(item);
+}
+
+static void references_to_packed_arrays_should_not_be_unpacked(void)
+{
+    const double values[] = { 1, 2, 3 };
+    cJSON *packed = cJSON_CreateDoubleArray(values, 3);
+    cJSON *parent = cJSON_CreateArray();
+    cJSON *reference = NULL;
+    cJSON *item = cJSON_CreateNumber(4);
+    cJSON *chunk = cJSON_CreateArray();
+    cJSON_bool added = false;
+    char *printed = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_PackArray(packed));
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToArray(parent, packed));
+    reference = cJSON_GetArrayItem(parent, 0);
+    TEST_ASSERT_NOT_NULL(reference);
+
+    /* the numbers are shared with packed, which still owns them */
+    added = cJSON_AddItemToArray(reference, item);
+    printed = cJSON_PrintUnformatted(packed);
+    TEST_ASSERT_EQUAL_STRING("[1,2,3]", printed);
+    cJSON_free(printed);
+    TEST_ASSERT_FALSE(added);
+    TEST_ASSERT_FALSE(cJSON_UnpackArray(reference));
+    TEST_ASSERT_FALSE(cJSON_InsertItemInArray(reference, 0, item));
+    TEST_ASSERT_FALSE(cJSON_ReplaceItemInArray(reference, 0, item));
+    TEST_ASSERT_NULL(cJSON_DetachItemFromArray(reference, 0));
+    TEST_ASSERT_FALSE(cJSON_AppendArrayChunk(reference, chunk));
+
+    printed = cJSON_PrintUnformatted(parent);
+    TEST_ASSERT_EQUAL_STRING("[[1,2,3]]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(parent);
+
+    printed = cJSON_PrintUnformatted(packed);
+    TEST_ASSERT_EQUAL_STRING("[1,2,3]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(packed);
+    cJSON_Delete(item);
+    cJSON_Delete(chunk);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_with_packed_arrays_should_pack_number_arrays);
+    RUN_TEST(parse_with_packed_arrays_should_report_errors);
+    RUN_TEST(packed_arrays_should_behave_like_arrays);
+    RUN_TEST(pack_array_should_not_pack_exact_integers);
+    RUN_TEST(packed_arrays_should_encode_like_arrays);
+    RUN_TEST(duplicated_packed_members_should_keep_their_names);
+    RUN_TEST(references_to_packed_arrays_should_not_be_unpacked);
+
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocation_count = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocation_count++;
+    return malloc(size);
+}
+
+static void assert_parse_members(const char *json, const char * const *members, int member_count, const char *expected)
+{
+    cJSON *item = cJSON_ParseMembers(json, strlen(json) + sizeof(""), members, member_count, NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void parse_members_should_only_build_requested_members(void)
+{
+    const char *members[] = { "a", "c", "missing" };
+    const char json[] = "{\"a\": 1, \"b\": {\"x\": [1, 2, \"s\", {\"a\": true}]}, \"c\": \"str\", \"d\": null, \"a\": [2]}";
+
+    assert_parse_members(json, members, 3, "{\"a\":1,\"c\":\"str\",\"a\":[2]}");
+    assert_parse_members(json, members, 0, "{}");
+    assert_parse_members("{}", members, 3, "{}");
+}
+
+static void parse_members_should_match_escaped_names(void)
+{
+    const char *members[] = { "key", "\xC3\xA4" };
+
+    assert_parse_members("{\"k\\u0065y\": 1, \"\\u00e4\": 2, \"kez\": 3}", members, 2, "{\"key\":1,\"\xC3\xA4\":2}");
+}
+
+static void parse_members_should_parse_non_objects_completely(void)
+{
+    const char *members[] = { "a" };
+
+    assert_parse_members("[{\"a\": 1, \"b\": 2}]", members, 1, "[{\"a\":1,\"b\":2}]");
+    assert_parse_members("\"string\"", members, 1, "\"string\"");
+}
+
+static void parse_members_should_report_the_same_errors(void)
+{
+    const char *members[] = { "wanted" };
+    const char *invalid[] = {
+        "{\"skipped\": [1, 2,]}",
+        "{\"skipped\": {\"a\" 1}}",
+        "{\"skipped\": \"\\x\"}",
+        "{\"skipped\": \"\\ud800\"}",
+        "{\"skipped\": \"unterminated}",
+        "{\"skipped\": -}",
+        "{\"skipped\": [tru]}",
+        "{\"skipped\": {}, }",
+        "{\"skipped\" 1}",
+        "{\"skipped\": [",
+        "{\"wanted\": [1, }",
+        "{\"sk\\u0069pped\": nul}"
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        const char *expected_end = NULL;
+        const char *parse_end = NULL;
+        size_t length = strlen(invalid[i]);
+
+        TEST_ASSERT_NULL(cJSON_ParseWithLengthOpts(invalid[i], length, &expected_end, false));
+        TEST_ASSERT_NULL(cJSON_ParseMembers(invalid[i], length, members, 1, &parse_end));
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(expected_end, parse_end, invalid[i]);
+        TEST_ASSERT_EQUAL_PTR(expected_end, cJSON_GetErrorPtr());
+    }
+}
+
+static void parse_members_should_limit_the_nesting_of_skipped_members(void)
+{
+    const char *members[] = { "wanted" };
+    char deep_json[CJSON_NESTING_LIMIT + 20];
+    size_t position = 0;
+
+    memcpy(deep_json, "{\"x\":", 5);
+    for (position = 5; position < (sizeof(deep_json) - 2); position++)
+    {
+        deep_json[position] = '[';
+    }
+    deep_json[position] = '\0';
+
+    TEST_ASSERT_NULL(cJSON_ParseMembers(deep_json, strlen(deep_json), members, 1, NULL));
+}
+
+static void parse_members_should_not_allocate_for_skipped_members(void)
+{
+    const char *members[] = { "wanted" };
+    const char json[] = "{\"skipped\": [1, 2.5, {\"a\": \"b\\n\"}], \"also skipped\": \"string\", \"wanted\": true}";
+    cJSON_Hooks hooks = { counting_malloc, free };
+    cJSON *item = NULL;
+
+    cJSON_InitHooks(&hooks);
+    allocation_count = 0;
+    item = cJSON_ParseMembers(json, sizeof(json), members, 1, NULL);
+    cJSON_InitHooks(NULL);
+
+    TEST_ASSERT_NOT_NULL(item);
+    /* the root object, the member and its name */
+    TEST_ASSERT_EQUAL_UINT(3, allocation_count);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(item, "wanted")));
+
+    cJSON_Delete(item);
+}
+
+static void parse_members_should_handle_invalid_arguments(void)
+{
+    TEST_ASSERT_NULL(cJSON_ParseMembers("{}", 3, NULL, 1, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMembers("{}", 3, NULL, -1, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseMembers(NULL, 3, NULL, 0, NULL));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_members_should_only_build_requested_members);
+    RUN_TEST(parse_members_should_match_escaped_names);
+    RUN_TEST(parse_members_should_parse_non_objects_completely);
+    RUN_TEST(parse_members_should_report_the_same_errors);
+    RUN_TEST(parse_members_should_limit_the_nesting_of_skipped_members);
+    RUN_TEST(parse_members_should_not_allocate_for_skipped_members);
+    RUN_TEST(parse_members_should_handle_invalid_arguments);
+
+    return UNITY_END();
+}
@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void raw_members_should_keep_their_text(void)
+{
+    const char json[] = "{\"id\":1,\"payload\":{ \"a\" : [1, 2.50] },\"tags\":[\"x\"],\"name\":\"n\"}";
+    const char * const members[] = { "payload", "name" };
+    cJSON *item = cJSON_ParseWithRawMembers(json, sizeof(json), members, 2, NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(cJSON_IsNumber(cJSON_GetObjectItem(item, "id")));
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetObjectItem(item, "payload")));
+    TEST_ASSERT_EQUAL_STRING("{ \"a\" : [1, 2.50] }", cJSON_GetObjectItem(item, "payload")->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(item, "tags")));
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetObjectItem(item, "name")));
+    TEST_ASSERT_EQUAL_STRING("\"n\"", cJSON_GetObjectItem(item, "name")->valuestring);
+
+    printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":1,\"payload\":{ \"a\" : [1, 2.50] },\"tags\":[\"x\"],\"name\":\"n\"}", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void raw_members_should_only_match_the_top_level(void)
+{
+    const char json[] = "{\"outer\":{\"payload\":[1]},\"payload\":[2]}";
+    const char * const members[] = { "payload" };
+    cJSON *item = cJSON_ParseWithRawMembers(json, sizeof(json), members, 1, NULL);
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(cJSON_GetObjectItem(item, "outer"), "payload")));
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetObjectItem(item, "payload")));
+
+    cJSON_Delete(item);
+}
+
+static void raw_depth_should_keep_nested_containers_as_text(void)
+{
+    const char json[] = "[1,{\"a\":[true]},[[2],3],\"s\"]";
+    cJSON *item = cJSON_ParseWithRawDepth(json, sizeof(json), 1, NULL);
+    cJSON *deeper = cJSON_ParseWithRawDepth(json, sizeof(json), 2, NULL);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(cJSON_IsNumber(cJSON_GetArrayItem(item, 0)));
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetArrayItem(item, 1)));
+    TEST_ASSERT_EQUAL_STRING("[[2],3]", cJSON_GetArrayItem(item, 2)->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsString(cJSON_GetArrayItem(item, 3)));
+
+    TEST_ASSERT_NOT_NULL(deeper);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetObjectItem(cJSON_GetArrayItem(deeper, 1), "a")));
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetArrayItem(cJSON_GetArrayItem(deeper, 2), 0)));
+    TEST_ASSERT_TRUE(cJSON_IsNumber(cJSON_GetArrayItem(cJSON_GetArrayItem(deeper, 2), 1)));
+
+    printed = cJSON_PrintUnformatted(deeper);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(deeper);
+    cJSON_Delete(item);
+}
+
+static void raw_values_should_still_be_validated(void)
+{
+    const char * const members[] = { "payload" };
+    const char *parse_end = NULL;
+
+    TEST_ASSERT_NULL(cJSON_ParseWithRawMembers("{\"payload\":[1,}", 15, members, 1, &parse_end));
+    TEST_ASSERT_NULL(cJSON_ParseWithRawMembers("{\"payload\":tru}", 15, members, 1, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseWithRawDepth("[{\"a\" 1}]", 9, 1, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseWithRawDepth("[[1]]", 5, 0, NULL));
+    TEST_ASSERT_NULL(cJSON_ParseWithRawMembers("{}", 2, NULL, 1, NULL));
+}
+
+static void raw_items_should_duplicate_and_compare(void)
+{
+    const char json[] = "{\"payload\":{\"a\":1}}";
+    const char * const members[] = { "payload" };
+    cJSON *item = cJSON_ParseWithRawMembers(json, sizeof(json), members, 1, NULL);
+    cJSON *copy = cJSON_Duplicate(item, true);
+
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetObjectItem(copy, "payload")));
+    TEST_ASSERT_TRUE(cJSON_Compare(item, copy, true));
+
+    cJSON_Delete(copy);
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(raw_members_should_keep_their_text);
+    RUN_TEST(raw_members_should_only_match_the_top_level);
+    RUN_TEST(raw_depth_should_keep_nested_containers_as_text);
+    RUN_TEST(raw_values_should_still_be_validated);
+    RUN_TEST(raw_items_should_duplicate_and_compare);
+
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static unsigned char *create_snapshot(const char * const json, size_t * const length)
+{
+    cJSON *item = cJSON_Parse(json);
+    unsigned char *snapshot = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    snapshot = cJSON_CreateSnapshot(item, length);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    cJSON_Delete(item);
+
+    return snapshot;
+}
+
+static void snapshot_should_be_readable_in_place(void)
+{
+    size_t length = 0;
+    unsigned char *snapshot = create_snapshot("{\"name\":\"cJSON\",\"list\":[1,2.5,-3,true,false,null,[]],\"nested\":{\"key\":\"value\"}}", &length);
+    const cJSON_SnapshotItem *root = NULL;
+    const cJSON_SnapshotItem *list = NULL;
+
+    root = cJSON_OpenSnapshot(snapshot, length, true);
+    TEST_ASSERT_NOT_NULL(root);
+
+    TEST_ASSERT_EQUAL_INT(cJSON_Object, cJSON_SnapshotGetType(root));
+    TEST_ASSERT_EQUAL_INT(3, cJSON_SnapshotGetSize(root));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetKey(root));
+    TEST_ASSERT_EQUAL_STRING("cJSON", cJSON_SnapshotGetString(cJSON_SnapshotGetObjectItem(root, "name")));
+    TEST_ASSERT_EQUAL_STRING("nested", cJSON_SnapshotGetKey(cJSON_SnapshotGetArrayItem(root, 2)));
+    TEST_ASSERT_EQUAL_STRING("value", cJSON_SnapshotGetString(cJSON_SnapshotGetObjectItem(cJSON_SnapshotGetObjectItem(root, "nested"), "key")));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetObjectItem(root, "Name"));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetArrayItem(root, 3));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetArrayItem(root, -1));
+
+    list = cJSON_SnapshotGetObjectItem(root, "list");
+    TEST_ASSERT_EQUAL_INT(cJSON_Array, cJSON_SnapshotGetType(list));
+    TEST_ASSERT_EQUAL_INT(7, cJSON_SnapshotGetSize(list));
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_SnapshotGetNumber(cJSON_SnapshotGetArrayItem(list, 0)));
+    TEST_ASSERT_EQUAL_DOUBLE(2.5, cJSON_SnapshotGetNumber(cJSON_SnapshotGetArrayItem(list, 1)));
+    TEST_ASSERT_EQUAL_DOUBLE(-3.0, cJSON_SnapshotGetNumber(cJSON_SnapshotGetArrayItem(list, 2)));
+    TEST_ASSERT_EQUAL_INT(cJSON_True, cJSON_SnapshotGetType(cJSON_SnapshotGetArrayItem(list, 3)));
+    TEST_ASSERT_EQUAL_INT(cJSON_False, cJSON_SnapshotGetType(cJSON_SnapshotGetArrayItem(list, 4)));
+    TEST_ASSERT_EQUAL_INT(cJSON_NULL, cJSON_SnapshotGetType(cJSON_SnapshotGetArrayItem(list, 5)));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_SnapshotGetSize(cJSON_SnapshotGetArrayItem(list, 6)));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetString(cJSON_SnapshotGetArrayItem(list, 0)));
+
+    TEST_ASSERT_EQUAL_INT(cJSON_Invalid, cJSON_SnapshotGetType(NULL));
+    TEST_ASSERT_NULL(cJSON_SnapshotToTree(NULL));
+
+    cJSON_free(snapshot);
+}
+
+static void snapshot_should_be_position_independent(void)
+{
+    size_t length = 0;
+    unsigned char *snapshot = create_snapshot("{\"a\":[\"b\",{\"c\":\"d\"}]}", &length);
+    unsigned char *moved = (unsigned char*)malloc(length + 1);
+    const cJSON_SnapshotItem *root = NULL;
+
+    TEST_ASSERT_NOT_NULL(moved);
+    /* copy to an odd address */
+    memcpy(moved + 1, snapshot, length);
+    cJSON_free(snapshot);
+
+    root = cJSON_OpenSnapshot(moved + 1, length, true);
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_STRING("d", cJSON_SnapshotGetString(cJSON_SnapshotGetObjectItem(cJSON_SnapshotGetArrayItem(cJSON_SnapshotGetObjectItem(root, "a"), 1), "c")));
+
+    free(moved);
+}
+
+static void snapshot_should_round_trip_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(inputs) / sizeof(inputs[0])); i++)
+    {
+        char *json = read_file(inputs[i]);
+        cJSON *item = NULL;
+        cJSON *tree = NULL;
+        unsigned char *snapshot = NULL;
+        size_t length = 0;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(json, inputs[i]);
+        item = cJSON_Parse(json);
+        free(json);
+        if (item == NULL)
+        {
+            continue;
+        }
+
+        snapshot = cJSON_CreateSnapshot(item, &length);
+        TEST_ASSERT_NOT_NULL(snapshot);
+        tree = cJSON_SnapshotToTree(cJSON_OpenSnapshot(snapshot, length, true));
+        TEST_ASSERT_NOT_NULL(tree);
+        TEST_ASSERT_TRUE(cJSON_Compare(item, tree, true));
+
+        cJSON_Delete(tree);
+        cJSON_free(snapshot);
+        cJSON_Delete(item);
+    }
+}
+
+static void snapshot_should_detect_corruption(void)
+{
+    size_t length = 0;
+    unsigned char *snapshot = create_snapshot("{\"a\":[1,2,3],\"b\":\"text\"}", &length);
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(cJSON_OpenSnapshot(snapshot, length, true));
+    TEST_ASSERT_NULL(cJSON_OpenSnapshot(snapshot, length - 1, true));
+    TEST_ASSERT_NULL(cJSON_OpenSnapshot(NULL, length, true));
+
+    /* every flipped bit is noticed */
+    for (i = 0; i < length; i++)
+    {
+        snapshot[i] ^= 0x10;
+        TEST_ASSERT_NULL(cJSON_OpenSnapshot(snapshot, length, true));
+        snapshot[i] ^= 0x10;
+    }
+
+    /* the header is checked even without verification */
+    snapshot[4] = 2;
+    TEST_ASSERT_NULL(cJSON_OpenSnapshot(snapshot, length, false));
+    snapshot[4] = 1;
+    TEST_ASSERT_NOT_NULL(cJSON_OpenSnapshot(snapshot, length, false));
+
+    cJSON_free(snapshot);
+}
+
+static void snapshot_should_reject_invalid_items(void)
+{
+    cJSON invalid;
+    cJSON *raw = cJSON_CreateRaw("[1,]");
+    const cJSON_SnapshotItem *root = NULL;
+    unsigned char *snapshot = NULL;
+    size_t length = 0;
+
+    memset(&invalid, 0, sizeof(invalid));
+    TEST_ASSERT_NULL(cJSON_CreateSnapshot(&invalid, &length));
+    TEST_ASSERT_NULL(cJSON_CreateSnapshot(NULL, &length));
+
+    TEST_ASSERT_NOT_NULL(raw);
+    TEST_ASSERT_NULL(cJSON_CreateSnapshot(raw, NULL));
+    snapshot = cJSON_CreateSnapshot(raw, &length);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    root = cJSON_OpenSnapshot(snapshot, length, true);
+    TEST_ASSERT_EQUAL_INT(cJSON_Raw, cJSON_SnapshotGetType(root));
+    TEST_ASSERT_EQUAL_STRING("[1,]", cJSON_SnapshotGetString(root));
+
+    cJSON_free(snapshot);
+    cJSON_Delete(raw);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(snapshot_should_be_readable_in_place);
+    RUN_TEST(snapshot_should_be_position_independent);
+    RUN_TEST(snapshot_should_round_trip_test_inputs);
+    RUN_TEST(snapshot_should_detect_corruption);
+    RUN_TEST(snapshot_should_reject_invalid_items);
+
+    return UNITY_END();
+}